@@ -6,17 +6,6 @@ contains(CONFIG, "noupcasename") {
     TARGET = jamulus
 }
 
-# support multi-threading with OMP if requested
-contains(CONFIG, "multithreading") {
-    unix {
-        message(The OpenMP multithreading is enabled.)
-        message(NOTE THAT THE OpenMP IMPLEMENTATION IS STILL EXPERIMENTAL AND MAY NOT BE STABLE.)
-        DEFINES += USE_OMP
-        QMAKE_CXXFLAGS += -fopenmp
-        QMAKE_LFLAGS += -fopenmp
-    }
-}
-
 CONFIG += qt \
     thread \
     release
@@ -311,6 +300,16 @@ win32 {
         DEFINES += WITH_SOUND
     }
 
+    # optional io_uring network engine for the server (requires Linux 6.0 at
+    # runtime and the corresponding kernel headers, no liburing needed)
+    contains(CONFIG, "io_uring") {
+        message(io_uring network engine enabled.)
+
+        HEADERS += src/iouring.h
+        SOURCES += src/iouring.cpp
+        DEFINES += USE_IO_URING
+    }
+
     isEmpty(PREFIX) {
         PREFIX = /usr/local
     }
@@ -353,12 +352,14 @@ HEADERS += src/buffer.h \
     src/channel.h \
     src/client.h \
     src/global.h \
+    src/mixkernels.h \
     src/multicolorled.h \
     src/protocol.h \
     src/recorder/jamcontroller.h \
     src/server.h \
     src/serverlist.h \
     src/serverlogging.h \
+    src/servermetrics.h \
     src/settings.h \
     src/socket.h \
     src/soundbase.h \
@@ -454,11 +455,13 @@ SOURCES += src/buffer.cpp \
     src/channel.cpp \
     src/client.cpp \
     src/main.cpp \
+    src/mixkernels.cpp \
     src/protocol.cpp \
     src/recorder/jamcontroller.cpp \
     src/server.cpp \
     src/serverlist.cpp \
     src/serverlogging.cpp \
+    src/servermetrics.cpp \
     src/settings.cpp \
     src/signalhandler.cpp \
     src/socket.cpp \
@@ -669,6 +669,7 @@ CAudioMixerBoard::CAudioMixerBoard ( QWidget* parent, Qt::WindowFlags ) :
     bDisplayPans         ( false ),
     bIsPanSupported      ( false ),
     bNoFaderVisible      ( true ),
+    eGUIDesign           ( GD_STANDARD ),
     iMyChannelID         ( INVALID_INDEX ),
     strServerName        ( "" ),
     eRecorderState       ( RS_UNDEFINED )
@@ -688,17 +689,8 @@ CAudioMixerBoard::CAudioMixerBoard ( QWidget* parent, Qt::WindowFlags ) :
     // set title text (default: no server given)
     SetServerName ( "" );
 
-    // create all mixer controls and make them invisible
-    vecpChanFader.Init ( MAX_NUM_CHANNELS );
-
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
-    {
-        vecpChanFader[i] = new CChannelFader ( this );
-        vecpChanFader[i]->Hide();
-
-        // add fader frame to audio mixer board layout
-        pMainLayout->addWidget ( vecpChanFader[i]->GetMainWidget() );
-    }
+    // the mixer controls are created on demand when the channel IDs of the
+    // connected clients grow (the server may support many channels)
 
     // insert horizontal spacer
     pMainLayout->addItem ( new QSpacerItem ( 0, 0, QSizePolicy::Expanding ) );
@@ -712,46 +704,56 @@ CAudioMixerBoard::CAudioMixerBoard ( QWidget* parent, Qt::WindowFlags ) :
     pScrollArea->setWidgetResizable ( true ); // make sure it fills the entire scroll area
     pScrollArea->setFrameShape ( QFrame::NoFrame );
     pGroupBoxLayout->addWidget ( pScrollArea );
-
-
-    // Connections -------------------------------------------------------------
-    connectFaderSignalsToMixerBoardSlots<MAX_NUM_CHANNELS>();
 }
 
 CAudioMixerBoard::~CAudioMixerBoard()
 {
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    for ( int i = 0; i < vecpChanFader.Size(); i++ )
     {
         delete vecpChanFader[i];
     }
 }
 
-template<unsigned int slotId>
-inline void CAudioMixerBoard::connectFaderSignalsToMixerBoardSlots()
+void CAudioMixerBoard::CreateFaders ( const int iNewNumFaders )
 {
-    int iCurChanID = slotId - 1;
+    for ( int i = vecpChanFader.Size(); i < iNewNumFaders; i++ )
+    {
+        CChannelFader* pNewChanFader = new CChannelFader ( this );
 
-    void ( CAudioMixerBoard::* pGainValueChanged )( double, bool, bool, bool, double ) =
-        &CAudioMixerBoardSlots<slotId>::OnChGainValueChanged;
+        pNewChanFader->SetGUIDesign ( eGUIDesign );
+        pNewChanFader->SetDisplayPans ( bDisplayPans && bIsPanSupported );
+        pNewChanFader->Hide();
 
-    void ( CAudioMixerBoard::* pPanValueChanged )( double ) =
-        &CAudioMixerBoardSlots<slotId>::OnChPanValueChanged;
+        vecpChanFader.Add ( pNewChanFader );
 
-    QObject::connect ( vecpChanFader[iCurChanID], &CChannelFader::soloStateChanged,
-        this, &CAudioMixerBoard::UpdateSoloStates );
+        // add fader frame to audio mixer board layout (in front of the spacer)
+        pMainLayout->insertWidget ( pMainLayout->count() - 1, pNewChanFader->GetMainWidget() );
 
-    QObject::connect ( vecpChanFader[iCurChanID], &CChannelFader::gainValueChanged,
-        this, pGainValueChanged );
+        ConnectFaderSignals ( i );
+    }
+}
 
-    QObject::connect ( vecpChanFader[iCurChanID], &CChannelFader::panValueChanged,
-        this, pPanValueChanged );
+void CAudioMixerBoard::ConnectFaderSignals ( const int iChannelIdx )
+{
+    QObject::connect ( vecpChanFader[iChannelIdx], &CChannelFader::soloStateChanged,
+        this, &CAudioMixerBoard::UpdateSoloStates );
 
-    connectFaderSignalsToMixerBoardSlots<slotId - 1>();
+    QObject::connect ( vecpChanFader[iChannelIdx], &CChannelFader::gainValueChanged,
+        this, [this, iChannelIdx] ( double dValue,
+                                    bool   bIsMyOwnFader,
+                                    bool   bIsGroupUpdate,
+                                    bool   bSuppressServerUpdate,
+                                    double dLevelRatio ) { UpdateGainValue ( iChannelIdx,
+                                                                             dValue,
+                                                                             bIsMyOwnFader,
+                                                                             bIsGroupUpdate,
+                                                                             bSuppressServerUpdate,
+                                                                             dLevelRatio ); } );
+
+    QObject::connect ( vecpChanFader[iChannelIdx], &CChannelFader::panValueChanged,
+        this, [this, iChannelIdx] ( double dValue ) { UpdatePanValue ( iChannelIdx, dValue ); } );
 }
 
-template<>
-inline void CAudioMixerBoard::connectFaderSignalsToMixerBoardSlots<0>() {}
-
 void CAudioMixerBoard::SetServerName ( const QString& strNewServerName )
 {
     // store the current server name
@@ -785,8 +787,10 @@ void CAudioMixerBoard::SetGUIDesign ( const EGUIDesign eNewDesign )
         pMainLayout->setSpacing ( 6 ); // Qt default spacing value
     }
 
+    eGUIDesign = eNewDesign;
+
     // apply GUI design to child GUI controls
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    for ( int i = 0; i < vecpChanFader.Size(); i++ )
     {
         vecpChanFader[i]->SetGUIDesign ( eNewDesign );
     }
@@ -801,7 +805,7 @@ void CAudioMixerBoard::SetDisplayChannelLevels ( const bool eNDCL )
     if ( !bDisplayChannelLevels )
     {
         // hide all level meters
-        for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+        for ( int i = 0; i < vecpChanFader.Size(); i++ )
         {
             vecpChanFader[i]->SetDisplayChannelLevel ( false );
         }
@@ -812,7 +816,7 @@ void CAudioMixerBoard::SetDisplayPans ( const bool eNDP )
 {
     bDisplayPans = eNDP;
 
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    for ( int i = 0; i < vecpChanFader.Size(); i++ )
     {
         vecpChanFader[i]->SetDisplayPans ( eNDP && bIsPanSupported );
     }
@@ -827,7 +831,7 @@ void CAudioMixerBoard::SetPanIsSupported()
 void CAudioMixerBoard::HideAll()
 {
     // make all controls invisible
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    for ( int i = 0; i < vecpChanFader.Size(); i++ )
     {
         // before hiding the fader, store its level (if some conditions are fulfilled)
         StoreFaderSettings ( vecpChanFader[i] );
@@ -857,7 +861,7 @@ void CAudioMixerBoard::ChangeFaderOrder ( const bool        bDoSort,
     // create a pair list of lower strings and fader ID for each channel
     QList<QPair<QString, int> > PairList;
 
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    for ( int i = 0; i < vecpChanFader.Size(); i++ )
     {
         if ( eChSortType == ST_BY_NAME )
         {
@@ -878,7 +882,7 @@ void CAudioMixerBoard::ChangeFaderOrder ( const bool        bDoSort,
     // add channels to the layout in the new order (since we insert on the left, we
     // have to use a backwards counting loop), note that it is not required to remove
     // the widget from the layout first but it is moved to the new position automatically
-    for ( int i = MAX_NUM_CHANNELS - 1; i >= 0; i-- )
+    for ( int i = vecpChanFader.Size() - 1; i >= 0; i-- )
     {
         pMainLayout->insertWidget ( 0, vecpChanFader[PairList[i].second]->GetMainWidget() );
     }
@@ -915,9 +919,22 @@ void CAudioMixerBoard::ApplyNewConClientList ( CVector<CChannelInfo>& vecChanInf
     // get number of connected clients
     const int iNumConnectedClients = vecChanInfo.Size();
 
+    // make sure that a fader exists for each channel ID
+    int iNewNumFaders = vecpChanFader.Size();
+
+    for ( int j = 0; j < iNumConnectedClients; j++ )
+    {
+        if ( ( vecChanInfo[j].iChanID >= iNewNumFaders ) && ( vecChanInfo[j].iChanID < MAX_NUM_CHANNELS ) )
+        {
+            iNewNumFaders = vecChanInfo[j].iChanID + 1;
+        }
+    }
+
+    CreateFaders ( iNewNumFaders );
+
     // search for channels with are already present and preserve their gain
     // setting, for all other channels reset gain
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    for ( int i = 0; i < vecpChanFader.Size(); i++ )
     {
         bool bFaderIsUsed = false;
 
@@ -1013,7 +1030,7 @@ void CAudioMixerBoard::SetFaderLevel ( const int iChannelIdx,
                                        const int iValue )
 {
     // only apply new fader level if channel index is valid and the fader is visible
-    if ( ( iChannelIdx >= 0 ) && ( iChannelIdx < MAX_NUM_CHANNELS ) )
+    if ( ( iChannelIdx >= 0 ) && ( iChannelIdx < vecpChanFader.Size() ) )
     {
         if ( vecpChanFader[iChannelIdx]->IsVisible() )
         {
@@ -1026,7 +1043,7 @@ void CAudioMixerBoard::SetRemoteFaderIsMute ( const int  iChannelIdx,
                                               const bool bIsMute )
 {
     // only apply remote mute state if channel index is valid and the fader is visible
-    if ( ( iChannelIdx >= 0 ) && ( iChannelIdx < MAX_NUM_CHANNELS ) )
+    if ( ( iChannelIdx >= 0 ) && ( iChannelIdx < vecpChanFader.Size() ) )
     {
         if ( vecpChanFader[iChannelIdx]->IsVisible() )
         {
@@ -1040,7 +1057,7 @@ void CAudioMixerBoard::UpdateSoloStates()
     // first check if any channel has a solo state active
     bool bAnyChannelIsSolo = false;
 
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    for ( int i = 0; i < vecpChanFader.Size(); i++ )
     {
         // check if fader is in use and has solo state active
         if ( vecpChanFader[i]->IsVisible() && vecpChanFader[i]->IsSolo() )
@@ -1051,7 +1068,7 @@ void CAudioMixerBoard::UpdateSoloStates()
     }
 
     // now update the solo state of all active faders
-    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    for ( int i = 0; i < vecpChanFader.Size(); i++ )
     {
         if ( vecpChanFader[i]->IsVisible() )
         {
@@ -1078,7 +1095,7 @@ void CAudioMixerBoard::UpdateGainValue ( const int    iChannelIdx,
     // to avoid an infinite loop)
     if ( vecpChanFader[iChannelIdx]->IsSelect() && !bIsGroupUpdate )
     {
-        for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+        for ( int i = 0; i < vecpChanFader.Size(); i++ )
         {
             // update rest of faders selected
             if ( vecpChanFader[i]->IsVisible() &&
@@ -1183,7 +1200,7 @@ void CAudioMixerBoard::SetChannelLevels ( const CVector<uint16_t>& vecChannelLev
     const int iNumChannelLevels = vecChannelLevel.Size();
     int       i                 = 0;
 
-    for ( int iChId = 0; iChId < MAX_NUM_CHANNELS; iChId++ )
+    for ( int iChId = 0; iChId < vecpChanFader.Size(); iChId++ )
     {
         if ( vecpChanFader[iChId]->IsVisible() && ( i < iNumChannelLevels ) )
         {
@@ -131,42 +131,7 @@ signals:
     void soloStateChanged ( int value );
 };
 
-template<unsigned int slotId>
-class CAudioMixerBoardSlots : public CAudioMixerBoardSlots<slotId - 1>
-{
-public:
-    void OnChGainValueChanged ( double dValue,
-                                bool   bIsMyOwnFader,
-                                bool   bIsGroupUpdate,
-                                bool   bSuppressServerUpdate,
-                                double dLevelRatio ) { UpdateGainValue ( slotId - 1,
-                                                                         dValue,
-                                                                         bIsMyOwnFader,
-                                                                         bIsGroupUpdate,
-                                                                         bSuppressServerUpdate,
-                                                                         dLevelRatio ); }
-
-    void OnChPanValueChanged ( double dValue ) { UpdatePanValue ( slotId - 1, dValue ); }
-
-protected:
-    virtual void UpdateGainValue ( const int    iChannelIdx,
-                                   const double dValue,
-                                   const bool   bIsMyOwnFader,
-                                   const bool   bIsGroupUpdate,
-                                   const bool   bSuppressServerUpdate,
-                                   const double dLevelRatio ) = 0;
-
-    virtual void UpdatePanValue ( const int    iChannelIdx,
-                                  const double dValue ) = 0;
-};
-
-template<>
-class CAudioMixerBoardSlots<0> {};
-
-
-class CAudioMixerBoard :
-    public QGroupBox,
-    public CAudioMixerBoardSlots<MAX_NUM_CHANNELS>
+class CAudioMixerBoard : public QGroupBox
 {
     Q_OBJECT
 
@@ -227,6 +192,7 @@ protected:
                                   bool&               bStoredFaderIsSolo,
                                   bool&               bStoredFaderIsMute );
 
+    void CreateFaders ( const int iNewNumFaders );
     void StoreFaderSettings ( CChannelFader* pChanFader );
     void UpdateSoloStates();
     void UpdateTitle();
@@ -241,6 +207,7 @@ protected:
     bool                    bDisplayPans;
     bool                    bIsPanSupported;
     bool                    bNoFaderVisible;
+    EGUIDesign              eGUIDesign;
     int                     iMyChannelID;
     QString                 strServerName;
     ERecorderState          eRecorderState;
@@ -255,8 +222,7 @@ protected:
     virtual void UpdatePanValue ( const int    iChannelIdx,
                                   const double dValue );
 
-    template<unsigned int slotId>
-    inline void connectFaderSignalsToMixerBoardSlots();
+    void ConnectFaderSignals ( const int iChannelIdx );
 
 signals:
     void ChangeChanGain ( int iId, double dGain, bool bIsMyOwnFader );
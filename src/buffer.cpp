@@ -91,15 +91,33 @@ bool CNetBuf::Get ( CVector<uint8_t>& vecbyData,
 
 /* Network buffer with statistic calculations implementation ******************/
 CNetBufWithStats::CNetBufWithStats() :
-    CNetBuf                   ( false ), // base class init: no simulation mode
-    iMaxStatisticCount        ( MAX_STATISTIC_COUNT ),
-    bUseDoubleSystemFrameSize ( false ),
-    dAutoFilt_WightUpNormal   ( IIR_WEIGTH_UP_NORMAL ),
-    dAutoFilt_WightDownNormal ( IIR_WEIGTH_DOWN_NORMAL ),
-    dAutoFilt_WightUpFast     ( IIR_WEIGTH_UP_FAST ),
-    dAutoFilt_WightDownFast   ( IIR_WEIGTH_DOWN_FAST ),
-    dErrorRateBound           ( ERROR_RATE_BOUND ),
-    dUpMaxErrorBound          ( UP_MAX_ERROR_BOUND )
+    vecbyMemory                  ( NET_BUF_NUM_SLOTS * MAX_NET_BUF_BLOCK_SIZE_BYTES ),
+    veciSlotBlockSize            ( NET_BUF_NUM_SLOTS, 0 ),
+    iPutCnt                      ( 0 ),
+    iGetCnt                      ( 0 ),
+    iBlockSize                   ( 0 ),
+    iNumBlocks                   ( 0 ),
+    iReqBlockSize                ( 0 ),
+    iReqNumBlocks                ( 0 ),
+    bReqReset                    ( false ),
+    bReqUseDoubleSystemFrameSize ( false ),
+    iReqCnt                      ( 0 ),
+    iAppliedReqCnt               ( 0 ),
+    bIsInitialized               ( false ),
+    iNumPendingPuts              ( 0 ),
+    iPendingPutSize              ( 0 ),
+    iNumUnderruns                ( 0 ),
+    iNumOverruns                 ( 0 ),
+    iNumAutoSettingChanges       ( 0 ),
+    iCurAutoBufferSizeSetting    ( 6 ),
+    iMaxStatisticCount           ( MAX_STATISTIC_COUNT ),
+    bUseDoubleSystemFrameSize    ( false ),
+    dAutoFilt_WightUpNormal      ( IIR_WEIGTH_UP_NORMAL ),
+    dAutoFilt_WightDownNormal    ( IIR_WEIGTH_DOWN_NORMAL ),
+    dAutoFilt_WightUpFast        ( IIR_WEIGTH_UP_FAST ),
+    dAutoFilt_WightDownFast      ( IIR_WEIGTH_DOWN_FAST ),
+    dErrorRateBound              ( ERROR_RATE_BOUND ),
+    dUpMaxErrorBound             ( UP_MAX_ERROR_BOUND )
 {
     // Define the sizes of the simulation buffers,
     // must be NUM_STAT_SIMULATION_BUFFERS elements!
@@ -145,53 +163,118 @@ void CNetBufWithStats::Init ( const int  iNewBlockSize,
                               const int  iNewNumBlocks,
                               const bool bPreserve )
 {
-    // call base class Init
-    CNetBuf::Init ( iNewBlockSize, iNewNumBlocks, bPreserve );
+    // store the requested settings, a non-preserving request is not lost if
+    // further requests follow before the consumer has applied it
+    iReqBlockSize.store ( iNewBlockSize, std::memory_order_relaxed );
+    iReqNumBlocks.store ( std::min ( iNewNumBlocks, NET_BUF_NUM_SLOTS ), std::memory_order_relaxed );
 
-    // inits for statistics calculation
     if ( !bPreserve )
     {
-        // set the auto filter weights and max statistic count
-        if ( bUseDoubleSystemFrameSize )
-        {
-            dAutoFilt_WightUpNormal   = IIR_WEIGTH_UP_NORMAL_DOUBLE_FRAME_SIZE;
-            dAutoFilt_WightDownNormal = IIR_WEIGTH_DOWN_NORMAL_DOUBLE_FRAME_SIZE;
-            dAutoFilt_WightUpFast     = IIR_WEIGTH_UP_FAST_DOUBLE_FRAME_SIZE;
-            dAutoFilt_WightDownFast   = IIR_WEIGTH_DOWN_FAST_DOUBLE_FRAME_SIZE;
-            iMaxStatisticCount        = MAX_STATISTIC_COUNT_DOUBLE_FRAME_SIZE;
-            dErrorRateBound           = ERROR_RATE_BOUND_DOUBLE_FRAME_SIZE;
-            dUpMaxErrorBound          = UP_MAX_ERROR_BOUND_DOUBLE_FRAME_SIZE;
-        }
-        else
-        {
-            dAutoFilt_WightUpNormal   = IIR_WEIGTH_UP_NORMAL;
-            dAutoFilt_WightDownNormal = IIR_WEIGTH_DOWN_NORMAL;
-            dAutoFilt_WightUpFast     = IIR_WEIGTH_UP_FAST;
-            dAutoFilt_WightDownFast   = IIR_WEIGTH_DOWN_FAST;
-            iMaxStatisticCount        = MAX_STATISTIC_COUNT;
-            dErrorRateBound           = ERROR_RATE_BOUND;
-            dUpMaxErrorBound          = UP_MAX_ERROR_BOUND;
-        }
+        bReqReset.store ( true, std::memory_order_relaxed );
+    }
 
-        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
-        {
-            // init simulation buffers with the correct size
-            SimulationBuffer[i].Init ( iNewBlockSize, viBufSizesForSim[i] );
+    iReqCnt.fetch_add ( 1, std::memory_order_release );
 
-            // init statistics
-            ErrorRateStatistic[i].Init ( iMaxStatisticCount, true );
+    // the very first initialization is done on construction of the owning
+    // object where no other thread accesses the buffer -> apply immediately
+    if ( !bIsInitialized )
+    {
+        bIsInitialized = true;
+        ApplyRequestedSettings();
+    }
+}
+
+void CNetBufWithStats::ApplyRequestedSettings()
+{
+/*
+    this function must only be called by the consumer
+*/
+    const uint32_t iCurReqCnt = iReqCnt.load ( std::memory_order_acquire );
+
+    if ( iCurReqCnt == iAppliedReqCnt )
+    {
+        return; // nothing to do
+    }
+
+    iAppliedReqCnt = iCurReqCnt;
+
+    const int iNewBlockSize = iReqBlockSize.load ( std::memory_order_relaxed );
+    const int iNewNumBlocks = iReqNumBlocks.load ( std::memory_order_relaxed );
+
+    if ( bReqReset.exchange ( false, std::memory_order_relaxed ) ||
+         ( iNewBlockSize != iBlockSize.load ( std::memory_order_relaxed ) ) )
+    {
+        // discard all buffered blocks and restart the statistics
+        iGetCnt.store ( iPutCnt.load ( std::memory_order_acquire ), std::memory_order_release );
+        iNumPendingPuts.store ( 0, std::memory_order_relaxed );
+
+        bUseDoubleSystemFrameSize = bReqUseDoubleSystemFrameSize.load ( std::memory_order_relaxed );
+
+        InitStatistics ( iNewBlockSize );
+
+        iBlockSize.store ( iNewBlockSize, std::memory_order_release );
+        iNumBlocks.store ( iNewNumBlocks, std::memory_order_release );
+    }
+    else
+    {
+        // preserve the buffered blocks, if the buffer shrinks we drop the
+        // oldest blocks which do not fit anymore
+        iNumBlocks.store ( iNewNumBlocks, std::memory_order_release );
+
+        const uint32_t iCurPutCnt   = iPutCnt.load ( std::memory_order_acquire );
+        const uint32_t iCurGetCnt   = iGetCnt.load ( std::memory_order_relaxed );
+        const int      iNumBuffered = static_cast<int> ( iCurPutCnt - iCurGetCnt );
+
+        if ( iNumBuffered > iNewNumBlocks )
+        {
+            iGetCnt.store ( iCurGetCnt + static_cast<uint32_t> ( iNumBuffered - iNewNumBlocks ),
+                            std::memory_order_release );
         }
+    }
+}
 
-        // reset the initialization counter which controls the initialization
-        // phase length
-        ResetInitCounter();
+void CNetBufWithStats::InitStatistics ( const int iNewBlockSize )
+{
+    // set the auto filter weights and max statistic count
+    if ( bUseDoubleSystemFrameSize )
+    {
+        dAutoFilt_WightUpNormal   = IIR_WEIGTH_UP_NORMAL_DOUBLE_FRAME_SIZE;
+        dAutoFilt_WightDownNormal = IIR_WEIGTH_DOWN_NORMAL_DOUBLE_FRAME_SIZE;
+        dAutoFilt_WightUpFast     = IIR_WEIGTH_UP_FAST_DOUBLE_FRAME_SIZE;
+        dAutoFilt_WightDownFast   = IIR_WEIGTH_DOWN_FAST_DOUBLE_FRAME_SIZE;
+        iMaxStatisticCount        = MAX_STATISTIC_COUNT_DOUBLE_FRAME_SIZE;
+        dErrorRateBound           = ERROR_RATE_BOUND_DOUBLE_FRAME_SIZE;
+        dUpMaxErrorBound          = UP_MAX_ERROR_BOUND_DOUBLE_FRAME_SIZE;
+    }
+    else
+    {
+        dAutoFilt_WightUpNormal   = IIR_WEIGTH_UP_NORMAL;
+        dAutoFilt_WightDownNormal = IIR_WEIGTH_DOWN_NORMAL;
+        dAutoFilt_WightUpFast     = IIR_WEIGTH_UP_FAST;
+        dAutoFilt_WightDownFast   = IIR_WEIGTH_DOWN_FAST;
+        iMaxStatisticCount        = MAX_STATISTIC_COUNT;
+        dErrorRateBound           = ERROR_RATE_BOUND;
+        dUpMaxErrorBound          = UP_MAX_ERROR_BOUND;
+    }
+
+    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+    {
+        // init simulation buffers with the correct size
+        SimulationBuffer[i].Init ( iNewBlockSize, viBufSizesForSim[i] );
 
-        // init auto buffer setting with a meaningful value, also init the
-        // IIR parameter with this value
-        iCurAutoBufferSizeSetting = 6;
-        dCurIIRFilterResult       = iCurAutoBufferSizeSetting;
-        iCurDecidedResult         = iCurAutoBufferSizeSetting;
+        // init statistics
+        ErrorRateStatistic[i].Init ( iMaxStatisticCount, true );
     }
+
+    // reset the initialization counter which controls the initialization
+    // phase length
+    ResetInitCounter();
+
+    // init auto buffer setting with a meaningful value, also init the
+    // IIR parameter with this value
+    iCurAutoBufferSizeSetting = 6;
+    dCurIIRFilterResult       = iCurAutoBufferSizeSetting;
+    iCurDecidedResult         = iCurAutoBufferSizeSetting;
 }
 
 void CNetBufWithStats::ResetInitCounter()
@@ -206,26 +289,125 @@ void CNetBufWithStats::ResetInitCounter()
 bool CNetBufWithStats::Put ( const CVector<uint8_t>& vecbyData,
                              const int               iInSize )
 {
-    // call base class Put
-    const bool bPutOK = CNetBuf::Put ( vecbyData, iInSize );
+/*
+    this function must only be called by the producer
+*/
+    bool      bPutOK        = false;
+    const int iCurBlockSize = iBlockSize.load ( std::memory_order_acquire );
+    const int iCurNumBlocks = iNumBlocks.load ( std::memory_order_acquire );
+
+    // the input must consist of complete blocks of the current block size
+    if ( ( iCurBlockSize > 0 ) &&
+         ( iCurBlockSize <= MAX_NET_BUF_BLOCK_SIZE_BYTES ) &&
+         ( iInSize % iCurBlockSize == 0 ) )
+    {
+        const int      iNumNewBlocks = iInSize / iCurBlockSize;
+        const uint32_t iCurPutCnt    = iPutCnt.load ( std::memory_order_relaxed );
+        const uint32_t iCurGetCnt    = iGetCnt.load ( std::memory_order_acquire );
 
-    // update statistics calculations
-    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        // check if there is enough space available
+        if ( static_cast<int> ( iCurPutCnt - iCurGetCnt ) + iNumNewBlocks <= iCurNumBlocks )
+        {
+            for ( int iBlock = 0; iBlock < iNumNewBlocks; iBlock++ )
+            {
+                const int iSlot = ( iCurPutCnt + iBlock ) & ( NET_BUF_NUM_SLOTS - 1 );
+
+                std::copy ( vecbyData.begin() + iBlock * iCurBlockSize,
+                            vecbyData.begin() + ( iBlock + 1 ) * iCurBlockSize,
+                            vecbyMemory.begin() + iSlot * MAX_NET_BUF_BLOCK_SIZE_BYTES );
+
+                veciSlotBlockSize[iSlot] = iCurBlockSize;
+            }
+
+            // publish the new blocks to the consumer
+            iPutCnt.store ( iCurPutCnt + static_cast<uint32_t> ( iNumNewBlocks ), std::memory_order_release );
+
+            bPutOK = true;
+        }
+    }
+
+    if ( !bPutOK )
     {
-        ErrorRateStatistic[i].Update (
-            !SimulationBuffer[i].Put ( vecbyData, iInSize ) );
+        iNumOverruns.store ( iNumOverruns.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
     }
 
+    // the statistics are updated by the consumer
+    iPendingPutSize.store ( iInSize, std::memory_order_relaxed );
+    iNumPendingPuts.fetch_add ( 1, std::memory_order_release );
+
     return bPutOK;
 }
 
 bool CNetBufWithStats::Get ( CVector<uint8_t>& vecbyData,
                              const int         iOutSize )
 {
-    // call base class Get
-    const bool bGetOK = CNetBuf::Get ( vecbyData, iOutSize );
+/*
+    this function must only be called by the consumer
+*/
+    // apply new settings requested by other threads
+    ApplyRequestedSettings();
+
+    bool      bGetOK        = false;
+    const int iCurBlockSize = iBlockSize.load ( std::memory_order_relaxed );
+
+    // check size
+    if ( ( iOutSize != 0 ) && ( iOutSize == iCurBlockSize ) )
+    {
+        const uint32_t iCurPutCnt = iPutCnt.load ( std::memory_order_acquire );
+        uint32_t       iCurGetCnt = iGetCnt.load ( std::memory_order_relaxed );
+
+        // drop blocks which were written with an outdated block size
+        while ( ( iCurGetCnt != iCurPutCnt ) &&
+                ( veciSlotBlockSize[iCurGetCnt & ( NET_BUF_NUM_SLOTS - 1 )] != iCurBlockSize ) )
+        {
+            iCurGetCnt++;
+        }
+
+        if ( iCurGetCnt != iCurPutCnt )
+        {
+            const int iSlot = iCurGetCnt & ( NET_BUF_NUM_SLOTS - 1 );
+
+            std::copy ( vecbyMemory.begin() + iSlot * MAX_NET_BUF_BLOCK_SIZE_BYTES,
+                        vecbyMemory.begin() + iSlot * MAX_NET_BUF_BLOCK_SIZE_BYTES + iOutSize,
+                        vecbyData.begin() );
+
+            iCurGetCnt++;
+            bGetOK = true;
+        }
+
+        // release the slots to the producer
+        iGetCnt.store ( iCurGetCnt, std::memory_order_release );
+    }
+
+    if ( !bGetOK )
+    {
+        iNumUnderruns.store ( iNumUnderruns.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    }
 
     // update statistics calculations
+    UpdateStatistics ( vecbyData, iOutSize );
+
+    return bGetOK;
+}
+
+void CNetBufWithStats::UpdateStatistics ( CVector<uint8_t>& vecbyData,
+                                          const int         iOutSize )
+{
+    // replay the Put() calls since the last Get() call in the simulation
+    // buffers (in simulation mode no data is copied, therefore we can use the
+    // output vector as a dummy argument)
+    const int iNumPuts = iNumPendingPuts.exchange ( 0, std::memory_order_acquire );
+    const int iPutSize = iPendingPutSize.load ( std::memory_order_relaxed );
+
+    for ( int iPut = 0; iPut < iNumPuts; iPut++ )
+    {
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            ErrorRateStatistic[i].Update (
+                !SimulationBuffer[i].Put ( vecbyData, iPutSize ) );
+        }
+    }
+
     for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
     {
         ErrorRateStatistic[i].Update (
@@ -234,8 +416,6 @@ bool CNetBufWithStats::Get ( CVector<uint8_t>& vecbyData,
 
     // update auto setting
     UpdateAutoSetting();
-
-    return bGetOK;
 }
 
 void CNetBufWithStats::UpdateAutoSetting()
@@ -362,11 +542,19 @@ else
 */
 
     // apply a hysteresis
+    const int iLastAutoBufferSizeSetting = iCurAutoBufferSizeSetting;
+
     iCurAutoBufferSizeSetting =
         MathUtils().DecideWithHysteresis ( dCurIIRFilterResult,
                                            iCurDecidedResult,
                                            dHysteresisValue );
 
+    if ( iCurAutoBufferSizeSetting != iLastAutoBufferSizeSetting )
+    {
+        iNumAutoSettingChanges.store ( iNumAutoSettingChanges.load ( std::memory_order_relaxed ) + 1,
+                                       std::memory_order_relaxed );
+    }
+
 
     // Initialization phase check and correction -------------------------------
     // sometimes in the very first period after a connection we get a bad error
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <atomic>
 #include "util.h"
 #include "global.h"
 
@@ -69,6 +70,13 @@
 #define IIR_WEIGTH_UP_FAST                          0.9997499687422
 #define IIR_WEIGTH_DOWN_FAST                        0.999499875
 
+// number of block slots of the lock-free jitter buffer, must be a power of two
+// which is not smaller than MAX_NET_BUF_SIZE_NUM_BL
+#define NET_BUF_NUM_SLOTS                           32
+
+// maximum size of one jitter buffer block (maximum size of one Opus frame)
+#define MAX_NET_BUF_BLOCK_SIZE_BYTES                1275
+
 
 /* Classes ********************************************************************/
 // Buffer base class -----------------------------------------------------------
@@ -421,7 +429,16 @@ protected:
 
 
 // Network buffer (jitter buffer) with statistic calculations ------------------
-class CNetBufWithStats : public CNetBuf
+// The jitter buffer is a wait-free single-producer/single-consumer ring of
+// preallocated blocks: the network receive thread is the only one which calls
+// Put() and the audio thread (server timer or client sound card callback) is
+// the only one which calls Get(), i.e. the two threads never block each other.
+// Init() may be called from any thread (calls must be serialized by the
+// caller). The new settings are applied by the consumer at the next Get()
+// call, only the very first Init() call is applied immediately. The statistic
+// calculations are also done on the consumer side, the producer just counts
+// the Put() calls which are replayed in the simulation buffers.
+class CNetBufWithStats
 {
 public:
     CNetBufWithStats();
@@ -430,20 +447,61 @@ public:
                 const int  iNewNumBlocks,
                 const bool bPreserve = false );
 
-    void SetUseDoubleSystemFrameSize ( const bool bNDSFSize ) { bUseDoubleSystemFrameSize = bNDSFSize; }
+    void SetUseDoubleSystemFrameSize ( const bool bNDSFSize ) { bReqUseDoubleSystemFrameSize = bNDSFSize; }
 
-    virtual bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize );
-    virtual bool Get ( CVector<uint8_t>& vecbyData, const int iOutSize );
+    bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize );
+    bool Get ( CVector<uint8_t>& vecbyData, const int iOutSize );
 
     int GetAutoSetting() { return iCurAutoBufferSizeSetting; }
     void GetErrorRates ( CVector<double>& vecErrRates,
                          double&          dLimit,
                          double&          dMaxUpLimit );
 
+    // cumulative counters for monitoring (may be read by any thread)
+    uint64_t GetNumUnderruns() const { return iNumUnderruns.load ( std::memory_order_relaxed ); }
+    uint64_t GetNumOverruns() const { return iNumOverruns.load ( std::memory_order_relaxed ); }
+    uint64_t GetNumAutoSettingChanges() const { return iNumAutoSettingChanges.load ( std::memory_order_relaxed ); }
+
 protected:
+    void ApplyRequestedSettings();
+    void InitStatistics ( const int iNewBlockSize );
+    void UpdateStatistics ( CVector<uint8_t>& vecbyData, const int iOutSize );
     void UpdateAutoSetting();
     void ResetInitCounter();
 
+    // block memory and the block size each slot was written with (blocks of
+    // an outdated block size are dropped by the consumer)
+    CVector<uint8_t>      vecbyMemory;
+    CVector<int>          veciSlotBlockSize;
+
+    // the put counter is only written by the producer, the get counter is
+    // only written by the consumer (both count blocks and wrap around)
+    std::atomic<uint32_t> iPutCnt;
+    std::atomic<uint32_t> iGetCnt;
+
+    // current settings, only written by the consumer
+    std::atomic<int>      iBlockSize;
+    std::atomic<int>      iNumBlocks;
+
+    // requested settings which are applied by the consumer
+    std::atomic<int>      iReqBlockSize;
+    std::atomic<int>      iReqNumBlocks;
+    std::atomic<bool>     bReqReset;
+    std::atomic<bool>     bReqUseDoubleSystemFrameSize;
+    std::atomic<uint32_t> iReqCnt;
+    uint32_t              iAppliedReqCnt;
+    bool                  bIsInitialized;
+
+    // Put() calls which are not yet applied to the simulation buffers
+    std::atomic<int>      iNumPendingPuts;
+    std::atomic<int>      iPendingPutSize;
+
+    // counters of failed Get() calls (written by the consumer), failed Put()
+    // calls (written by the producer) and changes of the auto setting
+    std::atomic<uint64_t> iNumUnderruns;
+    std::atomic<uint64_t> iNumOverruns;
+    std::atomic<uint64_t> iNumAutoSettingChanges;
+
     // statistic (do not use the vector class since the classes do not have
     // appropriate copy constructor/operator)
     CErrorRate ErrorRateStatistic[NUM_STAT_SIMULATION_BUFFERS];
@@ -36,7 +36,11 @@ CChannel::CChannel ( const bool bNIsServer ) :
     bIsEnabled             ( false ),
     bIsServer              ( bNIsServer ),
     iAudioFrameSizeSamples ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES ),
-    SignalLevelMeter       ( false, 0.5 ) // server mode with mono out and faster smoothing
+    bChannelLevelsRequired ( false ),
+    SignalLevelMeter       ( false, 0.5 ), // server mode with mono out and faster smoothing
+    fLevelPeak             ( 0.0f ),
+    bResetLevelMeter       ( false ),
+    bNewLevelsSubscriber   ( false )
 {
     // reset network transport properties
     ResetNetworkTransportProperties();
@@ -442,7 +446,7 @@ void CChannel::OnNetTranspPropsReceived ( CNetworkTransportProps NetworkTranspor
 
             // the fade-in counter maximum value may have changed, make sure the fade-in counter
             // is not larger than the allowed maximum value
-            iFadeInCnt = std::min ( iFadeInCnt, iFadeInCntMax );
+            iFadeInCnt = std::min ( iFadeInCnt.load(), iFadeInCntMax );
 
             MutexSocketBuf.lock();
             {
@@ -526,59 +530,62 @@ EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData,
     if ( ( bIsServer || ( GetAddress() == RecHostAddr ) ) &&
          IsEnabled() )
     {
-        MutexSocketBuf.lock();
+        // note that no lock is required here since the jitter buffer is a
+        // lock-free single-producer/single-consumer buffer
+
+        // only process audio if packet has correct size
+        if ( iNumBytes == ( iNetwFrameSize * iNetwFrameSizeFact ) )
         {
-            // only process audio if packet has correct size
-            if ( iNumBytes == ( iNetwFrameSize * iNetwFrameSizeFact ) )
+            // store new packet in jitter buffer
+            if ( SockBuf.Put ( vecbyData, iNumBytes ) )
             {
-                // store new packet in jitter buffer
-                if ( SockBuf.Put ( vecbyData, iNumBytes ) )
-                {
-                    eRet = PS_AUDIO_OK;
-                }
-                else
-                {
-                    eRet = PS_AUDIO_ERR;
-                }
-
-                // manage audio fade-in counter
-                if ( iFadeInCnt < iFadeInCntMax )
-                {
-                    iFadeInCnt++;
-                }
+                eRet = PS_AUDIO_OK;
             }
             else
             {
-                // the protocol parsing failed and this was no audio block,
-                // we treat this as protocol error (unknown packet)
-                eRet = PS_PROT_ERR;
+                eRet = PS_AUDIO_ERR;
             }
 
-            // All network packets except of valid protocol messages
-            // regardless if they are valid or invalid audio packets lead to
-            // a state change to a connected channel.
-            // This is because protocol messages can only be sent on a
-            // connected channel and the client has to inform the server
-            // about the audio packet properties via the protocol.
-
-            // check if channel was not connected, this is a new connection
-            if ( !IsConnected() )
+            // manage audio fade-in counter
+            if ( iFadeInCnt < iFadeInCntMax )
             {
-                // overwrite status
-                eRet = PS_NEW_CONNECTION;
+                iFadeInCnt++;
+            }
+        }
+        else
+        {
+            // the protocol parsing failed and this was no audio block,
+            // we treat this as protocol error (unknown packet)
+            eRet = PS_PROT_ERR;
+        }
 
-                // init audio fade-in counter
-                iFadeInCnt = 0;
+        // All network packets except of valid protocol messages
+        // regardless if they are valid or invalid audio packets lead to
+        // a state change to a connected channel.
+        // This is because protocol messages can only be sent on a
+        // connected channel and the client has to inform the server
+        // about the audio packet properties via the protocol.
 
-                // init level meter
-                SignalLevelMeter.Reset();
-            }
+        // Reset the time-out counter. The connection check and the reset must
+        // be one atomic step since the timer thread may decrement the counter
+        // to zero (and disconnect the channel) at the same time. If the
+        // previous value was zero, the channel was not connected and this is
+        // a new connection.
+        int iPrevConTimeOut = iConTimeOut.load();
+
+        while ( !iConTimeOut.compare_exchange_weak ( iPrevConTimeOut, iConTimeOutStartVal ) ) {}
 
-            // reset time-out counter (note that this must be done after the
-            // "IsConnected()" query above)
-            ResetTimeOutCounter();
+        if ( iPrevConTimeOut == 0 )
+        {
+            // overwrite status
+            eRet = PS_NEW_CONNECTION;
+
+            // init audio fade-in counter
+            iFadeInCnt = 0;
+
+            // the level meter is used by the timer thread, it is reset there
+            bResetLevelMeter = true;
         }
-        MutexSocketBuf.unlock();
     }
     else
     {
@@ -593,50 +600,57 @@ EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData,
 {
     EGetDataStat eGetStatus;
 
-    MutexSocketBuf.lock();
+    // get the next block from the jitter buffer (lock-free)
+    const bool bSockBufState = SockBuf.Get ( vecbyData, iNumBytes );
+
+    // Decrease time-out counter. We subtract the number of samples of the
+    // current block since the time out counter is based on samples not on
+    // blocks (definition: always one atomic block is get by using the
+    // GetData() function where the atomic block size is
+    // "iAudioFrameSizeSamples"). Since the network receive thread may reset
+    // the counter at the same time, we have to use an atomic update.
+    bool bIsConnected       = false;
+    bool bIsNowDisconnected = false;
+    int  iCurConTimeOut     = iConTimeOut.load();
+
+    while ( iCurConTimeOut > 0 )
     {
-        // the socket access must be inside a mutex
-        const bool bSockBufState = SockBuf.Get ( vecbyData, iNumBytes );
+        const int iNewConTimeOut = std::max ( iCurConTimeOut - iAudioFrameSizeSamples, 0 );
 
-        // decrease time-out counter
-        if ( iConTimeOut > 0 )
+        if ( iConTimeOut.compare_exchange_weak ( iCurConTimeOut, iNewConTimeOut ) )
         {
-            // subtract the number of samples of the current block since the
-            // time out counter is based on samples not on blocks (definition:
-            // always one atomic block is get by using the GetData() function
-            // where the atomic block size is "iAudioFrameSizeSamples")
-            iConTimeOut -= iAudioFrameSizeSamples;
+            bIsConnected       = true;
+            bIsNowDisconnected = ( iNewConTimeOut == 0 );
+            break;
+        }
+    }
 
-            if ( iConTimeOut <= 0 )
-            {
-                // channel is just disconnected
-                eGetStatus  = GS_CHAN_NOW_DISCONNECTED;
-                iConTimeOut = 0; // make sure we do not have negative values
+    if ( bIsNowDisconnected )
+    {
+        // channel is just disconnected
+        eGetStatus = GS_CHAN_NOW_DISCONNECTED;
 
-                // reset network transport properties
-                ResetNetworkTransportProperties();
-            }
-            else
-            {
-                if ( bSockBufState )
-                {
-                    // everything is ok
-                    eGetStatus = GS_BUFFER_OK;
-                }
-                else
-                {
-                    // channel is not yet disconnected but no data in buffer
-                    eGetStatus = GS_BUFFER_UNDERRUN;
-                }
-            }
+        // reset network transport properties
+        ResetNetworkTransportProperties();
+    }
+    else if ( bIsConnected )
+    {
+        if ( bSockBufState )
+        {
+            // everything is ok
+            eGetStatus = GS_BUFFER_OK;
         }
         else
         {
-            // channel is disconnected
-            eGetStatus = GS_CHAN_NOT_CONNECTED;
+            // channel is not yet disconnected but no data in buffer
+            eGetStatus = GS_BUFFER_UNDERRUN;
         }
     }
-    MutexSocketBuf.unlock();
+    else
+    {
+        // channel is disconnected
+        eGetStatus = GS_CHAN_NOT_CONNECTED;
+    }
 
     // in case we are just disconnected, we have to fire a message
     if ( eGetStatus == GS_CHAN_NOW_DISCONNECTED )
@@ -655,21 +669,36 @@ void CChannel::PrepAndSendPacket ( CHighPrioSocket*        pSocket,
     QMutexLocker locker ( &MutexConvBuf );
 
     // use conversion buffer to convert sound card block size in network
-    // block size
+    // block size (on the server the packet is put in the send queue of the
+    // socket which is flushed at the end of the timer tick, on the client the
+    // socket has no send queue and the packet is sent directly)
     if ( ConvBuf.Put ( vecbyNPacket, iNPacketLen ) )
     {
-        pSocket->SendPacket ( ConvBuf.GetAll(), GetAddress() );
+        pSocket->QueuePacket ( ConvBuf.GetAll(), GetAddress() );
     }
 }
 
-double CChannel::UpdateAndGetLevelForMeterdB ( const CVector<short>& vecsAudio,
-                                               const int             iInSize,
-                                               const bool            bIsStereoIn )
+void CChannel::UpdateLevelPeak ( const float fPeak )
 {
-    // update the signal level meter and immediately return the current value
-    SignalLevelMeter.Update ( vecsAudio,
-                              iInSize,
-                              bIsStereoIn );
+    // reset the level meter on a new connection
+    if ( bResetLevelMeter.load ( std::memory_order_relaxed ) && bResetLevelMeter.exchange ( false ) )
+    {
+        SignalLevelMeter.Reset();
+        fLevelPeak = 0.0f;
+    }
+
+    fLevelPeak = std::max ( fLevelPeak, fPeak );
+}
+
+double CChannel::UpdateAndGetLevelForMeterdB()
+{
+    // update the signal level meter with the peak of all samples since the
+    // last update (scaled like the conversion to 16 bit samples, the meter is
+    // in mono out mode, i.e., the peak of both stereo channels is used) and
+    // immediately return the current value
+    SignalLevelMeter.Update ( static_cast<double> ( fLevelPeak ) * 32768.0, 0.0 );
+
+    fLevelPeak = 0.0f;
 
     return SignalLevelMeter.GetLevelForMeterdBLeftOrMono();
 }
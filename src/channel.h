@@ -110,7 +110,7 @@ public:
 
     void SetGain ( const int iChanID, const double dNewGain );
     double GetGain ( const int iChanID );
-    double GetFadeInGain() { return static_cast<double> ( iFadeInCnt ) / iFadeInCntMax; }
+    double GetFadeInGain() { return static_cast<double> ( iFadeInCnt.load() ) / iFadeInCntMax; }
 
     void SetPan ( const int iChanID, const double dNewPan );
     double GetPan ( const int iChanID );
@@ -146,6 +146,10 @@ public:
     void GetBufErrorRates ( CVector<double>& vecErrRates, double& dLimit, double& dMaxUpLimit )
         { SockBuf.GetErrorRates ( vecErrRates, dLimit, dMaxUpLimit ); }
 
+    uint64_t GetBufNumUnderruns() const { return SockBuf.GetNumUnderruns(); }
+    uint64_t GetBufNumOverruns() const { return SockBuf.GetNumOverruns(); }
+    uint64_t GetBufNumAutoSettingChanges() const { return SockBuf.GetNumAutoSettingChanges(); }
+
     EAudComprType GetAudioCompressionType() { return eAudioCompressionType; }
     int GetNumAudioChannels() const { return iNumAudioChannels; }
 
@@ -168,16 +172,32 @@ public:
     void CreateConClientListMes ( const CVector<CChannelInfo>& vecChanInfo )
         { Protocol.CreateConClientListMes ( vecChanInfo ); }
 
+    void CreateConClientListMes ( const CVector<CChannelInfo>&      vecChanInfo,
+                                  const CProtocol::CPreparedMessage& FullListMess )
+        { Protocol.CreateConClientListMes ( vecChanInfo, FullListMess ); }
+
+    void SendPreparedMes ( const CProtocol::CPreparedMessage& PrepMess )
+        { Protocol.SendPreparedMessage ( PrepMess ); }
+
     void CreateRecorderStateMes ( const ERecorderState eRecorderState )
         { Protocol.CreateRecorderStateMes ( eRecorderState ); }
 
     CNetworkTransportProps GetNetworkTransportPropsFromCurrentSettings();
 
-    bool ChannelLevelsRequired() const { return bChannelLevelsRequired; }
+    bool ChannelLevelsRequired() const { return bChannelLevelsRequired.load ( std::memory_order_relaxed ); }
+
+    // returns true once after the client opted in to the channel level list
+    // (the flag is set by the main thread and reset by the server timer thread)
+    bool GetAndResetNewLevelsSubscriber()
+    {
+        return bNewLevelsSubscriber.load ( std::memory_order_relaxed ) && bNewLevelsSubscriber.exchange ( false );
+    }
 
-    double UpdateAndGetLevelForMeterdB ( const CVector<short>& vecsAudio,
-                                         const int             iInSize,
-                                         const bool            bIsStereoIn );
+    // the peak of the decoded audio is collected in each server timer tick and
+    // the level meter is updated with the maximum since the last update (both
+    // functions must only be called by the server timer thread)
+    void   UpdateLevelPeak ( const float fPeak );
+    double UpdateAndGetLevelForMeterdB();
 
 protected:
     bool ProtocolIsEnabled();
@@ -214,9 +234,9 @@ protected:
     // network protocol
     CProtocol               Protocol;
 
-    int                     iConTimeOut;
+    std::atomic<int>        iConTimeOut;
     int                     iConTimeOutStartVal;
-    int                     iFadeInCnt;
+    std::atomic<int>        iFadeInCnt;
     int                     iFadeInCntMax;
 
     bool                    bIsEnabled;
@@ -230,12 +250,15 @@ protected:
     int                     iNumAudioChannels;
 
     QMutex                  Mutex;
-    QMutex                  MutexSocketBuf;
+    QMutex                  MutexSocketBuf; // only serializes the jitter buffer settings changes
     QMutex                  MutexConvBuf;
 
-    bool                    bChannelLevelsRequired;
+    std::atomic<bool>       bChannelLevelsRequired;
 
     CStereoSignalLevelMeter SignalLevelMeter;
+    float                   fLevelPeak;
+    std::atomic<bool>       bResetLevelMeter; // set on a new connection by the socket thread
+    std::atomic<bool>       bNewLevelsSubscriber;
 
 public slots:
     void OnSendProtMessage ( CVector<uint8_t> vecMessage );
@@ -271,7 +294,15 @@ public slots:
 
     void OnNewConnection() { emit NewConnection(); }
 
-    void OnReqChannelLevelList ( bool bOptIn ) { bChannelLevelsRequired = bOptIn; }
+    void OnReqChannelLevelList ( bool bOptIn )
+    {
+        bChannelLevelsRequired = bOptIn;
+
+        if ( bOptIn )
+        {
+            bNewLevelsSubscriber = true;
+        }
+    }
 
 signals:
     void MessReadyForSending ( CVector<uint8_t> vecMessage );
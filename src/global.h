@@ -137,7 +137,9 @@ LED bar:      lbr
 // Maximum block size for network input buffer. It is defined by the longest
 // protocol message which is PROTMESSID_CLM_SERVER_LIST: Worst case:
 // (2+2+1+2+2)+200*(4+2+2+1+1+2+20+2+32+2+20)=17609
-// We add some headroom to that value.
+// We add some headroom to that value. Note that the connected clients list of
+// a server with MAX_NUM_CHANNELS clients would be larger, it is therefore
+// limited to this size (see MAX_SIZE_BYTES_CONN_CLIENTS_LIST).
 #define MAX_SIZE_BYTES_NETW_BUF          20000
 
 // minimum/maximum network buffer size (which can be chosen by slider)
@@ -176,8 +178,10 @@ LED bar:      lbr
 #define RED_BOUND_LED_BAR                7
 #define YELLOW_BOUND_LED_BAR             5
 
-// maximum number of connected clients at the server (must not be larger than 256)
-#define MAX_NUM_CHANNELS                 50 // max number channels for server
+// maximum number of connected clients at the server (must not be larger than 256
+// since the channel ID is transmitted as one byte), the server allocates the
+// channels dynamically for the number of channels given on the command line
+#define MAX_NUM_CHANNELS                 250 // max number channels for server
 
 // actual number of used channels in the server
 // this parameter can safely be changed from 1 to MAX_NUM_CHANNELS
@@ -197,6 +201,12 @@ LED bar:      lbr
 // defines the interval between Channel Level updates from the server
 #define CHANNEL_LEVEL_UPDATE_INTERVAL    200  // number of frames at 64 samples frame size
 
+// the Channel Levels are only sent if a level has changed by at least the given
+// number of meter steps or if the given number of updates were skipped (since
+// the message may get lost)
+#define CHANNEL_LEVEL_MIN_CHANGE         1
+#define CHANNEL_LEVEL_KEEP_ALIVE_UPDATES 4
+
 // time-out until a registered server is deleted from the server list if no
 // new registering was made in minutes
 #define SERVLIST_TIME_OUT_MINUTES        33 // minutes (should include 3 UDP registration messages)
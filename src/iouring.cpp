@@ -0,0 +1,540 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2020
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include "iouring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+
+/* Implementation *************************************************************/
+// Ring ------------------------------------------------------------------------
+CIoUring::CIoUring() :
+    iRingFd        ( -1 ),
+    iSqTailLocal   ( 0 ),
+    pSqRingMem     ( nullptr ),
+    iSqRingMemSize ( 0 ),
+    pCqRingMem     ( nullptr ),
+    iCqRingMemSize ( 0 ),
+    pSqes          ( nullptr ),
+    iSqesMemSize   ( 0 ),
+    pSqHead        ( nullptr ),
+    pSqTail        ( nullptr ),
+    iSqMask        ( 0 ),
+    iSqEntries     ( 0 ),
+    pCqHead        ( nullptr ),
+    pCqTail        ( nullptr ),
+    iCqMask        ( 0 ),
+    pCqes          ( nullptr )
+{
+}
+
+bool CIoUring::Setup ( const unsigned int iNumSqEntries,
+                       const unsigned int iNumCqEntries )
+{
+    io_uring_params Params;
+    memset ( &Params, 0, sizeof ( Params ) );
+
+    Params.flags      = IORING_SETUP_CQSIZE;
+    Params.cq_entries = iNumCqEntries;
+
+    iRingFd = static_cast<int> ( syscall ( __NR_io_uring_setup, iNumSqEntries, &Params ) );
+
+    if ( iRingFd < 0 )
+    {
+        iRingFd = -1;
+        return false;
+    }
+
+    // map the submission and completion queue rings (with a single mapping if
+    // the kernel supports it) and the submission queue entries
+    iSqRingMemSize = Params.sq_off.array + Params.sq_entries * sizeof ( unsigned int );
+    iCqRingMemSize = Params.cq_off.cqes + Params.cq_entries * sizeof ( io_uring_cqe );
+    iSqesMemSize   = Params.sq_entries * sizeof ( io_uring_sqe );
+
+    const bool bSingleMmap = ( Params.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+
+    if ( bSingleMmap )
+    {
+        iSqRingMemSize = std::max ( iSqRingMemSize, iCqRingMemSize );
+        iCqRingMemSize = iSqRingMemSize;
+    }
+
+    pSqRingMem = mmap ( nullptr, iSqRingMemSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, iRingFd, IORING_OFF_SQ_RING );
+
+    if ( pSqRingMem == MAP_FAILED )
+    {
+        pSqRingMem = nullptr;
+        Close();
+        return false;
+    }
+
+    if ( bSingleMmap )
+    {
+        pCqRingMem = pSqRingMem;
+    }
+    else
+    {
+        pCqRingMem = mmap ( nullptr, iCqRingMemSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, iRingFd, IORING_OFF_CQ_RING );
+
+        if ( pCqRingMem == MAP_FAILED )
+        {
+            pCqRingMem = nullptr;
+            Close();
+            return false;
+        }
+    }
+
+    void* pSqesMem = mmap ( nullptr, iSqesMemSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, iRingFd, IORING_OFF_SQES );
+
+    if ( pSqesMem == MAP_FAILED )
+    {
+        Close();
+        return false;
+    }
+
+    pSqes = static_cast<io_uring_sqe*> ( pSqesMem );
+
+    uint8_t* pSqRing = static_cast<uint8_t*> ( pSqRingMem );
+    uint8_t* pCqRing = static_cast<uint8_t*> ( pCqRingMem );
+
+    pSqHead      = reinterpret_cast<unsigned int*> ( pSqRing + Params.sq_off.head );
+    pSqTail      = reinterpret_cast<unsigned int*> ( pSqRing + Params.sq_off.tail );
+    iSqMask      = *reinterpret_cast<unsigned int*> ( pSqRing + Params.sq_off.ring_mask );
+    iSqEntries   = *reinterpret_cast<unsigned int*> ( pSqRing + Params.sq_off.ring_entries );
+    iSqTailLocal = *pSqTail;
+
+    pCqHead = reinterpret_cast<unsigned int*> ( pCqRing + Params.cq_off.head );
+    pCqTail = reinterpret_cast<unsigned int*> ( pCqRing + Params.cq_off.tail );
+    iCqMask = *reinterpret_cast<unsigned int*> ( pCqRing + Params.cq_off.ring_mask );
+    pCqes   = reinterpret_cast<io_uring_cqe*> ( pCqRing + Params.cq_off.cqes );
+
+    // we always use the submission queue entry with the same index as the
+    // ring slot
+    unsigned int* pSqArray = reinterpret_cast<unsigned int*> ( pSqRing + Params.sq_off.array );
+
+    for ( unsigned int i = 0; i < iSqEntries; i++ )
+    {
+        pSqArray[i] = i;
+    }
+
+    return true;
+}
+
+void CIoUring::Close()
+{
+    if ( pSqes != nullptr )
+    {
+        munmap ( pSqes, iSqesMemSize );
+        pSqes = nullptr;
+    }
+
+    if ( ( pCqRingMem != nullptr ) && ( pCqRingMem != pSqRingMem ) )
+    {
+        munmap ( pCqRingMem, iCqRingMemSize );
+    }
+    pCqRingMem = nullptr;
+
+    if ( pSqRingMem != nullptr )
+    {
+        munmap ( pSqRingMem, iSqRingMemSize );
+        pSqRingMem = nullptr;
+    }
+
+    if ( iRingFd >= 0 )
+    {
+        close ( iRingFd );
+        iRingFd = -1;
+    }
+}
+
+io_uring_sqe* CIoUring::GetSqe()
+{
+    const unsigned int iHead = __atomic_load_n ( pSqHead, __ATOMIC_ACQUIRE );
+
+    if ( iSqTailLocal - iHead >= iSqEntries )
+    {
+        return nullptr;
+    }
+
+    io_uring_sqe* pSqe = &pSqes[iSqTailLocal & iSqMask];
+    memset ( pSqe, 0, sizeof ( io_uring_sqe ) );
+
+    iSqTailLocal++;
+
+    return pSqe;
+}
+
+int CIoUring::Enter ( const unsigned int iMinComplete,
+                      const int          iTimeoutMs )
+{
+    // publish the prepared entries to the kernel
+    const unsigned int iNumToSubmit = iSqTailLocal - *pSqTail;
+
+    __atomic_store_n ( pSqTail, iSqTailLocal, __ATOMIC_RELEASE );
+
+    unsigned int iFlags = ( iMinComplete > 0 ) ? IORING_ENTER_GETEVENTS : 0;
+    long         iRet;
+
+    if ( iTimeoutMs >= 0 )
+    {
+        // wait with a time out (Linux 5.11)
+        __kernel_timespec TimeOut;
+        TimeOut.tv_sec  = iTimeoutMs / 1000;
+        TimeOut.tv_nsec = ( iTimeoutMs % 1000 ) * 1000000L;
+
+        io_uring_getevents_arg Arg;
+        memset ( &Arg, 0, sizeof ( Arg ) );
+        Arg.ts = reinterpret_cast<uint64_t> ( &TimeOut );
+
+        iFlags |= IORING_ENTER_EXT_ARG;
+
+        iRet = syscall ( __NR_io_uring_enter, iRingFd, iNumToSubmit, iMinComplete,
+                         iFlags, &Arg, sizeof ( Arg ) );
+    }
+    else
+    {
+        iRet = syscall ( __NR_io_uring_enter, iRingFd, iNumToSubmit, iMinComplete,
+                         iFlags, nullptr, 0 );
+    }
+
+    return ( iRet < 0 ) ? -errno : static_cast<int> ( iRet );
+}
+
+io_uring_cqe* CIoUring::PeekCqe()
+{
+    const unsigned int iHead = *pCqHead;
+
+    if ( iHead == __atomic_load_n ( pCqTail, __ATOMIC_ACQUIRE ) )
+    {
+        return nullptr;
+    }
+
+    return &pCqes[iHead & iCqMask];
+}
+
+void CIoUring::CqAdvance()
+{
+    __atomic_store_n ( pCqHead, *pCqHead + 1, __ATOMIC_RELEASE );
+}
+
+
+// Receiver --------------------------------------------------------------------
+CIoUringReceiver::CIoUringReceiver() :
+    iSocket         ( -1 ),
+    iNumBuffers     ( 0 ),
+    iBufferSize     ( 0 ),
+    bReceiveArmed   ( false ),
+    iCurBufferID    ( -1 ),
+    pBufferMem      ( nullptr ),
+    pBufRing        ( nullptr ),
+    iBufRingMemSize ( 0 ),
+    iBufRingTail    ( 0 )
+{
+    memset ( &RecvMsgHdr, 0, sizeof ( RecvMsgHdr ) );
+}
+
+CIoUringReceiver::~CIoUringReceiver()
+{
+    // the kernel must not write in the buffers anymore when they are freed
+    Close();
+
+    if ( pBufRing != nullptr )
+    {
+        munmap ( pBufRing, iBufRingMemSize );
+    }
+
+    delete[] pBufferMem;
+}
+
+bool CIoUringReceiver::Init ( const int iNewSocket,
+                              const int iNewNumBuffers,
+                              const int iNewBufferSize )
+{
+    iSocket     = iNewSocket;
+    iNumBuffers = iNewNumBuffers; // must be a power of two
+    iBufferSize = iNewBufferSize;
+
+    // each buffer can produce a completion before we process them, the
+    // submission queue only holds the single receive request
+    if ( !Setup ( 4, 2 * static_cast<unsigned int> ( iNumBuffers ) ) )
+    {
+        return false;
+    }
+
+    // the buffer ring must be page aligned
+    iBufRingMemSize = iNumBuffers * sizeof ( io_uring_buf );
+
+    void* pBufRingMem = mmap ( nullptr, iBufRingMemSize, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    if ( pBufRingMem == MAP_FAILED )
+    {
+        Close();
+        return false;
+    }
+
+    // note that we do not use the bufs member of io_uring_buf_ring since the
+    // flexible array declaration has a different offset in C++
+    pBufRing = static_cast<io_uring_buf*> ( pBufRingMem );
+
+    // register the buffer ring (Linux 5.19)
+    io_uring_buf_reg BufReg;
+    memset ( &BufReg, 0, sizeof ( BufReg ) );
+
+    BufReg.ring_addr    = reinterpret_cast<uint64_t> ( pBufRing );
+    BufReg.ring_entries = static_cast<uint32_t> ( iNumBuffers );
+    BufReg.bgid         = 0;
+
+    if ( syscall ( __NR_io_uring_register, iRingFd, IORING_REGISTER_PBUF_RING, &BufReg, 1 ) < 0 )
+    {
+        Close();
+        return false;
+    }
+
+    // provide all buffers to the kernel
+    pBufferMem   = new uint8_t[static_cast<size_t> ( iNumBuffers ) * iBufferSize];
+    iBufRingTail = 0;
+
+    for ( int i = 0; i < iNumBuffers; i++ )
+    {
+        ReturnBuffer ( i );
+    }
+
+    // the received data in a buffer starts with a header followed by the
+    // sender address and the payload
+    RecvMsgHdr.msg_namelen    = sizeof ( sockaddr_in );
+    RecvMsgHdr.msg_controllen = 0;
+
+    // check that the kernel supports multishot recvmsg (Linux 6.0), an invalid
+    // request is completed immediately on submission
+    ArmReceive();
+
+    if ( Enter ( 0 ) < 0 )
+    {
+        Close();
+        return false;
+    }
+
+    io_uring_cqe* pCqe = PeekCqe();
+
+    if ( ( pCqe != nullptr ) && ( pCqe->res < 0 ) && !( pCqe->flags & IORING_CQE_F_MORE ) )
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void CIoUringReceiver::ArmReceive()
+{
+    io_uring_sqe* pSqe = GetSqe();
+
+    if ( pSqe != nullptr )
+    {
+        pSqe->opcode    = IORING_OP_RECVMSG;
+        pSqe->fd        = iSocket;
+        pSqe->addr      = reinterpret_cast<uint64_t> ( &RecvMsgHdr );
+        pSqe->len       = 1;
+        pSqe->ioprio    = IORING_RECV_MULTISHOT;
+        pSqe->flags     = IOSQE_BUFFER_SELECT;
+        pSqe->buf_group = 0;
+
+        bReceiveArmed = true;
+    }
+}
+
+void CIoUringReceiver::ReturnBuffer ( const int iBufferID )
+{
+    io_uring_buf& Buf = pBufRing[iBufRingTail & ( iNumBuffers - 1 )];
+
+    Buf.addr = reinterpret_cast<uint64_t> ( pBufferMem + static_cast<size_t> ( iBufferID ) * iBufferSize );
+    Buf.len  = static_cast<uint32_t> ( iBufferSize );
+    Buf.bid  = static_cast<uint16_t> ( iBufferID );
+
+    iBufRingTail++;
+
+    __atomic_store_n ( &pBufRing[0].resv, iBufRingTail, __ATOMIC_RELEASE );
+}
+
+bool CIoUringReceiver::GetNextPacket ( const uint8_t*& pData,
+                                       int&            iNumBytes,
+                                       sockaddr_in&    SenderAddr,
+                                       const int       iTimeoutMs )
+{
+    // the previous datagram is processed, give its buffer back to the kernel
+    if ( iCurBufferID >= 0 )
+    {
+        ReturnBuffer ( iCurBufferID );
+        iCurBufferID = -1;
+    }
+
+    while ( true )
+    {
+        io_uring_cqe* pCqe = PeekCqe();
+
+        if ( pCqe == nullptr )
+        {
+            // the multishot request is terminated if the kernel runs out of
+            // buffers, in that case it has to be submitted again
+            if ( !bReceiveArmed )
+            {
+                ArmReceive();
+            }
+
+            if ( ( Enter ( 1, iTimeoutMs ) < 0 ) && ( PeekCqe() == nullptr ) )
+            {
+                return false; // time out or the wait was interrupted
+            }
+
+            continue;
+        }
+
+        const int          iRes   = pCqe->res;
+        const unsigned int iFlags = pCqe->flags;
+
+        CqAdvance();
+
+        if ( !( iFlags & IORING_CQE_F_MORE ) )
+        {
+            bReceiveArmed = false;
+        }
+
+        if ( !( iFlags & IORING_CQE_F_BUFFER ) )
+        {
+            // no buffer was available, the request is submitted again on the
+            // next wait, all other errors are returned to the caller
+            if ( iRes == -ENOBUFS )
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        const int iBufferID = static_cast<int> ( iFlags >> IORING_CQE_BUFFER_SHIFT );
+        uint8_t*  pBuffer   = pBufferMem + static_cast<size_t> ( iBufferID ) * iBufferSize;
+
+        const io_uring_recvmsg_out* pRecvMsgOut = reinterpret_cast<const io_uring_recvmsg_out*> ( pBuffer );
+
+        if ( ( iRes < 0 ) ||
+             ( pRecvMsgOut->flags & MSG_TRUNC ) ||
+             ( pRecvMsgOut->namelen < sizeof ( sockaddr_in ) ) )
+        {
+            // drop invalid and truncated datagrams
+            ReturnBuffer ( iBufferID );
+            continue;
+        }
+
+        memcpy ( &SenderAddr, pBuffer + sizeof ( io_uring_recvmsg_out ), sizeof ( sockaddr_in ) );
+
+        pData        = pBuffer + sizeof ( io_uring_recvmsg_out ) + RecvMsgHdr.msg_namelen + RecvMsgHdr.msg_controllen;
+        iNumBytes    = static_cast<int> ( pRecvMsgOut->payloadlen );
+        iCurBufferID = iBufferID;
+
+        return true;
+    }
+}
+
+
+// Sender ----------------------------------------------------------------------
+bool CIoUringSender::Init ( const int          iNewSocket,
+                            const unsigned int iNumEntries )
+{
+    iSocket = iNewSocket;
+
+    return Setup ( iNumEntries, 2 * iNumEntries );
+}
+
+bool CIoUringSender::SendMessages ( mmsghdr*  pMsgHdrs,
+                                    const int iNumMsgs )
+{
+    int iFirst = 0;
+
+    while ( iFirst < iNumMsgs )
+    {
+        // prepare as many requests as fit in the submission queue
+        int iNumBatch = 0;
+
+        while ( iFirst + iNumBatch < iNumMsgs )
+        {
+            io_uring_sqe* pSqe = GetSqe();
+
+            if ( pSqe == nullptr )
+            {
+                break;
+            }
+
+            pSqe->opcode = IORING_OP_SENDMSG;
+            pSqe->fd     = iSocket;
+            pSqe->addr   = reinterpret_cast<uint64_t> ( &pMsgHdrs[iFirst + iNumBatch].msg_hdr );
+            pSqe->len    = 1;
+
+            iNumBatch++;
+        }
+
+        // submit all requests and wait for their completions with one system
+        // call (UDP sends are usually completed inline)
+        Enter ( static_cast<unsigned int> ( iNumBatch ) );
+
+        if ( __atomic_load_n ( pSqHead, __ATOMIC_ACQUIRE ) != iSqTailLocal )
+        {
+            // the kernel did not accept the requests, the ring cannot be used
+            // anymore since the requests cannot be withdrawn
+            return false;
+        }
+
+        int iNumCompleted = 0;
+
+        while ( iNumCompleted < iNumBatch )
+        {
+            if ( PeekCqe() == nullptr )
+            {
+                const int iRet = Enter ( 1 );
+
+                if ( ( iRet < 0 ) && ( iRet != -EINTR ) )
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            // errors of single datagrams are ignored as it is done for sendto
+            CqAdvance();
+            iNumCompleted++;
+        }
+
+        iFirst += iNumBatch;
+    }
+
+    return true;
+}
@@ -0,0 +1,145 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2020
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <stdint.h>
+
+
+/* Classes ********************************************************************/
+// Minimal io_uring wrapper which talks directly to the kernel interface (no
+// liburing required). A ring must only be used by a single thread.
+class CIoUring
+{
+public:
+    CIoUring();
+    virtual ~CIoUring() { Close(); }
+
+    // returns false if io_uring is not supported by the kernel
+    bool Setup ( const unsigned int iNumSqEntries,
+                 const unsigned int iNumCqEntries );
+
+    void Close();
+
+protected:
+    // returns a cleared submission queue entry or nullptr if the queue is full
+    io_uring_sqe* GetSqe();
+
+    // submits all prepared entries and optionally waits for completions (a
+    // negative time out waits infinitely), returns a negative errno on error
+    int Enter ( const unsigned int iMinComplete,
+                const int          iTimeoutMs = -1 );
+
+    // returns the next completion or nullptr, the completion must be released
+    // with CqAdvance() when it is processed
+    io_uring_cqe* PeekCqe();
+    void          CqAdvance();
+
+    int            iRingFd;
+    unsigned int   iSqTailLocal; // tail including the not yet submitted entries
+
+    // mapped memory of the rings
+    void*          pSqRingMem;
+    size_t         iSqRingMemSize;
+    void*          pCqRingMem;
+    size_t         iCqRingMemSize;
+    io_uring_sqe*  pSqes;
+    size_t         iSqesMemSize;
+
+    // submission queue
+    unsigned int*  pSqHead;
+    unsigned int*  pSqTail;
+    unsigned int   iSqMask;
+    unsigned int   iSqEntries;
+
+    // completion queue
+    unsigned int*  pCqHead;
+    unsigned int*  pCqTail;
+    unsigned int   iCqMask;
+    io_uring_cqe*  pCqes;
+};
+
+
+// Receives the datagrams of a socket with a multishot recvmsg request. The
+// kernel writes the datagrams directly into buffers of a registered provided
+// buffer ring so that no request has to be submitted per datagram.
+class CIoUringReceiver : public CIoUring
+{
+public:
+    CIoUringReceiver();
+    virtual ~CIoUringReceiver();
+
+    // returns false if the kernel does not support the required features
+    // (provided buffer rings and multishot recvmsg, Linux 6.0)
+    bool Init ( const int iNewSocket,
+                const int iNewNumBuffers,
+                const int iNewBufferSize );
+
+    // Waits for received datagrams and returns the next one. The data pointer
+    // is valid until the next call. Returns false on time out or error.
+    bool GetNextPacket ( const uint8_t*& pData,
+                         int&            iNumBytes,
+                         sockaddr_in&    SenderAddr,
+                         const int       iTimeoutMs );
+
+protected:
+    void ArmReceive();
+    void ReturnBuffer ( const int iBufferID );
+
+    int                iSocket;
+    int                iNumBuffers;
+    int                iBufferSize;
+    bool               bReceiveArmed;
+    int                iCurBufferID; // buffer of the last returned datagram
+
+    msghdr             RecvMsgHdr;
+    uint8_t*           pBufferMem;
+    io_uring_buf*      pBufRing; // the ring tail overlays the reserved field of the first buffer
+    size_t             iBufRingMemSize;
+    uint16_t           iBufRingTail;
+};
+
+
+// Sends a batch of datagrams with one sendmsg request per datagram which are
+// all submitted with a single system call.
+class CIoUringSender : public CIoUring
+{
+public:
+    CIoUringSender() : iSocket ( -1 ) {}
+
+    bool Init ( const int          iNewSocket,
+                const unsigned int iNumEntries );
+
+    // Sends the messages and waits until the kernel has processed all of them
+    // so that the message buffers can be reused afterwards. Returns false if
+    // the messages could not be submitted.
+    bool SendMessages ( mmsghdr*  pMsgHdrs,
+                        const int iNumMsgs );
+
+protected:
+    int iSocket;
+};
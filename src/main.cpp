@@ -37,6 +37,7 @@
 #include "settings.h"
 #include "testbench.h"
 #include "util.h"
+#include "mixkernels.h"
 #ifdef ANDROID
 # include <QtAndroidExtras/QtAndroid>
 #endif
@@ -67,12 +68,16 @@ int main ( int argc, char** argv )
     bool         bShowComplRegConnList       = false;
     bool         bDisconnectAllClientsOnQuit = false;
     bool         bUseDoubleSystemFrameSize   = true; // default is 128 samples frame size
+    bool         bUseMultithreading          = false;
     bool         bShowAnalyzerConsole        = false;
     bool         bCentServPingServerInList   = false;
     bool         bNoAutoJackConnect          = false;
     bool         bUseTranslation             = true;
     bool         bCustomPortNumberGiven      = false;
     int          iNumServerChannels          = DEFAULT_USED_NUM_CHANNELS;
+    int          iNumRecvSockets             = 1;
+    bool         bUseIoUring                 = false;
+    int          iTickStatsInterval          = 0;
     int          iMaxDaysHistory             = DEFAULT_DAYS_HISTORY;
     int          iCtrlMIDIChannel            = INVALID_MIDI_CH;
     quint16      iPortNumber                 = DEFAULT_PORT_NUMBER;
@@ -88,6 +93,8 @@ int main ( int argc, char** argv )
     QString      strServerInfo               = "";
     QString      strWelcomeMessage           = "";
     QString      strClientName               = APP_NAME;
+    QString      strMetricsAddress           = "";
+    CServerThreadConfig ThreadConfig; // CPU cores and scheduling of the server threads
 
     // QT docu: argv()[0] is the program name, argv()[1] is the first
     // argument and argv()[argc()-1] is the last argument.
@@ -143,6 +150,18 @@ int main ( int argc, char** argv )
         }
 
 
+        // Use multithreading --------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "-T",
+                               "--multithreading" ) )
+        {
+            bUseMultithreading = true;
+            tsConsole << "- using multithreading" << endl;
+            continue;
+        }
+
+
         // Maximum number of channels ------------------------------------------
         if ( GetNumericArgument ( tsConsole,
                                   argc,
@@ -163,6 +182,201 @@ int main ( int argc, char** argv )
         }
 
 
+        // Number of receive sockets -------------------------------------------
+        if ( GetNumericArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--recvsockets", // no short form
+                                  "--recvsockets",
+                                  1,
+                                  MAX_NUM_RECV_SOCKETS,
+                                  rDbleArgument ) )
+        {
+#ifdef USE_SO_REUSEPORT
+            iNumRecvSockets = static_cast<int> ( rDbleArgument );
+
+            tsConsole << "- number of receive sockets: "
+                << iNumRecvSockets << endl;
+#else
+            tsConsole << "- multiple receive sockets are not supported on this platform" << endl;
+#endif
+            continue;
+        }
+
+
+        // Pin receive threads to CPU cores ------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--pinrecvthreads", // no short form
+                               "--pinrecvthreads" ) )
+        {
+            ThreadConfig.bPinRecvThreads = true;
+            tsConsole << "- pin receive threads to CPU cores" << endl;
+            continue;
+        }
+
+
+        // Use io_uring network engine -----------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--iouring", // no short form
+                               "--iouring" ) )
+        {
+#ifdef USE_IO_URING
+            bUseIoUring = true;
+            tsConsole << "- using io_uring network engine" << endl;
+#else
+            tsConsole << "- io_uring is not supported by this build" << endl;
+#endif
+            continue;
+        }
+
+
+        // Real-time priority of the server timer thread -----------------------
+        if ( GetNumericArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--mixerrtprio", // no short form
+                                  "--mixerrtprio",
+                                  1,
+                                  99,
+                                  rDbleArgument ) )
+        {
+            ThreadConfig.iMixerRTPriority = static_cast<int> ( rDbleArgument );
+
+            tsConsole << "- SCHED_FIFO priority of the server timer thread: "
+                << ThreadConfig.iMixerRTPriority << endl;
+            continue;
+        }
+
+
+        // Real-time priority of the server threads ----------------------------
+        if ( GetNumericArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--rtprio", // no short form
+                                  "--rtprio",
+                                  1,
+                                  99,
+                                  rDbleArgument ) )
+        {
+            ThreadConfig.iRTPriority = static_cast<int> ( rDbleArgument );
+
+            tsConsole << "- SCHED_FIFO priority of the server threads: "
+                << ThreadConfig.iRTPriority << endl;
+            continue;
+        }
+
+
+        // CPU core of the server timer thread ---------------------------------
+        if ( GetNumericArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--mixercore", // no short form
+                                  "--mixercore",
+                                  0,
+                                  MAX_NUM_CPU_CORES - 1,
+                                  rDbleArgument ) )
+        {
+            ThreadConfig.iMixerCPUCore = static_cast<int> ( rDbleArgument );
+
+            tsConsole << "- CPU core of the server timer thread: "
+                << ThreadConfig.iMixerCPUCore << endl;
+            continue;
+        }
+
+
+        // CPU cores of the receive threads ------------------------------------
+        if ( GetStringArgument ( tsConsole,
+                                 argc,
+                                 argv,
+                                 i,
+                                 "--recvcores", // no short form
+                                 "--recvcores",
+                                 strArgument ) )
+        {
+            if ( !CThreadUtil::ParseCPUCoreList ( strArgument, ThreadConfig.veciRecvCPUCores ) )
+            {
+                tsConsole << argv[0] << ": '--recvcores' needs a comma separated list of CPU cores" << endl;
+                exit ( 1 );
+            }
+
+            tsConsole << "- CPU cores of the receive threads: " << strArgument << endl;
+            continue;
+        }
+
+
+        // CPU cores of the worker threads -------------------------------------
+        if ( GetStringArgument ( tsConsole,
+                                 argc,
+                                 argv,
+                                 i,
+                                 "--workercores", // no short form
+                                 "--workercores",
+                                 strArgument ) )
+        {
+            if ( !CThreadUtil::ParseCPUCoreList ( strArgument, ThreadConfig.veciWorkerCPUCores ) )
+            {
+                tsConsole << argv[0] << ": '--workercores' needs a comma separated list of CPU cores" << endl;
+                exit ( 1 );
+            }
+
+            tsConsole << "- CPU cores of the worker threads: " << strArgument << endl;
+            continue;
+        }
+
+
+        // Tick timing statistics report ---------------------------------------
+        if ( GetNumericArgument ( tsConsole,
+                                  argc,
+                                  argv,
+                                  i,
+                                  "--tickstats", // no short form
+                                  "--tickstats",
+                                  1,
+                                  3600,
+                                  rDbleArgument ) )
+        {
+            iTickStatsInterval = static_cast<int> ( rDbleArgument );
+
+            tsConsole << "- server tick statistics report interval: "
+                << iTickStatsInterval << " s" << endl;
+            continue;
+        }
+
+
+        // Metrics listener ----------------------------------------------------
+        if ( GetStringArgument ( tsConsole,
+                                 argc,
+                                 argv,
+                                 i,
+                                 "--metrics", // no short form
+                                 "--metrics",
+                                 strArgument ) )
+        {
+            strMetricsAddress = strArgument;
+            tsConsole << "- metrics listener (local TCP port or Unix socket): "
+                << strMetricsAddress << endl;
+            continue;
+        }
+
+
+        // Lock the memory -----------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--mlockall", // no short form
+                               "--mlockall" ) )
+        {
+            ThreadConfig.bLockMemory = true;
+            tsConsole << "- lock the server memory" << endl;
+            continue;
+        }
+
+
         // Maximum days in history display -------------------------------------
         if ( GetNumericArgument ( tsConsole,
                                   argc,
@@ -272,6 +486,19 @@ int main ( int argc, char** argv )
         }
 
 
+        // Mixer benchmark -----------------------------------------------------
+        // Undocumented debugging command line argument: Measure the cost of
+        // the server audio mixing for all supported mixing kernels and exit.
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "--benchmarkmixer", // no short form
+                               "--benchmarkmixer" ) )
+        {
+            CMixKernels::Benchmark ( tsConsole );
+            exit ( 0 );
+        }
+
+
         // Controller MIDI channel ---------------------------------------------
         if ( GetNumericArgument ( tsConsole,
                                   argc,
@@ -649,6 +876,17 @@ int main ( int argc, char** argv )
         else
         {
             // Server:
+#ifndef HEADLESS
+            // the thread settings of the init-file must be known before the
+            // server object is created
+            CServerSettings Settings ( strIniFileName );
+
+            if ( bUseGUI )
+            {
+                Settings.LoadThreadConfig ( ThreadConfig );
+            }
+#endif
+
             // actual server object
             CServer Server ( iNumServerChannels,
                              iMaxDaysHistory,
@@ -664,13 +902,19 @@ int main ( int argc, char** argv )
                              bCentServPingServerInList,
                              bDisconnectAllClientsOnQuit,
                              bUseDoubleSystemFrameSize,
+                             bUseMultithreading,
+                             iNumRecvSockets,
+                             bUseIoUring,
+                             ThreadConfig,
+                             iTickStatsInterval,
+                             strMetricsAddress,
                              eLicenceType );
 
 #ifndef HEADLESS
             if ( bUseGUI )
             {
                 // load settings from init-file
-                CServerSettings Settings ( &Server, strIniFileName );
+                Settings.SetServer ( &Server );
                 Settings.Load();
 
                 // update server list AFTER restoring the settings from the
@@ -768,10 +1012,31 @@ QString UsageArguments ( char **argv )
         "  -R, --recording       enables recording and sets directory to contain\n"
         "                        recorded jams\n"
         "  -s, --server          start server\n"
+        "  -T, --multithreading  use multithreading to make better use of\n"
+        "                        multi-core CPUs\n"
         "  -u, --numchannels     maximum number of channels\n"
         "  -w, --welcomemessage  welcome message on connect\n"
         "  -y, --history         enable connection history and set file name\n"
         "  -z, --startminimized  start minimizied\n"
+        "  --iouring             use the io_uring network engine (Linux only)\n"
+        "  --metrics             serve metrics in the Prometheus text format, set\n"
+        "                        local TCP port or Unix socket path\n"
+        "  --mixercore           CPU core of the server timer thread which runs\n"
+        "                        the mixer (Linux only)\n"
+        "  --mixerrtprio         real-time (SCHED_FIFO) priority of the server\n"
+        "                        timer thread which runs the mixer (Linux only)\n"
+        "  --mlockall            lock the server memory (Linux only)\n"
+        "  --pinrecvthreads      pin the network receive threads to CPU cores\n"
+        "  --recvcores           comma separated CPU cores of the network\n"
+        "                        receive threads (Linux only)\n"
+        "  --recvsockets         number of network receive sockets/threads\n"
+        "                        sharing the server port (Linux only)\n"
+        "  --rtprio              real-time (SCHED_FIFO) priority of the server\n"
+        "                        threads (Linux only)\n"
+        "  --tickstats           show the timing statistics of the server\n"
+        "                        processing stages, set interval in seconds\n"
+        "  --workercores         comma separated CPU cores of the worker threads,\n"
+        "                        one worker per core (Linux only)\n"
         "\nClient only:\n"
         "  -c, --connect         connect to given server address on startup\n"
         "  -j, --nojackconnect   disable auto Jack connections\n"
@@ -0,0 +1,862 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2020
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include "mixkernels.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#if defined ( __i386__ ) || defined ( __x86_64__ ) || defined ( _M_IX86 ) || defined ( _M_X64 )
+# define MIX_KERNELS_X86
+# include <immintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+#  define MIX_KERNELS_TARGET_SSE2
+#  define MIX_KERNELS_TARGET_AVX2
+# else
+#  define MIX_KERNELS_TARGET_SSE2 __attribute__ ( ( target ( "sse2" ) ) )
+#  define MIX_KERNELS_TARGET_AVX2 __attribute__ ( ( target ( "avx2" ) ) )
+# endif
+#elif defined ( __ARM_NEON ) || defined ( __ARM_NEON__ )
+# define MIX_KERNELS_NEON
+# include <arm_neon.h>
+#endif
+
+
+/* Scalar implementation ******************************************************/
+static void AddGainScalar ( const float* pIn,
+                            float*       pAcc,
+                            const int    iNumValues,
+                            const float  fGainEven,
+                            const float  fGainOdd )
+{
+    int i = 0;
+
+    for ( ; i + 1 < iNumValues; i += 2 )
+    {
+        pAcc[i]     += pIn[i]     * fGainEven;
+        pAcc[i + 1] += pIn[i + 1] * fGainOdd;
+    }
+
+    if ( i < iNumValues )
+    {
+        pAcc[i] += pIn[i] * fGainEven;
+    }
+}
+
+static void AddStereoToMonoScalar ( const float* pIn,
+                                    float*       pAcc,
+                                    const int    iNumFrames,
+                                    const float  fGain )
+{
+    const float fHalfGain = fGain / 2;
+
+    for ( int i = 0, k = 0; i < iNumFrames; i++, k += 2 )
+    {
+        pAcc[i] += ( pIn[k] + pIn[k + 1] ) * fHalfGain;
+    }
+}
+
+static void AddMonoToStereoScalar ( const float* pIn,
+                                    float*       pAcc,
+                                    const int    iNumFrames,
+                                    const float  fGainL,
+                                    const float  fGainR )
+{
+    for ( int i = 0, k = 0; i < iNumFrames; i++, k += 2 )
+    {
+        pAcc[k]     += pIn[i] * fGainL;
+        pAcc[k + 1] += pIn[i] * fGainR;
+    }
+}
+
+static void ClipScalar ( const float* pAcc,
+                         float*       pOut,
+                         const int    iNumValues )
+{
+    for ( int i = 0; i < iNumValues; i++ )
+    {
+        pOut[i] = std::min ( std::max ( pAcc[i], -1.0f ), 1.0f );
+    }
+}
+
+static float GetPeakScalar ( const float* pIn,
+                            const int    iNumValues )
+{
+    float fPeak = 0.0f;
+
+    for ( int i = 0; i < iNumValues; i++ )
+    {
+        fPeak = std::max ( fPeak, std::fabs ( pIn[i] ) );
+    }
+
+    return fPeak;
+}
+
+static void ConvertToInt16Scalar ( const float* pIn,
+                                   int16_t*     pOut,
+                                   const int    iNumValues )
+{
+    for ( int i = 0; i < iNumValues; i++ )
+    {
+        // same behaviour as Double2Short() (truncation towards zero)
+        const float fValue = std::min ( std::max ( pIn[i] * 32768.0f, -32768.0f ), 32767.0f );
+
+        pOut[i] = static_cast<int16_t> ( fValue );
+    }
+}
+
+
+/* SSE2/AVX2 implementation ***************************************************/
+#ifdef MIX_KERNELS_X86
+MIX_KERNELS_TARGET_SSE2
+static void AddGainSse2 ( const float* pIn,
+                          float*       pAcc,
+                          const int    iNumValues,
+                          const float  fGainEven,
+                          const float  fGainOdd )
+{
+    const __m128 vGain = _mm_setr_ps ( fGainEven, fGainOdd, fGainEven, fGainOdd );
+    int          i     = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        _mm_storeu_ps ( &pAcc[i],     _mm_add_ps ( _mm_loadu_ps ( &pAcc[i] ),     _mm_mul_ps ( _mm_loadu_ps ( &pIn[i] ),     vGain ) ) );
+        _mm_storeu_ps ( &pAcc[i + 4], _mm_add_ps ( _mm_loadu_ps ( &pAcc[i + 4] ), _mm_mul_ps ( _mm_loadu_ps ( &pIn[i + 4] ), vGain ) ) );
+    }
+
+    AddGainScalar ( &pIn[i], &pAcc[i], iNumValues - i, fGainEven, fGainOdd );
+}
+
+MIX_KERNELS_TARGET_SSE2
+static void AddStereoToMonoSse2 ( const float* pIn,
+                                  float*       pAcc,
+                                  const int    iNumFrames,
+                                  const float  fGain )
+{
+    const __m128 vHalfGain = _mm_set1_ps ( fGain / 2 );
+    int          i         = 0;
+
+    for ( ; i + 4 <= iNumFrames; i += 4 )
+    {
+        // separate the left and right samples and add them
+        const __m128 vIn0 = _mm_loadu_ps ( &pIn[2 * i] );
+        const __m128 vIn1 = _mm_loadu_ps ( &pIn[2 * i + 4] );
+        const __m128 vSum = _mm_add_ps ( _mm_shuffle_ps ( vIn0, vIn1, _MM_SHUFFLE ( 2, 0, 2, 0 ) ),
+                                         _mm_shuffle_ps ( vIn0, vIn1, _MM_SHUFFLE ( 3, 1, 3, 1 ) ) );
+
+        _mm_storeu_ps ( &pAcc[i], _mm_add_ps ( _mm_loadu_ps ( &pAcc[i] ), _mm_mul_ps ( vSum, vHalfGain ) ) );
+    }
+
+    AddStereoToMonoScalar ( &pIn[2 * i], &pAcc[i], iNumFrames - i, fGain );
+}
+
+MIX_KERNELS_TARGET_SSE2
+static void AddMonoToStereoSse2 ( const float* pIn,
+                                  float*       pAcc,
+                                  const int    iNumFrames,
+                                  const float  fGainL,
+                                  const float  fGainR )
+{
+    const __m128 vGain = _mm_setr_ps ( fGainL, fGainR, fGainL, fGainR );
+    int          i     = 0;
+
+    for ( ; i + 4 <= iNumFrames; i += 4 )
+    {
+        // duplicate each mono sample for the left and right channel
+        const __m128 vIn     = _mm_loadu_ps ( &pIn[i] );
+        float*       pCurAcc = &pAcc[2 * i];
+
+        _mm_storeu_ps ( &pCurAcc[0], _mm_add_ps ( _mm_loadu_ps ( &pCurAcc[0] ), _mm_mul_ps ( _mm_unpacklo_ps ( vIn, vIn ), vGain ) ) );
+        _mm_storeu_ps ( &pCurAcc[4], _mm_add_ps ( _mm_loadu_ps ( &pCurAcc[4] ), _mm_mul_ps ( _mm_unpackhi_ps ( vIn, vIn ), vGain ) ) );
+    }
+
+    AddMonoToStereoScalar ( &pIn[i], &pAcc[2 * i], iNumFrames - i, fGainL, fGainR );
+}
+
+MIX_KERNELS_TARGET_SSE2
+static void ClipSse2 ( const float* pAcc,
+                       float*       pOut,
+                       const int    iNumValues )
+{
+    const __m128 vMin = _mm_set1_ps ( -1.0f );
+    const __m128 vMax = _mm_set1_ps ( 1.0f );
+    int          i    = 0;
+
+    for ( ; i + 4 <= iNumValues; i += 4 )
+    {
+        _mm_storeu_ps ( &pOut[i], _mm_min_ps ( _mm_max_ps ( _mm_loadu_ps ( &pAcc[i] ), vMin ), vMax ) );
+    }
+
+    ClipScalar ( &pAcc[i], &pOut[i], iNumValues - i );
+}
+
+MIX_KERNELS_TARGET_SSE2
+static float GetPeakSse2 ( const float* pIn,
+                           const int    iNumValues )
+{
+    const __m128 vAbsMask = _mm_castsi128_ps ( _mm_set1_epi32 ( 0x7FFFFFFF ) );
+    __m128       vPeak    = _mm_setzero_ps();
+    int          i        = 0;
+
+    for ( ; i + 4 <= iNumValues; i += 4 )
+    {
+        vPeak = _mm_max_ps ( vPeak, _mm_and_ps ( _mm_loadu_ps ( &pIn[i] ), vAbsMask ) );
+    }
+
+    // maximum of the four partial results
+    vPeak = _mm_max_ps ( vPeak, _mm_shuffle_ps ( vPeak, vPeak, _MM_SHUFFLE ( 1, 0, 3, 2 ) ) );
+    vPeak = _mm_max_ps ( vPeak, _mm_shuffle_ps ( vPeak, vPeak, _MM_SHUFFLE ( 2, 3, 0, 1 ) ) );
+
+    return std::max ( _mm_cvtss_f32 ( vPeak ), GetPeakScalar ( &pIn[i], iNumValues - i ) );
+}
+
+MIX_KERNELS_TARGET_SSE2
+static void ConvertToInt16Sse2 ( const float* pIn,
+                                 int16_t*     pOut,
+                                 const int    iNumValues )
+{
+    const __m128 vScale = _mm_set1_ps ( 32768.0f );
+    const __m128 vMin   = _mm_set1_ps ( -32768.0f );
+    const __m128 vMax   = _mm_set1_ps ( 32767.0f );
+    int          i      = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        const __m128i vLo = _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( _mm_mul_ps ( _mm_loadu_ps ( &pIn[i] ),     vScale ), vMin ), vMax ) );
+        const __m128i vHi = _mm_cvttps_epi32 ( _mm_min_ps ( _mm_max_ps ( _mm_mul_ps ( _mm_loadu_ps ( &pIn[i + 4] ), vScale ), vMin ), vMax ) );
+
+        _mm_storeu_si128 ( reinterpret_cast<__m128i*> ( &pOut[i] ), _mm_packs_epi32 ( vLo, vHi ) );
+    }
+
+    ConvertToInt16Scalar ( &pIn[i], &pOut[i], iNumValues - i );
+}
+
+MIX_KERNELS_TARGET_AVX2
+static void AddGainAvx2 ( const float* pIn,
+                          float*       pAcc,
+                          const int    iNumValues,
+                          const float  fGainEven,
+                          const float  fGainOdd )
+{
+    const __m256 vGain = _mm256_setr_ps ( fGainEven, fGainOdd, fGainEven, fGainOdd,
+                                          fGainEven, fGainOdd, fGainEven, fGainOdd );
+    int          i     = 0;
+
+    for ( ; i + 16 <= iNumValues; i += 16 )
+    {
+        _mm256_storeu_ps ( &pAcc[i],     _mm256_add_ps ( _mm256_loadu_ps ( &pAcc[i] ),     _mm256_mul_ps ( _mm256_loadu_ps ( &pIn[i] ),     vGain ) ) );
+        _mm256_storeu_ps ( &pAcc[i + 8], _mm256_add_ps ( _mm256_loadu_ps ( &pAcc[i + 8] ), _mm256_mul_ps ( _mm256_loadu_ps ( &pIn[i + 8] ), vGain ) ) );
+    }
+
+    // avoid the AVX/SSE transition penalty in the scalar code
+    _mm256_zeroupper();
+
+    AddGainScalar ( &pIn[i], &pAcc[i], iNumValues - i, fGainEven, fGainOdd );
+}
+
+MIX_KERNELS_TARGET_AVX2
+static void AddStereoToMonoAvx2 ( const float* pIn,
+                                  float*       pAcc,
+                                  const int    iNumFrames,
+                                  const float  fGain )
+{
+    const __m256 vHalfGain = _mm256_set1_ps ( fGain / 2 );
+    int          i         = 0;
+
+    for ( ; i + 8 <= iNumFrames; i += 8 )
+    {
+        // the horizontal add works per 128 bit lane, restore the sample order
+        const __m256 vSum = _mm256_hadd_ps ( _mm256_loadu_ps ( &pIn[2 * i] ), _mm256_loadu_ps ( &pIn[2 * i + 8] ) );
+        const __m256 vMon = _mm256_castpd_ps ( _mm256_permute4x64_pd ( _mm256_castps_pd ( vSum ), 0xD8 ) );
+
+        _mm256_storeu_ps ( &pAcc[i], _mm256_add_ps ( _mm256_loadu_ps ( &pAcc[i] ), _mm256_mul_ps ( vMon, vHalfGain ) ) );
+    }
+
+    // avoid the AVX/SSE transition penalty in the scalar code
+    _mm256_zeroupper();
+
+    AddStereoToMonoScalar ( &pIn[2 * i], &pAcc[i], iNumFrames - i, fGain );
+}
+
+MIX_KERNELS_TARGET_AVX2
+static void AddMonoToStereoAvx2 ( const float* pIn,
+                                  float*       pAcc,
+                                  const int    iNumFrames,
+                                  const float  fGainL,
+                                  const float  fGainR )
+{
+    const __m256 vGain = _mm256_setr_ps ( fGainL, fGainR, fGainL, fGainR,
+                                          fGainL, fGainR, fGainL, fGainR );
+    int          i     = 0;
+
+    for ( ; i + 8 <= iNumFrames; i += 8 )
+    {
+        // duplicate each mono sample for the left and right channel
+        const __m128 vIn0    = _mm_loadu_ps ( &pIn[i] );
+        const __m128 vIn1    = _mm_loadu_ps ( &pIn[i + 4] );
+        const __m256 vDup0   = _mm256_insertf128_ps ( _mm256_castps128_ps256 ( _mm_unpacklo_ps ( vIn0, vIn0 ) ), _mm_unpackhi_ps ( vIn0, vIn0 ), 1 );
+        const __m256 vDup1   = _mm256_insertf128_ps ( _mm256_castps128_ps256 ( _mm_unpacklo_ps ( vIn1, vIn1 ) ), _mm_unpackhi_ps ( vIn1, vIn1 ), 1 );
+        float*       pCurAcc = &pAcc[2 * i];
+
+        _mm256_storeu_ps ( &pCurAcc[0], _mm256_add_ps ( _mm256_loadu_ps ( &pCurAcc[0] ), _mm256_mul_ps ( vDup0, vGain ) ) );
+        _mm256_storeu_ps ( &pCurAcc[8], _mm256_add_ps ( _mm256_loadu_ps ( &pCurAcc[8] ), _mm256_mul_ps ( vDup1, vGain ) ) );
+    }
+
+    // avoid the AVX/SSE transition penalty in the scalar code
+    _mm256_zeroupper();
+
+    AddMonoToStereoScalar ( &pIn[i], &pAcc[2 * i], iNumFrames - i, fGainL, fGainR );
+}
+
+MIX_KERNELS_TARGET_AVX2
+static void ClipAvx2 ( const float* pAcc,
+                       float*       pOut,
+                       const int    iNumValues )
+{
+    const __m256 vMin = _mm256_set1_ps ( -1.0f );
+    const __m256 vMax = _mm256_set1_ps ( 1.0f );
+    int          i    = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        _mm256_storeu_ps ( &pOut[i], _mm256_min_ps ( _mm256_max_ps ( _mm256_loadu_ps ( &pAcc[i] ), vMin ), vMax ) );
+    }
+
+    // avoid the AVX/SSE transition penalty in the scalar code
+    _mm256_zeroupper();
+
+    ClipScalar ( &pAcc[i], &pOut[i], iNumValues - i );
+}
+
+MIX_KERNELS_TARGET_AVX2
+static float GetPeakAvx2 ( const float* pIn,
+                           const int    iNumValues )
+{
+    const __m256 vAbsMask = _mm256_castsi256_ps ( _mm256_set1_epi32 ( 0x7FFFFFFF ) );
+    __m256       vPeak    = _mm256_setzero_ps();
+    int          i        = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        vPeak = _mm256_max_ps ( vPeak, _mm256_and_ps ( _mm256_loadu_ps ( &pIn[i] ), vAbsMask ) );
+    }
+
+    // maximum of the eight partial results
+    __m128 vPeak128 = _mm_max_ps ( _mm256_castps256_ps128 ( vPeak ), _mm256_extractf128_ps ( vPeak, 1 ) );
+    vPeak128        = _mm_max_ps ( vPeak128, _mm_shuffle_ps ( vPeak128, vPeak128, _MM_SHUFFLE ( 1, 0, 3, 2 ) ) );
+    vPeak128        = _mm_max_ps ( vPeak128, _mm_shuffle_ps ( vPeak128, vPeak128, _MM_SHUFFLE ( 2, 3, 0, 1 ) ) );
+
+    const float fPeak = _mm_cvtss_f32 ( vPeak128 );
+
+    // avoid the AVX/SSE transition penalty in the scalar code
+    _mm256_zeroupper();
+
+    return std::max ( fPeak, GetPeakScalar ( &pIn[i], iNumValues - i ) );
+}
+
+MIX_KERNELS_TARGET_AVX2
+static void ConvertToInt16Avx2 ( const float* pIn,
+                                 int16_t*     pOut,
+                                 const int    iNumValues )
+{
+    const __m256 vScale = _mm256_set1_ps ( 32768.0f );
+    const __m256 vMin   = _mm256_set1_ps ( -32768.0f );
+    const __m256 vMax   = _mm256_set1_ps ( 32767.0f );
+    int          i      = 0;
+
+    for ( ; i + 16 <= iNumValues; i += 16 )
+    {
+        const __m256i vLo = _mm256_cvttps_epi32 ( _mm256_min_ps ( _mm256_max_ps ( _mm256_mul_ps ( _mm256_loadu_ps ( &pIn[i] ),     vScale ), vMin ), vMax ) );
+        const __m256i vHi = _mm256_cvttps_epi32 ( _mm256_min_ps ( _mm256_max_ps ( _mm256_mul_ps ( _mm256_loadu_ps ( &pIn[i + 8] ), vScale ), vMin ), vMax ) );
+
+        // the pack instruction works per 128 bit lane, restore the sample order
+        const __m256i vPacked = _mm256_permute4x64_epi64 ( _mm256_packs_epi32 ( vLo, vHi ), 0xD8 );
+
+        _mm256_storeu_si256 ( reinterpret_cast<__m256i*> ( &pOut[i] ), vPacked );
+    }
+
+    // avoid the AVX/SSE transition penalty in the scalar code
+    _mm256_zeroupper();
+
+    ConvertToInt16Scalar ( &pIn[i], &pOut[i], iNumValues - i );
+}
+
+static bool CpuSupportsAvx2()
+{
+# ifdef _MSC_VER
+    int iCPUInfo[4];
+
+    // check that the CPU supports AVX and that the OS saves the AVX registers
+    __cpuid ( iCPUInfo, 1 );
+
+    if ( ( ( iCPUInfo[2] & ( 1 << 27 ) ) == 0 ) || ( ( iCPUInfo[2] & ( 1 << 28 ) ) == 0 ) )
+    {
+        return false;
+    }
+
+    if ( ( _xgetbv ( 0 ) & 6 ) != 6 )
+    {
+        return false;
+    }
+
+    __cpuidex ( iCPUInfo, 7, 0 );
+
+    return ( iCPUInfo[1] & ( 1 << 5 ) ) != 0;
+# else
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports ( "avx2" );
+# endif
+}
+#endif
+
+
+/* NEON implementation ********************************************************/
+#ifdef MIX_KERNELS_NEON
+static void AddGainNeon ( const float* pIn,
+                          float*       pAcc,
+                          const int    iNumValues,
+                          const float  fGainEven,
+                          const float  fGainOdd )
+{
+    const float       fGain[4] = { fGainEven, fGainOdd, fGainEven, fGainOdd };
+    const float32x4_t vGain    = vld1q_f32 ( fGain );
+    int               i        = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        vst1q_f32 ( &pAcc[i],     vmlaq_f32 ( vld1q_f32 ( &pAcc[i] ),     vld1q_f32 ( &pIn[i] ),     vGain ) );
+        vst1q_f32 ( &pAcc[i + 4], vmlaq_f32 ( vld1q_f32 ( &pAcc[i + 4] ), vld1q_f32 ( &pIn[i + 4] ), vGain ) );
+    }
+
+    AddGainScalar ( &pIn[i], &pAcc[i], iNumValues - i, fGainEven, fGainOdd );
+}
+
+static void AddStereoToMonoNeon ( const float* pIn,
+                                  float*       pAcc,
+                                  const int    iNumFrames,
+                                  const float  fGain )
+{
+    const float32x4_t vHalfGain = vdupq_n_f32 ( fGain / 2 );
+    int               i         = 0;
+
+    for ( ; i + 4 <= iNumFrames; i += 4 )
+    {
+        // the interleaved load separates the left and right samples
+        const float32x4x2_t vIn = vld2q_f32 ( &pIn[2 * i] );
+
+        vst1q_f32 ( &pAcc[i], vmlaq_f32 ( vld1q_f32 ( &pAcc[i] ), vaddq_f32 ( vIn.val[0], vIn.val[1] ), vHalfGain ) );
+    }
+
+    AddStereoToMonoScalar ( &pIn[2 * i], &pAcc[i], iNumFrames - i, fGain );
+}
+
+static void AddMonoToStereoNeon ( const float* pIn,
+                                  float*       pAcc,
+                                  const int    iNumFrames,
+                                  const float  fGainL,
+                                  const float  fGainR )
+{
+    const float       fGain[4] = { fGainL, fGainR, fGainL, fGainR };
+    const float32x4_t vGain    = vld1q_f32 ( fGain );
+    int               i        = 0;
+
+    for ( ; i + 4 <= iNumFrames; i += 4 )
+    {
+        // duplicate each mono sample for the left and right channel
+        const float32x4_t   vIn     = vld1q_f32 ( &pIn[i] );
+        const float32x4x2_t vDup    = vzipq_f32 ( vIn, vIn );
+        float*              pCurAcc = &pAcc[2 * i];
+
+        vst1q_f32 ( &pCurAcc[0], vmlaq_f32 ( vld1q_f32 ( &pCurAcc[0] ), vDup.val[0], vGain ) );
+        vst1q_f32 ( &pCurAcc[4], vmlaq_f32 ( vld1q_f32 ( &pCurAcc[4] ), vDup.val[1], vGain ) );
+    }
+
+    AddMonoToStereoScalar ( &pIn[i], &pAcc[2 * i], iNumFrames - i, fGainL, fGainR );
+}
+
+static void ClipNeon ( const float* pAcc,
+                       float*       pOut,
+                       const int    iNumValues )
+{
+    const float32x4_t vMin = vdupq_n_f32 ( -1.0f );
+    const float32x4_t vMax = vdupq_n_f32 ( 1.0f );
+    int               i    = 0;
+
+    for ( ; i + 4 <= iNumValues; i += 4 )
+    {
+        vst1q_f32 ( &pOut[i], vminq_f32 ( vmaxq_f32 ( vld1q_f32 ( &pAcc[i] ), vMin ), vMax ) );
+    }
+
+    ClipScalar ( &pAcc[i], &pOut[i], iNumValues - i );
+}
+
+static float GetPeakNeon ( const float* pIn,
+                           const int    iNumValues )
+{
+    float32x4_t vPeak = vdupq_n_f32 ( 0.0f );
+    int         i     = 0;
+
+    for ( ; i + 4 <= iNumValues; i += 4 )
+    {
+        vPeak = vmaxq_f32 ( vPeak, vabsq_f32 ( vld1q_f32 ( &pIn[i] ) ) );
+    }
+
+    // maximum of the four partial results
+    float32x2_t vPeak64 = vpmax_f32 ( vget_low_f32 ( vPeak ), vget_high_f32 ( vPeak ) );
+    vPeak64             = vpmax_f32 ( vPeak64, vPeak64 );
+
+    return std::max ( vget_lane_f32 ( vPeak64, 0 ), GetPeakScalar ( &pIn[i], iNumValues - i ) );
+}
+
+static void ConvertToInt16Neon ( const float* pIn,
+                                 int16_t*     pOut,
+                                 const int    iNumValues )
+{
+    const float32x4_t vScale = vdupq_n_f32 ( 32768.0f );
+    int               i      = 0;
+
+    for ( ; i + 8 <= iNumValues; i += 8 )
+    {
+        // the float to integer conversion truncates towards zero and saturates,
+        // the narrowing saturates to 16 bit
+        const int32x4_t vLo = vcvtq_s32_f32 ( vmulq_f32 ( vld1q_f32 ( &pIn[i] ),     vScale ) );
+        const int32x4_t vHi = vcvtq_s32_f32 ( vmulq_f32 ( vld1q_f32 ( &pIn[i + 4] ), vScale ) );
+
+        vst1q_s16 ( &pOut[i], vcombine_s16 ( vqmovn_s32 ( vLo ), vqmovn_s32 ( vHi ) ) );
+    }
+
+    ConvertToInt16Scalar ( &pIn[i], &pOut[i], iNumValues - i );
+}
+#endif
+
+
+/* Implementation selection ***************************************************/
+void ( *CMixKernels::AddGain ) ( const float*, float*, const int, const float, const float ) = AddGainScalar;
+void ( *CMixKernels::AddStereoToMono ) ( const float*, float*, const int, const float )      = AddStereoToMonoScalar;
+void ( *CMixKernels::AddMonoToStereo ) ( const float*, float*, const int, const float, const float ) = AddMonoToStereoScalar;
+void ( *CMixKernels::Clip ) ( const float*, float*, const int )                              = ClipScalar;
+float ( *CMixKernels::GetPeak ) ( const float*, const int )                                   = GetPeakScalar;
+void ( *CMixKernels::ConvertToInt16 ) ( const float*, int16_t*, const int )                  = ConvertToInt16Scalar;
+
+CMixKernels::EImpl CMixKernels::eCurImpl = CMixKernels::MK_SCALAR;
+
+// select the best implementation on application startup
+static const bool bMixKernelsInitialized = ( CMixKernels::SetImpl ( CMixKernels::GetBestImpl() ), true );
+
+bool CMixKernels::IsSupported ( const EImpl eImpl )
+{
+    switch ( eImpl )
+    {
+    case MK_SCALAR:
+        return true;
+
+#ifdef MIX_KERNELS_X86
+    case MK_SSE2:
+        return true;
+
+    case MK_AVX2:
+        return CpuSupportsAvx2();
+#endif
+
+#ifdef MIX_KERNELS_NEON
+    case MK_NEON:
+        return true;
+#endif
+
+    default:
+        return false;
+    }
+}
+
+CMixKernels::EImpl CMixKernels::GetBestImpl()
+{
+    if ( IsSupported ( MK_AVX2 ) )
+    {
+        return MK_AVX2;
+    }
+
+    if ( IsSupported ( MK_SSE2 ) )
+    {
+        return MK_SSE2;
+    }
+
+    if ( IsSupported ( MK_NEON ) )
+    {
+        return MK_NEON;
+    }
+
+    return MK_SCALAR;
+}
+
+void CMixKernels::SetImpl ( const EImpl eNewImpl )
+{
+    // use the scalar implementation as fall back
+    AddGain         = AddGainScalar;
+    AddStereoToMono = AddStereoToMonoScalar;
+    AddMonoToStereo = AddMonoToStereoScalar;
+    Clip            = ClipScalar;
+    GetPeak         = GetPeakScalar;
+    ConvertToInt16  = ConvertToInt16Scalar;
+    eCurImpl        = MK_SCALAR;
+
+    if ( !IsSupported ( eNewImpl ) )
+    {
+        return;
+    }
+
+    switch ( eNewImpl )
+    {
+#ifdef MIX_KERNELS_X86
+    case MK_SSE2:
+        AddGain         = AddGainSse2;
+        AddStereoToMono = AddStereoToMonoSse2;
+        AddMonoToStereo = AddMonoToStereoSse2;
+        Clip            = ClipSse2;
+        GetPeak         = GetPeakSse2;
+        ConvertToInt16  = ConvertToInt16Sse2;
+        break;
+
+    case MK_AVX2:
+        AddGain         = AddGainAvx2;
+        AddStereoToMono = AddStereoToMonoAvx2;
+        AddMonoToStereo = AddMonoToStereoAvx2;
+        Clip            = ClipAvx2;
+        GetPeak         = GetPeakAvx2;
+        ConvertToInt16  = ConvertToInt16Avx2;
+        break;
+#endif
+
+#ifdef MIX_KERNELS_NEON
+    case MK_NEON:
+        AddGain         = AddGainNeon;
+        AddStereoToMono = AddStereoToMonoNeon;
+        AddMonoToStereo = AddMonoToStereoNeon;
+        Clip            = ClipNeon;
+        GetPeak         = GetPeakNeon;
+        ConvertToInt16  = ConvertToInt16Neon;
+        break;
+#endif
+
+    default:
+        break;
+    }
+
+    eCurImpl = eNewImpl;
+}
+
+const char* CMixKernels::GetImplName ( const EImpl eImpl )
+{
+    switch ( eImpl )
+    {
+    case MK_SSE2: return "SSE2";
+    case MK_AVX2: return "AVX2";
+    case MK_NEON: return "NEON";
+    default:      return "scalar";
+    }
+}
+
+
+/* Benchmark ******************************************************************/
+// previous mixing implementation: 16 bit samples mixed in double precision with
+// saturation on each add
+static void MixLegacyDouble ( const std::vector<std::vector<int16_t> >& vecvecsData,
+                              const std::vector<int>&                   vecNumAudioChannels,
+                              std::vector<int16_t>&                     vecsOutData,
+                              const int                                 iFrameSize,
+                              const int                                 iCurNumAudChan )
+{
+    const double dGain = 0.7;
+
+    std::fill ( vecsOutData.begin(), vecsOutData.end(), 0 );
+
+    for ( size_t j = 0; j < vecvecsData.size(); j++ )
+    {
+        const std::vector<int16_t>& vecsData = vecvecsData[j];
+
+        if ( iCurNumAudChan == 1 )
+        {
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                for ( int i = 0; i < iFrameSize; i++ )
+                {
+                    vecsOutData[i] = static_cast<int16_t> ( std::min ( std::max (
+                        vecsOutData[i] + vecsData[i] * dGain, -32768.0 ), 32767.0 ) );
+                }
+            }
+            else
+            {
+                for ( int i = 0, k = 0; i < iFrameSize; i++, k += 2 )
+                {
+                    vecsOutData[i] = static_cast<int16_t> ( std::min ( std::max (
+                        vecsOutData[i] + dGain * ( static_cast<double> ( vecsData[k] ) + vecsData[k + 1] ) / 2, -32768.0 ), 32767.0 ) );
+                }
+            }
+        }
+        else
+        {
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                for ( int i = 0, k = 0; i < iFrameSize; i++, k += 2 )
+                {
+                    vecsOutData[k]     = static_cast<int16_t> ( std::min ( std::max ( vecsOutData[k]     + vecsData[i] * dGain, -32768.0 ), 32767.0 ) );
+                    vecsOutData[k + 1] = static_cast<int16_t> ( std::min ( std::max ( vecsOutData[k + 1] + vecsData[i] * dGain, -32768.0 ), 32767.0 ) );
+                }
+            }
+            else
+            {
+                for ( int i = 0; i < ( 2 * iFrameSize ); i++ )
+                {
+                    vecsOutData[i] = static_cast<int16_t> ( std::min ( std::max ( vecsOutData[i] + vecsData[i] * dGain, -32768.0 ), 32767.0 ) );
+                }
+            }
+        }
+    }
+}
+
+// mixing of float samples with the kernels of the currently selected implementation
+static void MixKernels ( const std::vector<std::vector<float> >& vecvecfData,
+                         const std::vector<int>&                 vecNumAudioChannels,
+                         std::vector<float>&                     vecfAcc,
+                         std::vector<float>&                     vecfOutData,
+                         const int                               iFrameSize,
+                         const int                               iCurNumAudChan )
+{
+    const float fGain = 0.7f;
+
+    std::fill ( vecfAcc.begin(), vecfAcc.end(), 0.0f );
+
+    for ( size_t j = 0; j < vecvecfData.size(); j++ )
+    {
+        if ( iCurNumAudChan == 1 )
+        {
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                CMixKernels::AddGain ( vecvecfData[j].data(), vecfAcc.data(), iFrameSize, fGain, fGain );
+            }
+            else
+            {
+                CMixKernels::AddStereoToMono ( vecvecfData[j].data(), vecfAcc.data(), iFrameSize, fGain );
+            }
+        }
+        else
+        {
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                CMixKernels::AddMonoToStereo ( vecvecfData[j].data(), vecfAcc.data(), iFrameSize, fGain, fGain );
+            }
+            else
+            {
+                CMixKernels::AddGain ( vecvecfData[j].data(), vecfAcc.data(), 2 * iFrameSize, fGain, fGain );
+            }
+        }
+    }
+
+    CMixKernels::Clip ( vecfAcc.data(), vecfOutData.data(), iFrameSize * iCurNumAudChan );
+}
+
+void CMixKernels::Benchmark ( QTextStream& tsConsole )
+{
+    const int   iNumClients    = 50;   // worst case number of sources of one mix
+    const int   iNumIterations = 2000; // number of mixed frames per measurement
+    const EImpl eOldImpl       = eCurImpl;
+
+    // use a mix of mono and stereo clients with random audio data
+    std::vector<std::vector<int16_t> > vecvecsData ( iNumClients );
+    std::vector<std::vector<float> >   vecvecfData ( iNumClients );
+    std::vector<int>                   vecNumAudioChannels ( iNumClients );
+    std::vector<float>                 vecfAcc ( 2 * 128 );
+    std::vector<float>                 vecfOutData ( 2 * 128 );
+    std::vector<int16_t>               vecsOutData ( 2 * 128 );
+    volatile double                    dDummy = 0;
+
+    for ( int j = 0; j < iNumClients; j++ )
+    {
+        vecNumAudioChannels[j] = ( j % 2 ) + 1;
+        vecvecsData[j].resize ( 2 * 128 );
+        vecvecfData[j].resize ( 2 * 128 );
+
+        for ( size_t i = 0; i < vecvecsData[j].size(); i++ )
+        {
+            vecvecsData[j][i] = static_cast<int16_t> ( ( rand() % 65536 ) - 32768 );
+            vecvecfData[j][i] = vecvecsData[j][i] / 32768.0f;
+        }
+    }
+
+    tsConsole << "Mixing benchmark: cost of one mix of " << iNumClients <<
+        " clients in ns per frame" << endl;
+
+    for ( int iFrameSize = 64; iFrameSize <= 128; iFrameSize *= 2 )
+    {
+        for ( int iCurNumAudChan = 1; iCurNumAudChan <= 2; iCurNumAudChan++ )
+        {
+            QElapsedTimer Timer;
+
+            tsConsole << "  " << iFrameSize << " samples, " <<
+                ( iCurNumAudChan == 1 ? "mono" : "stereo" ) << " output:" << endl;
+
+            // previous scalar double implementation as reference
+            Timer.start();
+
+            for ( int k = 0; k < iNumIterations; k++ )
+            {
+                MixLegacyDouble ( vecvecsData, vecNumAudioChannels, vecsOutData, iFrameSize, iCurNumAudChan );
+                dDummy += vecsOutData[0];
+            }
+
+            const double dRefNs = static_cast<double> ( Timer.nsecsElapsed() ) / iNumIterations;
+
+            tsConsole << "    previous (double): " << dRefNs << " ns" << endl;
+
+            // all supported kernel implementations
+            for ( int iImpl = MK_SCALAR; iImpl <= MK_NEON; iImpl++ )
+            {
+                if ( !IsSupported ( static_cast<EImpl> ( iImpl ) ) )
+                {
+                    continue;
+                }
+
+                SetImpl ( static_cast<EImpl> ( iImpl ) );
+
+                Timer.start();
+
+                for ( int k = 0; k < iNumIterations; k++ )
+                {
+                    MixKernels ( vecvecfData, vecNumAudioChannels, vecfAcc, vecfOutData, iFrameSize, iCurNumAudChan );
+                    dDummy += vecfOutData[0];
+                }
+
+                const double dNs = static_cast<double> ( Timer.nsecsElapsed() ) / iNumIterations;
+
+                tsConsole << "    " << GetImplName ( static_cast<EImpl> ( iImpl ) ) << ": " <<
+                    dNs << " ns (speedup " << dRefNs / dNs << ")" << endl;
+            }
+        }
+    }
+
+    SetImpl ( eOldImpl );
+}
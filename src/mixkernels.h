@@ -0,0 +1,95 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2020
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <QTextStream>
+#include <stdint.h>
+
+
+/* Classes ********************************************************************/
+// Vectorized audio mixing kernels used by the server mixer. The audio samples
+// are float values in the range [-1, 1] (as delivered by the Opus float API)
+// which are accumulated in a float buffer without any intermediate clipping.
+// The implementation which fits best to the CPU is selected at runtime.
+class CMixKernels
+{
+public:
+    enum EImpl
+    {
+        MK_SCALAR = 0,
+        MK_SSE2   = 1,
+        MK_AVX2   = 2,
+        MK_NEON   = 3
+    };
+
+    static bool        IsSupported ( const EImpl eImpl );
+    static EImpl       GetBestImpl();
+    static EImpl       GetImpl() { return eCurImpl; }
+    static void        SetImpl ( const EImpl eNewImpl );
+    static const char* GetImplName ( const EImpl eImpl );
+
+    // pAcc[k] += pIn[k] * fGain, where the gain for even and odd indices are
+    // given separately (mono: both gains are equal, stereo: left/right gain)
+    static void ( *AddGain ) ( const float* pIn,
+                               float*       pAcc,
+                               const int    iNumValues,
+                               const float  fGainEven,
+                               const float  fGainOdd );
+
+    // pAcc[i] += ( pIn[2 * i] + pIn[2 * i + 1] ) * fGain / 2
+    static void ( *AddStereoToMono ) ( const float* pIn,
+                                       float*       pAcc,
+                                       const int    iNumFrames,
+                                       const float  fGain );
+
+    // pAcc[2 * i] += pIn[i] * fGainL, pAcc[2 * i + 1] += pIn[i] * fGainR
+    static void ( *AddMonoToStereo ) ( const float* pIn,
+                                       float*       pAcc,
+                                       const int    iNumFrames,
+                                       const float  fGainL,
+                                       const float  fGainR );
+
+    // final limiter of the mix: clips the accumulated values to [-1, 1]
+    static void ( *Clip ) ( const float* pAcc,
+                            float*       pOut,
+                            const int    iNumValues );
+
+    // returns the maximum absolute value of the samples
+    static float ( *GetPeak ) ( const float* pIn,
+                                const int    iNumValues );
+
+    // converts float samples to 16 bit with saturation (only needed for the
+    // jam recorder)
+    static void ( *ConvertToInt16 ) ( const float* pIn,
+                                      int16_t*     pOut,
+                                      const int    iNumValues );
+
+    // measures the cost of mixing one frame with all supported implementations
+    // compared to the previous scalar double precision 16 bit mixing
+    static void Benchmark ( QTextStream& tsConsole );
+
+protected:
+    static EImpl eCurImpl;
+};
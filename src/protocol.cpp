@@ -29,6 +29,13 @@ Protocol message definition
 - All messages received need to be acknowledged by an acknowledge packet (except
   of connection less messages)
 
+- A message is resent if its acknowledgement is not received within the time
+  out which is adapted to the measured round trip time. If both sides support
+  it (see PROTMESSID_PROTOCOL_FEATURES), up to PROT_SEND_WINDOW_SIZE messages
+  are sent without waiting for their acknowledgements. The receiver evaluates
+  the messages in the order of their counters, otherwise each message is only
+  sent after the previous one was acknowledged.
+
 
 
 MAIN FRAME
@@ -120,6 +127,31 @@ MESSAGES (with connection)
         ...  2 bytes number n | n bytes UTF-8 string city |
         ... ------------------+---------------------------+
 
+    note: the message is limited to the size of the network receive buffer,
+          if the peer supports PROT_FEATURE_CLIENT_LIST_DELTA, a large list is
+          split in a list message with the first clients and
+          PROTMESSID_CONN_CLIENTS_LIST_DELTA messages with the others
+
+
+- PROTMESSID_CONN_CLIENTS_LIST_DELTA: Changes of the connected clients list
+
+    +---------------------+------------------+------------------+ ...
+    | 1 byte list version | 1 byte change #1 | data change #1   | ...
+    +---------------------+------------------+------------------+ ...
+
+    the change type is:
+    - 0: the channel has left, the data is the 1 byte channel ID
+    - 1: the channel is new or its infos have changed, the data is the list
+         entry of the PROTMESSID_CONN_CLIENTS_LIST message
+
+    note: this message is only sent if the peer has announced the feature
+          PROT_FEATURE_CLIENT_LIST_DELTA, it contains the changes since the
+          previous list message, the list version is set to zero by each
+          PROTMESSID_CONN_CLIENTS_LIST message and incremented by each
+          PROTMESSID_CONN_CLIENTS_LIST_DELTA message, if the version does not
+          match, the receiver requests the full list with
+          PROTMESSID_REQ_CONN_CLIENTS_LIST
+
 
 - PROTMESSID_REQ_CONN_CLIENTS_LIST: Request connected clients list
 
@@ -227,6 +259,19 @@ MESSAGES (with connection)
     - tbc
 
 
+- PROTMESSID_PROTOCOL_FEATURES: supported features of the protocol
+
+    +----------------------+
+    | 4 bytes feature bits |
+    +----------------------+
+
+    - bit 0: multiple messages in flight (PROT_FEATURE_SEND_WINDOW)
+    - bit 1: PROTMESSID_CONN_CLIENTS_LIST_DELTA (PROT_FEATURE_CLIENT_LIST_DELTA)
+
+    note: this message is sent as the first message after a reset of the
+          protocol, the receiver restarts its receive window on this message
+
+
 CONNECTION LESS MESSAGES
 ------------------------
 
@@ -396,10 +441,17 @@ CONNECTION LESS MESSAGES
 
 
 /* Implementation *************************************************************/
-CProtocol::CProtocol()
+CProtocol::CProtocol() :
+    veciRecIDs         ( 256, PROTMESSID_ILLEGAL ),
+    veciRecBufIDs      ( 256, PROTMESSID_ILLEGAL ),
+    vecvecbyRecBufMess ( 256 )
 {
     Reset();
 
+    // the time out timer is started for the oldest message in flight
+    SendMessClock.start();
+    TimerSendMess.setSingleShot ( true );
+
 
     // Connections -------------------------------------------------------------
     QObject::connect ( &TimerSendMess, &QTimer::timeout,
@@ -411,70 +463,175 @@ void CProtocol::Reset()
     QMutexLocker locker ( &Mutex );
 
     // prepare internal variables for initial protocol transfer
-    iCounter   = 0;
-    iOldRecID  = PROTMESSID_ILLEGAL;
-    iOldRecCnt = 0;
+    iCounter               = 0;
+    bFeaturesSent          = false;
+    bPeerSupportsWindow    = false;
+    bPeerSupportsListDelta = false;
+
+    // the next connected clients list is sent completely
+    bSentChanListValid   = false;
+    iSentChanListVersion = 0;
+    vecSentChanList.Init ( 0 );
+    bRecChanListValid     = false;
+    bRecChanListRequested = false;
+    iRecChanListVersion   = 0;
+    vecRecChanList.Init ( 0 );
+
+    // reset the adaptive time out
+    bRoundTripTimeValid      = false;
+    dSmoothedRoundTripTimeMs = 0;
+    dRoundTripTimeVarMs      = 0;
+    iSendTimeoutMs           = SEND_MESS_TIMEOUT_MS;
+
+    // the receive window is synchronized with the next received message
+    bRecWindowSynced = false;
+    iRecExpectedCnt  = 0;
+    veciRecIDs.Reset    ( PROTMESSID_ILLEGAL );
+    veciRecBufIDs.Reset ( PROTMESSID_ILLEGAL );
 
     // delete complete "send message queue"
     SendMessQueue.clear();
 }
 
-void CProtocol::EnqueueMessage ( CVector<uint8_t>& vecMessage,
-                                 const int         iCnt,
-                                 const int         iID )
+void CProtocol::EnqueueMessage ( const int               iID,
+                                 const CVector<uint8_t>& vecData )
 {
-    bool bListWasEmpty;
+    CVector<uint8_t> vecNewMessage;
+
+    // build complete message with the current counter value (the counter is
+    // increased in the same lock as the message is enqueued so that the
+    // counters in the queue are always consecutive)
+    GenMessageFrame ( vecNewMessage, iCounter, iID, vecData );
+
+    // we want to have a FIFO: we add at the end and take from the beginning
+    SendMessQueue.push_back ( CSendMessage ( vecNewMessage, iCounter, iID ) );
+
+    // increase counter (wraps around automatically)
+    iCounter++;
+}
+
+void CProtocol::EnqueuePreparedMessage ( const CPreparedMessage& PrepMess )
+{
+    CVector<uint8_t> vecNewMessage;
+
+    // only the counter and the CRC of the prepared frame are changed
+    PrepMess.GetFrame ( vecNewMessage, iCounter );
+
+    SendMessQueue.push_back ( CSendMessage ( vecNewMessage, iCounter, PrepMess.GetID() ) );
+
+    // increase counter (wraps around automatically)
+    iCounter++;
+}
+
+void CProtocol::SendMessage()
+{
+    CVector<CVector<uint8_t> > vecvecMessages;
 
     Mutex.lock();
     {
-        // check if list is empty so that we have to initiate a send process
-        bListWasEmpty = SendMessQueue.empty();
-
-        // create send message object for the queue
-        CSendMessage SendMessageObj ( vecMessage, iCnt, iID );
+        // Send all messages in the window which are not yet in flight. The
+        // window starts at the oldest unacknowledged message. If the peer does
+        // not support multiple messages in flight, we wait for the
+        // acknowledgement of each message before the next one is sent. This is
+        // also done for our features message since the peer synchronizes its
+        // receive window on it.
+        const bool bUseWindow = bPeerSupportsWindow &&
+            ( SendMessQueue.empty() || ( SendMessQueue.front().iID != PROTMESSID_PROTOCOL_FEATURES ) );
+
+        const qint64 iCurTimeMs  = SendMessClock.elapsed();
+        const int    iWindowSize = bUseWindow ? PROT_SEND_WINDOW_SIZE : 1;
+        int          iWindowPos  = 0;
+
+        for ( std::list<CSendMessage>::iterator it = SendMessQueue.begin();
+              ( it != SendMessQueue.end() ) && ( iWindowPos < iWindowSize ); ++it, iWindowPos++ )
+        {
+            if ( !it->bSent )
+            {
+                it->bSent       = true;
+                it->iSendTimeMs = iCurTimeMs;
 
-        // we want to have a FIFO: we add at the end and take from the beginning
-        SendMessQueue.push_back ( SendMessageObj );
+                vecvecMessages.Add ( it->vecMessage );
+            }
+        }
     }
     Mutex.unlock();
 
-    // if list was empty, initiate send process
-    if ( bListWasEmpty )
+    // send messages
+    for ( int i = 0; i < vecvecMessages.Size(); i++ )
     {
-        SendMessage();
+        emit MessReadyForSending ( vecvecMessages[i] );
     }
+
+    StartSendMessTimer();
 }
 
-void CProtocol::SendMessage()
+void CProtocol::ResendTimedOutMessages()
 {
-    CVector<uint8_t> vecMessage;
-    bool             bSendMess = false;
+    CVector<CVector<uint8_t> > vecvecMessages;
 
     Mutex.lock();
     {
-        // we have to check that list is not empty, since in another thread the
-        // last element of the list might have been erased
-        if ( !SendMessQueue.empty() )
+        const qint64 iCurTimeMs = SendMessClock.elapsed();
+
+        for ( std::list<CSendMessage>::iterator it = SendMessQueue.begin();
+              ( it != SendMessQueue.end() ) && it->bSent; ++it )
         {
-            vecMessage.Init ( SendMessQueue.front().vecMessage.Size() );
-            vecMessage = SendMessQueue.front().vecMessage;
+            if ( !it->bAcked && ( iCurTimeMs - it->iSendTimeMs >= iSendTimeoutMs ) )
+            {
+                it->bRetransmitted = true;
+                it->iSendTimeMs    = iCurTimeMs;
 
-            bSendMess = true;
+                vecvecMessages.Add ( it->vecMessage );
+            }
+        }
+
+        // exponential back off until a new round trip time is measured
+        if ( vecvecMessages.Size() > 0 )
+        {
+            iSendTimeoutMs = std::min ( 2 * iSendTimeoutMs, SEND_MESS_MAX_TIMEOUT_MS );
         }
     }
     Mutex.unlock();
 
-    if ( bSendMess )
+    // resend messages
+    for ( int i = 0; i < vecvecMessages.Size(); i++ )
+    {
+        emit MessReadyForSending ( vecvecMessages[i] );
+    }
+
+    StartSendMessTimer();
+}
+
+void CProtocol::StartSendMessTimer()
+{
+    qint64 iTimerDelayMs = -1; // no message in flight
+
+    Mutex.lock();
     {
-        // send message
-        emit MessReadyForSending ( vecMessage );
+        // the timer expires when the oldest message in flight times out
+        const qint64 iCurTimeMs = SendMessClock.elapsed();
 
-        // start time-out timer if not active
-        if ( !TimerSendMess.isActive() )
+        for ( std::list<CSendMessage>::const_iterator it = SendMessQueue.begin();
+              ( it != SendMessQueue.end() ) && it->bSent; ++it )
         {
-            TimerSendMess.start ( SEND_MESS_TIMEOUT_MS );
+            if ( !it->bAcked )
+            {
+                const qint64 iCurDelayMs =
+                    std::max ( it->iSendTimeMs + iSendTimeoutMs - iCurTimeMs, static_cast<qint64> ( 0 ) );
+
+                if ( ( iTimerDelayMs < 0 ) || ( iCurDelayMs < iTimerDelayMs ) )
+                {
+                    iTimerDelayMs = iCurDelayMs;
+                }
+            }
         }
     }
+    Mutex.unlock();
+
+    if ( iTimerDelayMs >= 0 )
+    {
+        TimerSendMess.start ( static_cast<int> ( iTimerDelayMs ) );
+    }
     else
     {
         // no message to send, stop timer
@@ -482,27 +639,118 @@ void CProtocol::SendMessage()
     }
 }
 
-void CProtocol::CreateAndSendMessage ( const int               iID,
-                                       const CVector<uint8_t>& vecData )
+void CProtocol::UpdateSendTimeout ( const qint64 iRoundTripTimeMs )
 {
-    CVector<uint8_t> vecNewMessage;
-    int              iCurCounter;
+/*
+    must be called with the mutex locked
+*/
+    // smoothed round trip time and its variation according to RFC 6298
+    const double dRoundTripTimeMs = static_cast<double> ( iRoundTripTimeMs );
+
+    if ( !bRoundTripTimeValid )
+    {
+        dSmoothedRoundTripTimeMs = dRoundTripTimeMs;
+        dRoundTripTimeVarMs      = dRoundTripTimeMs / 2;
+        bRoundTripTimeValid      = true;
+    }
+    else
+    {
+        dRoundTripTimeVarMs      = 0.75 * dRoundTripTimeVarMs + 0.25 * fabs ( dSmoothedRoundTripTimeMs - dRoundTripTimeMs );
+        dSmoothedRoundTripTimeMs = 0.875 * dSmoothedRoundTripTimeMs + 0.125 * dRoundTripTimeMs;
+    }
+
+    iSendTimeoutMs = std::min ( std::max ( static_cast<int> ( dSmoothedRoundTripTimeMs + 4 * dRoundTripTimeVarMs ),
+                                           SEND_MESS_MIN_TIMEOUT_MS ),
+                                SEND_MESS_MAX_TIMEOUT_MS );
+}
+
+void CProtocol::ProcessAcknMess ( const int iRecCounter,
+                                  const int iAcknID )
+{
+    bool bSendNextMess = false;
 
     Mutex.lock();
     {
-        // store current counter value
-        iCurCounter = iCounter;
+        // find the acknowledged message in flight (acknowledgements may arrive
+        // in any order)
+        for ( std::list<CSendMessage>::iterator it = SendMessQueue.begin();
+              ( it != SendMessQueue.end() ) && it->bSent; ++it )
+        {
+            if ( !it->bAcked && ( it->iCnt == iRecCounter ) && ( it->iID == iAcknID ) )
+            {
+                it->bAcked = true;
+
+                // only use the round trip time of messages which were not
+                // resent since we do not know which transmission was
+                // acknowledged
+                if ( !it->bRetransmitted )
+                {
+                    UpdateSendTimeout ( SendMessClock.elapsed() - it->iSendTimeMs );
+                }
 
-        // increase counter (wraps around automatically)
-        iCounter++;
+                break;
+            }
+        }
+
+        // remove all acknowledged messages at the front of the queue, this
+        // moves the window forward
+        while ( !SendMessQueue.empty() && SendMessQueue.front().bAcked )
+        {
+            SendMessQueue.pop_front();
+            bSendNextMess = true;
+        }
     }
     Mutex.unlock();
 
-    // build complete message
-    GenMessageFrame ( vecNewMessage, iCurCounter, iID, vecData );
+    // send next messages in queue
+    if ( bSendNextMess )
+    {
+        SendMessage();
+    }
+}
 
-    // enqueue message
-    EnqueueMessage ( vecNewMessage, iCurCounter, iID );
+void CProtocol::EnqueueFeaturesMessage()
+{
+    // the supported protocol features are announced with the first message
+    // after a reset
+    if ( !bFeaturesSent )
+    {
+        CVector<uint8_t> vecFeaturesData ( 4 );
+        int              iPos = 0; // init position pointer
+
+        PutValOnStream ( vecFeaturesData, iPos, static_cast<uint32_t> ( PROT_FEATURES_SUPPORTED ), 4 );
+
+        EnqueueMessage ( PROTMESSID_PROTOCOL_FEATURES, vecFeaturesData );
+
+        bFeaturesSent = true;
+    }
+}
+
+void CProtocol::CreateAndSendMessage ( const int               iID,
+                                       const CVector<uint8_t>& vecData )
+{
+    Mutex.lock();
+    {
+        EnqueueFeaturesMessage();
+        EnqueueMessage ( iID, vecData );
+    }
+    Mutex.unlock();
+
+    // send the message if the window allows it
+    SendMessage();
+}
+
+void CProtocol::SendPreparedMessage ( const CPreparedMessage& PrepMess )
+{
+    Mutex.lock();
+    {
+        EnqueueFeaturesMessage();
+        EnqueuePreparedMessage ( PrepMess );
+    }
+    Mutex.unlock();
+
+    // send the message if the window allows it
+    SendMessage();
 }
 
 void CProtocol::CreateAndImmSendAcknMess ( const int& iID,
@@ -536,6 +784,19 @@ void CProtocol::CreateAndImmSendConLessMessage ( const int               iID,
     emit CLMessReadyForSending ( InetAddr, vecNewMessage );
 }
 
+void CProtocol::SendPreparedConLessMessage ( const CPreparedMessage& PrepMess,
+                                             const CHostAddress&     InetAddr )
+{
+    CVector<uint8_t> vecNewMessage;
+
+    // counter per definition=0 for connection less messages, i.e., the
+    // prepared frame is sent unchanged
+    PrepMess.GetFrame ( vecNewMessage, 0 );
+
+    // immediately send message
+    emit CLMessReadyForSending ( InetAddr, vecNewMessage );
+}
+
 bool CProtocol::ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData,
                                    const int               iRecCounter,
                                    const int               iRecID )
@@ -544,148 +805,204 @@ bool CProtocol::ParseMessageBody ( const CVector<uint8_t>& vecbyMesBodyData,
     return code: false -> ok; true -> error
 */
     bool bRet = false;
-    bool bSendNextMess;
+    bool bBufferOutOfOrder;
 
 /*
 // TEST channel implementation: randomly delete protocol messages (50 % loss)
 if ( rand() < ( RAND_MAX / 2 ) ) return false;
 */
 
-    // In case we received a message and returned an answer but our answer
-    // did not make it to the receiver, he will resend his message. We check
-    // here if the message is the same as the old one, and if this is the
-    // case, just resend our old answer again
-    if ( ( iOldRecID == iRecID ) && ( iOldRecCnt == iRecCounter ) )
+    // special treatment for acknowledge messages (acknowledgments are not
+    // acknowledged and a duplicate acknowledgement does not harm)
+    if ( iRecID == PROTMESSID_ACKN )
     {
-        // acknowledgments are not acknowledged
-        if ( iRecID != PROTMESSID_ACKN )
+        // check size
+        if ( vecbyMesBodyData.Size() != 2 )
         {
-            // resend acknowledgement
-            CreateAndImmSendAcknMess ( iRecID, iRecCounter );
+            return true; // return error code
         }
+
+        // extract data from stream
+        int       iPos = 0;
+        const int iData =
+            static_cast<int> ( GetValFromStream ( vecbyMesBodyData, iPos, 2 ) );
+
+        ProcessAcknMess ( iRecCounter, iData );
+
+        return false;
     }
-    else
+
+    // In case we received a message and returned an answer but our answer
+    // did not make it to the receiver, he will resend his message. Therefore
+    // each received message is acknowledged, also if we already have it.
+    CreateAndImmSendAcknMess ( iRecID, iRecCounter );
+
+    Mutex.lock();
     {
-        // special treatment for acknowledge messages
-        if ( iRecID == PROTMESSID_ACKN )
-        {
-            // check size
-            if ( vecbyMesBodyData.Size() != 2 )
-            {
-                return true; // return error code
-            }
+        // messages which arrive out of order are only expected if the peer
+        // sends multiple messages in flight
+        bBufferOutOfOrder = bPeerSupportsWindow;
+    }
+    Mutex.unlock();
 
-            // extract data from stream and emit signal for received value
-            int       iPos = 0;
-            const int iData =
-                static_cast<int> ( GetValFromStream ( vecbyMesBodyData, iPos, 2 ) );
+    // position of the counter relative to the expected counter (-128..127)
+    int iCntDiff = ( ( iRecCounter - iRecExpectedCnt + 128 ) & 0xFF ) - 128;
 
-            Mutex.lock();
-            {
-                // check if this is the correct acknowledgment
-                bSendNextMess = false;
-                if ( !SendMessQueue.empty() )
-                {
-                    if ( ( SendMessQueue.front().iCnt == iRecCounter ) &&
-                         ( SendMessQueue.front().iID == iData ) )
-                    {
-                        // message acknowledged, remove from queue
-                        SendMessQueue.pop_front();
-
-                        // send next message in queue
-                        bSendNextMess = true;
-                    }
-                }
-            }
-            Mutex.unlock();
+    // check if the message is the same as an already received one (not done
+    // for the features message, see below)
+    if ( bRecWindowSynced &&
+         ( iRecID != PROTMESSID_PROTOCOL_FEATURES ) &&
+         ( ( ( iCntDiff < 0 ) && ( veciRecIDs[iRecCounter] == iRecID ) ) ||
+           ( ( iCntDiff > 0 ) && ( veciRecBufIDs[iRecCounter] == iRecID ) ) ) )
+    {
+        return false;
+    }
 
-            if ( bSendNextMess )
-            {
-                SendMessage();
-            }
-        }
-        else
-        {
-            // check which type of message we received and do action
-            switch ( iRecID )
-            {
-            case PROTMESSID_JITT_BUF_SIZE:
-                bRet = EvaluateJitBufMes ( vecbyMesBodyData );
-                break;
+    // The features message is the first message after a reset of the peer
+    // protocol and therefore restarts the receive window. It must not be
+    // taken for a resent message of the previous session (e.g. a client which
+    // reconnects after its disconnect message was lost starts with the same
+    // counter and message IDs), a really resent features message is simply
+    // evaluated again. A message outside of the window (e.g. the peer was
+    // reset without us noticing it) also restarts the window so that it is
+    // not lost.
+    if ( !bRecWindowSynced ||
+         ( iRecID == PROTMESSID_PROTOCOL_FEATURES ) ||
+         ( iCntDiff < 0 ) ||
+         ( iCntDiff >= PROT_SEND_WINDOW_SIZE ) ||
+         ( ( iCntDiff > 0 ) && !bBufferOutOfOrder ) )
+    {
+        veciRecIDs.Reset    ( PROTMESSID_ILLEGAL );
+        veciRecBufIDs.Reset ( PROTMESSID_ILLEGAL );
 
-            case PROTMESSID_REQ_JITT_BUF_SIZE:
-                bRet = EvaluateReqJitBufMes();
-                break;
+        bRecWindowSynced = true;
+        iRecExpectedCnt  = iRecCounter;
+        iCntDiff         = 0;
+    }
 
-            case PROTMESSID_CLIENT_ID:
-                bRet = EvaluateClientIDMes ( vecbyMesBodyData );
-                break;
+    if ( iCntDiff > 0 )
+    {
+        // a previous message is missing, keep this message until the missing
+        // message is resent
+        veciRecBufIDs[iRecCounter]      = iRecID;
+        vecvecbyRecBufMess[iRecCounter] = vecbyMesBodyData;
 
-            case PROTMESSID_CHANNEL_GAIN:
-                bRet = EvaluateChanGainMes ( vecbyMesBodyData );
-                break;
+        return false;
+    }
 
-            case PROTMESSID_CHANNEL_PAN:
-                bRet = EvaluateChanPanMes ( vecbyMesBodyData );
-                break;
+    // evaluate the message and the buffered messages which directly follow it
+    int iCurID = iRecID;
 
-            case PROTMESSID_MUTE_STATE_CHANGED:
-                bRet = EvaluateMuteStateHasChangedMes ( vecbyMesBodyData );
-                break;
+    const CVector<uint8_t>* pvecbyCurMesBodyData = &vecbyMesBodyData;
 
-            case PROTMESSID_CONN_CLIENTS_LIST:
-                bRet = EvaluateConClientListMes ( vecbyMesBodyData );
-                break;
+    while ( iCurID != PROTMESSID_ILLEGAL )
+    {
+        // store the ID of the message to find out if it is resent and move the
+        // window forward (the counter which leaves the range behind the
+        // expected counter is now ahead of it)
+        veciRecIDs[iRecExpectedCnt]    = iCurID;
+        veciRecBufIDs[iRecExpectedCnt] = PROTMESSID_ILLEGAL;
+        iRecExpectedCnt                = ( iRecExpectedCnt + 1 ) & 0xFF;
 
-            case PROTMESSID_REQ_CONN_CLIENTS_LIST:
-                bRet = EvaluateReqConnClientsList();
-                break;
+        veciRecIDs[( iRecExpectedCnt + 127 ) & 0xFF] = PROTMESSID_ILLEGAL;
 
-            case PROTMESSID_CHANNEL_INFOS:
-                bRet = EvaluateChanInfoMes ( vecbyMesBodyData );
-                break;
+        bRet |= EvaluateMessage ( *pvecbyCurMesBodyData, iCurID );
 
-            case PROTMESSID_REQ_CHANNEL_INFOS:
-                bRet = EvaluateReqChanInfoMes();
-                break;
+        // next buffered message (a reset of the protocol during the evaluation
+        // clears the buffer)
+        iCurID               = veciRecBufIDs[iRecExpectedCnt];
+        pvecbyCurMesBodyData = &vecvecbyRecBufMess[iRecExpectedCnt];
+    }
 
-            case PROTMESSID_CHAT_TEXT:
-                bRet = EvaluateChatTextMes ( vecbyMesBodyData );
-                break;
+    return bRet;
+}
 
-            case PROTMESSID_NETW_TRANSPORT_PROPS:
-                bRet = EvaluateNetwTranspPropsMes ( vecbyMesBodyData );
-                break;
+bool CProtocol::EvaluateMessage ( const CVector<uint8_t>& vecbyMesBodyData,
+                                  const int               iRecID )
+{
+/*
+    return code: false -> ok; true -> error
+*/
+    bool bRet = false;
 
-            case PROTMESSID_REQ_NETW_TRANSPORT_PROPS:
-                bRet = EvaluateReqNetwTranspPropsMes();
-                break;
+    // check which type of message we received and do action
+    switch ( iRecID )
+    {
+    case PROTMESSID_JITT_BUF_SIZE:
+        bRet = EvaluateJitBufMes ( vecbyMesBodyData );
+        break;
 
-            case PROTMESSID_LICENCE_REQUIRED:
-                bRet = EvaluateLicenceRequiredMes ( vecbyMesBodyData );
-                break;
+    case PROTMESSID_REQ_JITT_BUF_SIZE:
+        bRet = EvaluateReqJitBufMes();
+        break;
 
-            case PROTMESSID_REQ_CHANNEL_LEVEL_LIST:
-                bRet = EvaluateReqChannelLevelListMes ( vecbyMesBodyData );
-                break;
+    case PROTMESSID_CLIENT_ID:
+        bRet = EvaluateClientIDMes ( vecbyMesBodyData );
+        break;
 
-            case PROTMESSID_VERSION_AND_OS:
-                bRet = EvaluateVersionAndOSMes ( vecbyMesBodyData );
-                break;
+    case PROTMESSID_CHANNEL_GAIN:
+        bRet = EvaluateChanGainMes ( vecbyMesBodyData );
+        break;
 
-            case PROTMESSID_RECORDER_STATE:
-                bRet = EvaluateRecorderStateMes ( vecbyMesBodyData );
-                break;
-            }
+    case PROTMESSID_CHANNEL_PAN:
+        bRet = EvaluateChanPanMes ( vecbyMesBodyData );
+        break;
 
-            // immediately send acknowledge message
-            CreateAndImmSendAcknMess ( iRecID, iRecCounter );
+    case PROTMESSID_MUTE_STATE_CHANGED:
+        bRet = EvaluateMuteStateHasChangedMes ( vecbyMesBodyData );
+        break;
 
-            // save current message ID and counter to find out if message
-            // was resent
-            iOldRecID  = iRecID;
-            iOldRecCnt = iRecCounter;
-        }
+    case PROTMESSID_CONN_CLIENTS_LIST:
+        bRet = EvaluateConClientListMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_CONN_CLIENTS_LIST_DELTA:
+        bRet = EvaluateConClientListDeltaMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_REQ_CONN_CLIENTS_LIST:
+        bRet = EvaluateReqConnClientsList();
+        break;
+
+    case PROTMESSID_CHANNEL_INFOS:
+        bRet = EvaluateChanInfoMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_REQ_CHANNEL_INFOS:
+        bRet = EvaluateReqChanInfoMes();
+        break;
+
+    case PROTMESSID_CHAT_TEXT:
+        bRet = EvaluateChatTextMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_NETW_TRANSPORT_PROPS:
+        bRet = EvaluateNetwTranspPropsMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_REQ_NETW_TRANSPORT_PROPS:
+        bRet = EvaluateReqNetwTranspPropsMes();
+        break;
+
+    case PROTMESSID_LICENCE_REQUIRED:
+        bRet = EvaluateLicenceRequiredMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_REQ_CHANNEL_LEVEL_LIST:
+        bRet = EvaluateReqChannelLevelListMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_VERSION_AND_OS:
+        bRet = EvaluateVersionAndOSMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_RECORDER_STATE:
+        bRet = EvaluateRecorderStateMes ( vecbyMesBodyData );
+        break;
+
+    case PROTMESSID_PROTOCOL_FEATURES:
+        bRet = EvaluateProtocolFeaturesMes ( vecbyMesBodyData );
+        break;
     }
 
     return bRet;
@@ -988,57 +1305,238 @@ bool CProtocol::EvaluateMuteStateHasChangedMes ( const CVector<uint8_t> &vecData
 
 void CProtocol::CreateConClientListMes ( const CVector<CChannelInfo>& vecChanInfo )
 {
-    const int iNumClients = vecChanInfo.Size();
+    CPreparedMessage FullListMess;
 
-    // build data vector
-    CVector<uint8_t> vecData ( 0 );
-    int              iPos = 0; // init position pointer
+    PrepareConClientListMes ( FullListMess, vecChanInfo );
+
+    CreateConClientListMes ( vecChanInfo, FullListMess );
+}
+
+void CProtocol::CreateConClientListMes ( const CVector<CChannelInfo>& vecChanInfo,
+                                         const CPreparedMessage&      FullListMess )
+{
+    // if the peer knows the previous list, only the changes are sent
+    CVector<CVector<uint8_t> > vecvecDeltaData ( 0 );
+    CVector<uint8_t>           vecFirstPartData ( 0 );
+    bool                       bSendFullList      = false;
+    bool                       bSendFirstPartList = false;
+
+    Mutex.lock();
+    {
+        if ( !bPeerSupportsListDelta )
+        {
+            // the complete list (limited to the receive buffer size)
+            bSendFullList = true;
+        }
+        else
+        {
+            if ( bSentChanListValid )
+            {
+                CreateConClientListDeltaData ( vecChanInfo, vecSentChanList, vecvecDeltaData );
+
+                // use the complete list if it is smaller than the changes and
+                // fits in one part
+                int iDeltaSize = 0;
+
+                for ( int i = 0; i < vecvecDeltaData.Size(); i++ )
+                {
+                    iDeltaSize += vecvecDeltaData[i].Size();
+                }
+
+                if ( ( vecvecDeltaData.Size() > 0 ) &&
+                     ( iDeltaSize >= FullListMess.GetDataSize() ) &&
+                     ( FullListMess.GetDataSize() <= MAX_SIZE_BYTES_CONN_CLIENTS_LIST_PART ) )
+                {
+                    vecvecDeltaData.Init ( 0 );
+                    bSendFullList = true;
+                }
+            }
+            else if ( FullListMess.GetDataSize() <= MAX_SIZE_BYTES_CONN_CLIENTS_LIST_PART )
+            {
+                bSendFullList = true;
+            }
+            else
+            {
+                // the list is too large for one datagram, the complete list
+                // message contains the first clients and the others follow as
+                // changes
+                const int iNumListed =
+                    GenConClientListMesData ( vecFirstPartData,
+                                              vecChanInfo,
+                                              MAX_SIZE_BYTES_CONN_CLIENTS_LIST_PART );
+
+                CVector<CChannelInfo> vecListedChanInfo ( iNumListed );
+
+                for ( int i = 0; i < iNumListed; i++ )
+                {
+                    vecListedChanInfo[i] = vecChanInfo[i];
+                }
+
+                CreateConClientListDeltaData ( vecChanInfo, vecListedChanInfo, vecvecDeltaData );
+
+                bSendFirstPartList = true;
+            }
+        }
+
+        // the complete list resets the list version, each change message
+        // increments it (the place is reserved at the beginning)
+        if ( bSendFullList || bSendFirstPartList )
+        {
+            iSentChanListVersion = 0;
+        }
+
+        for ( int i = 0; i < vecvecDeltaData.Size(); i++ )
+        {
+            int iVersionPos = 0;
+            iSentChanListVersion++;
+            PutValOnStream ( vecvecDeltaData[i], iVersionPos,
+                static_cast<uint32_t> ( iSentChanListVersion ), 1 );
+        }
+
+        bSentChanListValid = true;
+        vecSentChanList    = vecChanInfo;
+    }
+    Mutex.unlock();
+
+    if ( bSendFullList )
+    {
+        SendPreparedMessage ( FullListMess );
+    }
+    else if ( bSendFirstPartList )
+    {
+        CreateAndSendMessage ( PROTMESSID_CONN_CLIENTS_LIST, vecFirstPartData );
+    }
+
+    for ( int i = 0; i < vecvecDeltaData.Size(); i++ )
+    {
+        CreateAndSendMessage ( PROTMESSID_CONN_CLIENTS_LIST_DELTA, vecvecDeltaData[i] );
+    }
+}
+
+void CProtocol::PrepareConClientListMes ( CPreparedMessage&            PrepMess,
+                                          const CVector<CChannelInfo>& vecChanInfo )
+{
+    CVector<uint8_t> vecData;
+
+    GenConClientListMesData ( vecData, vecChanInfo, MAX_SIZE_BYTES_CONN_CLIENTS_LIST );
+
+    PrepMess.Init ( PROTMESSID_CONN_CLIENTS_LIST, vecData );
+}
+
+int CProtocol::GenConClientListMesData ( CVector<uint8_t>&            vecData,
+                                         const CVector<CChannelInfo>& vecChanInfo,
+                                         const int                    iMaxNumBytes )
+{
+    const int        iNumClients = vecChanInfo.Size();
+    CVector<uint8_t> vecEntry;
+
+    // build data vector, the clients which do not fit anymore are left out
+    vecData.Init ( 0 );
 
     for ( int i = 0; i < iNumClients; i++ )
     {
-        // convert strings to utf-8
-        const QByteArray strUTF8Name = vecChanInfo[i].strName.toUtf8();
-        const QByteArray strUTF8City = vecChanInfo[i].strCity.toUtf8();
+        int iPos = 0; // init position pointer
 
-        // size of current list entry
-        const int iCurListEntrLen =
-            1 /* chan ID */ + 2 /* country */ +
-            4 /* instrument */ + 1 /* skill level */ +
-            4 /* IP address */ +
-            2 /* utf-8 str. size */ + strUTF8Name.size() +
-            2 /* utf-8 str. size */ + strUTF8City.size();
+        vecEntry.Init ( 0 );
+        PutChannelInfoOnStream ( vecEntry, iPos, vecChanInfo[i] );
 
-        // make space for new data
-        vecData.Enlarge ( iCurListEntrLen );
+        if ( vecData.Size() + vecEntry.Size() > iMaxNumBytes )
+        {
+            return i;
+        }
 
-        // channel ID (1 byte)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].iChanID ), 1 );
+        vecData.insert ( vecData.end(), vecEntry.begin(), vecEntry.end() );
+    }
 
-        // country (2 bytes)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].eCountry ), 2 );
+    return iNumClients;
+}
 
-        // instrument (4 bytes)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].iInstrument ), 4 );
+void CProtocol::AddConClientListDeltaEntry ( CVector<CVector<uint8_t> >& vecvecData,
+                                             const CVector<uint8_t>&     vecEntry )
+{
+    // start a new message if the entry does not fit in the current one, the
+    // list version (1 byte) at the beginning is set later
+    if ( ( vecvecData.Size() == 0 ) ||
+         ( vecvecData[vecvecData.Size() - 1].Size() + vecEntry.Size() > MAX_SIZE_BYTES_CONN_CLIENTS_LIST_PART ) )
+    {
+        vecvecData.Add ( CVector<uint8_t> ( 1 ) );
+    }
 
-        // skill level (1 byte)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].eSkillLevel ), 1 );
+    CVector<uint8_t>& vecCurData = vecvecData[vecvecData.Size() - 1];
 
-        // IP address (4 bytes)
-        PutValOnStream ( vecData, iPos,
-            static_cast<uint32_t> ( vecChanInfo[i].iIpAddr ), 4 );
+    vecCurData.insert ( vecCurData.end(), vecEntry.begin(), vecEntry.end() );
+}
 
-        // name
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
+void CProtocol::CreateConClientListDeltaData ( const CVector<CChannelInfo>& vecChanInfo,
+                                               const CVector<CChannelInfo>& vecOldChanInfo,
+                                               CVector<CVector<uint8_t> >&  vecvecData )
+{
+    const int        iNumOldClients = vecOldChanInfo.Size();
+    const int        iNumNewClients = vecChanInfo.Size();
+    CVector<uint8_t> vecEntry;
 
-        // city
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
+    // no message at all if nothing has changed
+    vecvecData.Init ( 0 );
+
+    // channels which have left
+    for ( int i = 0; i < iNumOldClients; i++ )
+    {
+        bool bFound = false;
+
+        for ( int j = 0; j < iNumNewClients; j++ )
+        {
+            if ( vecChanInfo[j].iChanID == vecOldChanInfo[i].iChanID )
+            {
+                bFound = true;
+                break;
+            }
+        }
+
+        if ( !bFound )
+        {
+            int iPos = 0; // init position pointer
+
+            vecEntry.Init ( 2 );
+
+            PutValOnStream ( vecEntry, iPos,
+                static_cast<uint32_t> ( PROT_CLIENT_LIST_DELTA_REMOVE ), 1 );
+
+            PutValOnStream ( vecEntry, iPos,
+                static_cast<uint32_t> ( vecOldChanInfo[i].iChanID ), 1 );
+
+            AddConClientListDeltaEntry ( vecvecData, vecEntry );
+        }
     }
 
-    CreateAndSendMessage ( PROTMESSID_CONN_CLIENTS_LIST, vecData );
+    // new channels and channels with changed infos
+    for ( int j = 0; j < iNumNewClients; j++ )
+    {
+        bool bChanged = true;
+
+        for ( int i = 0; i < iNumOldClients; i++ )
+        {
+            if ( vecOldChanInfo[i].iChanID == vecChanInfo[j].iChanID )
+            {
+                bChanged = ( vecOldChanInfo[i] != vecChanInfo[j] ) ||
+                           ( vecOldChanInfo[i].iIpAddr != vecChanInfo[j].iIpAddr );
+                break;
+            }
+        }
+
+        if ( bChanged )
+        {
+            int iPos = 0; // init position pointer
+
+            vecEntry.Init ( 1 );
+
+            PutValOnStream ( vecEntry, iPos,
+                static_cast<uint32_t> ( PROT_CLIENT_LIST_DELTA_UPDATE ), 1 );
+
+            PutChannelInfoOnStream ( vecEntry, iPos, vecChanInfo[j] );
+
+            AddConClientListDeltaEntry ( vecvecData, vecEntry );
+        }
+    }
 }
 
 bool CProtocol::EvaluateConClientListMes ( const CVector<uint8_t>& vecData )
@@ -1049,67 +1547,134 @@ bool CProtocol::EvaluateConClientListMes ( const CVector<uint8_t>& vecData )
 
     while ( iPos < iDataLen )
     {
-        // check size (the next 12 bytes)
-        if ( ( iDataLen - iPos ) < 12 )
+        CChannelInfo CurChanInfo;
+
+        if ( GetChannelInfoFromStream ( vecData, iPos, CurChanInfo ) )
         {
             return true; // return error code
         }
 
-        // channel ID (1 byte)
-        const int iChanID =
-            static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+        // add channel information to vector
+        vecChanInfo.Add ( CurChanInfo );
+    }
+
+    // check size: all data is read, the position must now be at the end
+    if ( iPos != iDataLen )
+    {
+        return true; // return error code
+    }
+
+    // the changes which follow are based on this list
+    bRecChanListValid     = true;
+    bRecChanListRequested = false;
+    iRecChanListVersion   = 0;
+    vecRecChanList        = vecChanInfo;
+
+    // invoke message action
+    emit ConClientListMesReceived ( vecChanInfo );
+
+    return false; // no error
+}
+
+bool CProtocol::EvaluateConClientListDeltaMes ( const CVector<uint8_t>& vecData )
+{
+    int       iPos     = 0; // init position pointer
+    const int iDataLen = vecData.Size();
+
+    // check size
+    if ( iDataLen < 1 )
+    {
+        return true; // return error code
+    }
+
+    // list version (1 byte)
+    const uint8_t iVersion =
+        static_cast<uint8_t> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    // if a list message was missed, e.g. because our protocol was reset, the
+    // changes cannot be applied and the complete list is requested instead
+    if ( !bRecChanListValid ||
+         ( iVersion != static_cast<uint8_t> ( iRecChanListVersion + 1 ) ) )
+    {
+        bRecChanListValid = false;
+
+        // the changes which arrive until the complete list is received are
+        // ignored, request the list only once
+        if ( !bRecChanListRequested )
+        {
+            bRecChanListRequested = true;
+            CreateReqConnClientsList();
+        }
+
+        return false; // no error
+    }
+
+    CVector<CChannelInfo> vecChanInfo ( vecRecChanList );
+
+    while ( iPos < iDataLen )
+    {
+        // change type (1 byte)
+        const int iChangeType =
+            static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+        if ( iChangeType == PROT_CLIENT_LIST_DELTA_REMOVE )
+        {
+            // check size
+            if ( ( iDataLen - iPos ) < 1 )
+            {
+                return true; // return error code
+            }
+
+            // channel ID (1 byte)
+            const int iChanID =
+                static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
 
-        // country (2 bytes)
-        const QLocale::Country eCountry =
-            static_cast<QLocale::Country> ( GetValFromStream ( vecData, iPos, 2 ) );
+            for ( int i = 0; i < vecChanInfo.Size(); i++ )
+            {
+                if ( vecChanInfo[i].iChanID == iChanID )
+                {
+                    vecChanInfo.erase ( vecChanInfo.begin() + i );
+                    break;
+                }
+            }
+        }
+        else if ( iChangeType == PROT_CLIENT_LIST_DELTA_UPDATE )
+        {
+            CChannelInfo CurChanInfo;
 
-        // instrument (4 bytes)
-        const int iInstrument =
-            static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+            if ( GetChannelInfoFromStream ( vecData, iPos, CurChanInfo ) )
+            {
+                return true; // return error code
+            }
 
-        // skill level (1 byte)
-        const ESkillLevel eSkillLevel =
-            static_cast<ESkillLevel> ( GetValFromStream ( vecData, iPos, 1 ) );
+            // replace the existing entry or insert the new entry so that the
+            // list stays sorted by the channel ID like the complete list
+            int i = 0;
 
-        // IP address (4 bytes)
-        const int iIpAddr =
-            static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+            while ( ( i < vecChanInfo.Size() ) &&
+                    ( vecChanInfo[i].iChanID < CurChanInfo.iChanID ) )
+            {
+                i++;
+            }
 
-        // name
-        QString strCurName;
-        if ( GetStringFromStream ( vecData,
-                                   iPos,
-                                   MAX_LEN_FADER_TAG,
-                                   strCurName ) )
-        {
-            return true; // return error code
+            if ( ( i < vecChanInfo.Size() ) &&
+                 ( vecChanInfo[i].iChanID == CurChanInfo.iChanID ) )
+            {
+                vecChanInfo[i] = CurChanInfo;
+            }
+            else
+            {
+                vecChanInfo.insert ( vecChanInfo.begin() + i, CurChanInfo );
+            }
         }
-
-        // city
-        QString strCurCity;
-        if ( GetStringFromStream ( vecData,
-                                   iPos,
-                                   MAX_LEN_SERVER_CITY,
-                                   strCurCity ) )
+        else
         {
             return true; // return error code
         }
-
-        // add channel information to vector
-        vecChanInfo.Add ( CChannelInfo ( iChanID,
-                                         iIpAddr,
-                                         strCurName,
-                                         eCountry,
-                                         strCurCity,
-                                         iInstrument,
-                                         eSkillLevel ) );
     }
 
-    // check size: all data is read, the position must now be at the end
-    if ( iPos != iDataLen )
-    {
-        return true; // return error code
-    }
+    iRecChanListVersion = iVersion;
+    vecRecChanList      = vecChanInfo;
 
     // invoke message action
     emit ConClientListMesReceived ( vecChanInfo );
@@ -1124,6 +1689,13 @@ void CProtocol::CreateReqConnClientsList()
 
 bool CProtocol::EvaluateReqConnClientsList()
 {
+    // the peer does not know our last list anymore, send the complete list
+    Mutex.lock();
+    {
+        bSentChanListValid = false;
+    }
+    Mutex.unlock();
+
     // invoke message action
     emit ReqConnClientsList();
 
@@ -1231,6 +1803,26 @@ bool CProtocol::EvaluateReqChanInfoMes()
 }
 
 void CProtocol::CreateChatTextMes ( const QString strChatText )
+{
+    CVector<uint8_t> vecData;
+
+    GenChatTextMesData ( vecData, strChatText );
+
+    CreateAndSendMessage ( PROTMESSID_CHAT_TEXT, vecData );
+}
+
+void CProtocol::PrepareChatTextMes ( CPreparedMessage& PrepMess,
+                                     const QString&    strChatText )
+{
+    CVector<uint8_t> vecData;
+
+    GenChatTextMesData ( vecData, strChatText );
+
+    PrepMess.Init ( PROTMESSID_CHAT_TEXT, vecData );
+}
+
+void CProtocol::GenChatTextMesData ( CVector<uint8_t>& vecData,
+                                     const QString&    strChatText )
 {
     int iPos = 0; // init position pointer
 
@@ -1243,12 +1835,10 @@ void CProtocol::CreateChatTextMes ( const QString strChatText )
     const int iEntrLen = 2 /* utf-8 string size */ + iStrUTF8Len;
 
     // build data vector
-    CVector<uint8_t> vecData ( iEntrLen );
+    vecData.Init ( iEntrLen );
 
     // chat text
     PutStringUTF8OnStream ( vecData, iPos, strUTF8ChatText );
-
-    CreateAndSendMessage ( PROTMESSID_CHAT_TEXT, vecData );
 }
 
 bool CProtocol::EvaluateChatTextMes ( const CVector<uint8_t>& vecData )
@@ -1563,14 +2153,33 @@ bool CProtocol::EvaluateVersionAndOSMes ( const CVector<uint8_t>& vecData )
 
 void CProtocol::CreateRecorderStateMes ( const ERecorderState eRecorderState )
 {
-    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
-    int              iPos = 0;      // init position pointer
+    CVector<uint8_t> vecData;
+
+    GenRecorderStateMesData ( vecData, eRecorderState );
+
+    CreateAndSendMessage ( PROTMESSID_RECORDER_STATE, vecData );
+}
+
+void CProtocol::PrepareRecorderStateMes ( CPreparedMessage&    PrepMess,
+                                          const ERecorderState eRecorderState )
+{
+    CVector<uint8_t> vecData;
+
+    GenRecorderStateMesData ( vecData, eRecorderState );
+
+    PrepMess.Init ( PROTMESSID_RECORDER_STATE, vecData );
+}
+
+void CProtocol::GenRecorderStateMesData ( CVector<uint8_t>&    vecData,
+                                          const ERecorderState eRecorderState )
+{
+    int iPos = 0; // init position pointer
 
     // build data vector
+    vecData.Init ( 1 ); // 1 byte of data
+
     // server jam recorder state (1 byte)
     PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( eRecorderState ), 1 );
-
-    CreateAndSendMessage ( PROTMESSID_RECORDER_STATE, vecData );
 }
 
 bool CProtocol::EvaluateRecorderStateMes(const CVector<uint8_t>& vecData)
@@ -1601,6 +2210,35 @@ bool CProtocol::EvaluateRecorderStateMes(const CVector<uint8_t>& vecData)
     return false; // no error
 }
 
+bool CProtocol::EvaluateProtocolFeaturesMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size (future versions may append further data)
+    if ( vecData.Size() < 4 )
+    {
+        return true; // return error code
+    }
+
+    // feature flags (4 bytes)
+    const uint32_t iFeatures = GetValFromStream ( vecData, iPos, 4 );
+
+    Mutex.lock();
+    {
+        bPeerSupportsWindow    = ( iFeatures & PROT_FEATURE_SEND_WINDOW ) != 0;
+        bPeerSupportsListDelta = ( iFeatures & PROT_FEATURE_CLIENT_LIST_DELTA ) != 0;
+
+        // the peer has reset its protocol and does not know our last list
+        bSentChanListValid = false;
+    }
+    Mutex.unlock();
+
+    // the send window may have been enlarged
+    SendMessage();
+
+    return false; // no error
+}
+
 
 // Connection less messages ----------------------------------------------------
 void CProtocol::CreateCLPingMes ( const CHostAddress& InetAddr, const int iMs )
@@ -2153,50 +2791,10 @@ bool CProtocol::EvaluateCLReqVersionAndOSMes ( const CHostAddress& InetAddr )
 void CProtocol::CreateCLConnClientsListMes ( const CHostAddress&          InetAddr,
                                              const CVector<CChannelInfo>& vecChanInfo )
 {
-    const int iNumClients = vecChanInfo.Size();
-
-    // build data vector
-    CVector<uint8_t> vecData ( 0 );
-    int              iPos = 0; // init position pointer
-
-    for ( int i = 0; i < iNumClients; i++ )
-    {
-        // convert strings to utf-8
-        const QByteArray strUTF8Name = vecChanInfo[i].strName.toUtf8();
-        const QByteArray strUTF8City = vecChanInfo[i].strCity.toUtf8();
-
-        // size of current list entry
-        const int iCurListEntrLen =
-            1 /* chan ID */ + 2 /* country */ +
-            4 /* instrument */ + 1 /* skill level */ +
-            4 /* IP address */ +
-            2 /* utf-8 str. size */ + strUTF8Name.size() +
-            2 /* utf-8 str. size */ + strUTF8City.size();
-
-        // make space for new data
-        vecData.Enlarge ( iCurListEntrLen );
-
-        // channel ID (1 byte)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].iChanID ), 1 );
-
-        // country (2 bytes)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].eCountry ), 2 );
-
-        // instrument (4 bytes)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].iInstrument ), 4 );
-
-        // skill level (1 byte)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].eSkillLevel ), 1 );
-
-        // IP address (4 bytes)
-        PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( vecChanInfo[i].iIpAddr ), 4 );
-
-        // name
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8Name );
+    // build data vector (limited to the receive buffer size)
+    CVector<uint8_t> vecData;
 
-        // city
-        PutStringUTF8OnStream ( vecData, iPos, strUTF8City );
-    }
+    GenConClientListMesData ( vecData, vecChanInfo, MAX_SIZE_BYTES_CONN_CLIENTS_LIST );
 
     CreateAndImmSendConLessMessage ( PROTMESSID_CLM_CONN_CLIENTS_LIST,
                                      vecData,
@@ -2293,11 +2891,36 @@ bool CProtocol::EvaluateCLReqConnClientsListMes ( const CHostAddress& InetAddr )
 void CProtocol::CreateCLChannelLevelListMes  ( const CHostAddress&      InetAddr,
                                                const CVector<uint16_t>& vecLevelList,
                                                const int                iNumClients )
+{
+    CVector<uint8_t> vecData;
+
+    GenCLChannelLevelListMesData ( vecData, vecLevelList, iNumClients );
+
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_CHANNEL_LEVEL_LIST,
+                                     vecData,
+                                     InetAddr );
+}
+
+void CProtocol::PrepareCLChannelLevelListMes ( CPreparedMessage&        PrepMess,
+                                               const CVector<uint16_t>& vecLevelList,
+                                               const int                iNumClients )
+{
+    CVector<uint8_t> vecData;
+
+    GenCLChannelLevelListMesData ( vecData, vecLevelList, iNumClients );
+
+    PrepMess.Init ( PROTMESSID_CLM_CHANNEL_LEVEL_LIST, vecData );
+}
+
+void CProtocol::GenCLChannelLevelListMesData ( CVector<uint8_t>&        vecData,
+                                               const CVector<uint16_t>& vecLevelList,
+                                               const int                iNumClients )
 {
     // This must be a multiple of bytes at four bits per client
-    const int        iNumBytes = ( iNumClients + 1 ) / 2;
-    CVector<uint8_t> vecData( iNumBytes );
-    int              iPos = 0; // init position pointer
+    const int iNumBytes = ( iNumClients + 1 ) / 2;
+    int       iPos      = 0; // init position pointer
+
+    vecData.Init ( iNumBytes );
 
     for ( int i = 0, j = 0; i < iNumClients; i += 2 /* pack two per byte */, j++ )
     {
@@ -2307,10 +2930,6 @@ void CProtocol::CreateCLChannelLevelListMes  ( const CHostAddress&      InetAddr
 
         PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( byte ), 1 );
     }
-
-    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_CHANNEL_LEVEL_LIST,
-                                     vecData,
-                                     InetAddr );
 }
 
 bool CProtocol::EvaluateCLChannelLevelListMes  ( const CHostAddress&     InetAddr,
@@ -2406,24 +3025,15 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
     int i;
     int iCurPos;
 
-    // vector must be at least "MESS_LEN_WITHOUT_DATA_BYTE" bytes long
-    if ( iNumBytesIn < MESS_LEN_WITHOUT_DATA_BYTE )
+    // check size, tag and length of the frame before doing any further parsing
+    if ( !IsProtocolMessageFrame ( vecbyData, iNumBytesIn ) )
     {
         return true; // return error code
     }
 
 
     // Decode header -----------------------------------------------------------
-    iCurPos = 0; // start from beginning
-
-    // 2 bytes TAG
-    const int iTag = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
-
-    // check if tag is correct
-    if ( iTag != 0 )
-    {
-        return true; // return error code
-    }
+    iCurPos = 2; // start after the 2 bytes TAG which was already checked
 
     // 2 bytes ID
     iID = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
@@ -2431,27 +3041,18 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
     // 1 byte cnt
     iCnt = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 1 ) );
 
-    // 2 bytes length
+    // 2 bytes length (was already checked)
     const int iLenBy = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
 
-    // make sure the length is correct
-    if ( iLenBy != iNumBytesIn - MESS_LEN_WITHOUT_DATA_BYTE )
-    {
-        return true; // return error code
-    }
-
 
     // Now check CRC -----------------------------------------------------------
     CCRC CRCObj;
 
     const int iLenCRCCalc = MESS_HEADER_LENGTH_BYTE + iLenBy;
 
-    iCurPos = 0; // start from the beginning
+    CRCObj.AddBytes ( vecbyData.data(), iLenCRCCalc );
 
-    for ( i = 0; i < iLenCRCCalc; i++ )
-    {
-        CRCObj.AddByte ( static_cast<uint8_t> ( GetValFromStream ( vecbyData, iCurPos, 1 ) ) );
-    }
+    iCurPos = iLenCRCCalc; // the CRC follows the data
 
     if ( CRCObj.GetCRC () != GetValFromStream ( vecbyData, iCurPos, 2 ) )
     {
@@ -2460,10 +3061,9 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
 
 
     // Extract actual data -----------------------------------------------------
-
-// TODO this memory allocation is done in the real time thread but should be
-//      done in the low priority protocol management thread
-
+    // (if the protocol message queue of the socket is used, the vector has
+    // preallocated memory so that no memory is allocated in the real time
+    // thread)
     vecbyMesBodyData.Init ( iLenBy );
 
     iCurPos = MESS_HEADER_LENGTH_BYTE; // start from beginning of data
@@ -2586,16 +3186,56 @@ void CProtocol::GenMessageFrame ( CVector<uint8_t>&       vecOut,
     // Encode CRC --------------------------------------------------------------
     CCRC CRCObj;
 
-    iCurPos = 0; // start from beginning
-
     const int iLenCRCCalc = MESS_HEADER_LENGTH_BYTE + iDataLenByte;
 
-    for ( i = 0; i < iLenCRCCalc; i++ )
+    CRCObj.AddBytes ( vecOut.data(), iLenCRCCalc );
+
+    iCurPos = iLenCRCCalc; // the CRC follows the data
+
+    PutValOnStream ( vecOut, iCurPos, static_cast<uint32_t> ( CRCObj.GetCRC() ), 2 );
+}
+
+void CProtocol::CPreparedMessage::Init ( const int               iNID,
+                                         const CVector<uint8_t>& vecData )
+{
+    iID = iNID;
+
+    // build the complete message with counter zero
+    GenMessageFrame ( vecFrame, 0, iID, vecData );
+
+    // the CRC is linear in the counter bits, the counter (at byte position 4)
+    // is followed by the 2 bytes length and the data
+    for ( int i = 0; i < 8; i++ )
     {
-        CRCObj.AddByte ( static_cast<uint8_t> ( GetValFromStream ( vecOut, iCurPos, 1 ) ) );
+        veciCRCCntBitDiff[i] = CCRC::GetCRCDiff ( static_cast<uint8_t> ( 1 << i ),
+                                                  2 + vecData.Size() );
     }
+}
 
-    PutValOnStream ( vecOut, iCurPos, static_cast<uint32_t> ( CRCObj.GetCRC() ), 2 );
+void CProtocol::CPreparedMessage::GetFrame ( CVector<uint8_t>& vecOut,
+                                             const int         iCnt ) const
+{
+    const int iFrameLen = vecFrame.Size();
+
+    vecOut.Init ( iFrameLen );
+    vecOut = vecFrame;
+
+    // patch the counter (1 byte) and the CRC (2 bytes at the end)
+    uint32_t iCRC = vecFrame[iFrameLen - 2] | ( vecFrame[iFrameLen - 1] << 8 );
+
+    for ( int i = 0; i < 8; i++ )
+    {
+        if ( iCnt & ( 1 << i ) )
+        {
+            iCRC ^= veciCRCCntBitDiff[i];
+        }
+    }
+
+    int iPos = 4; // position of the counter
+    PutValOnStream ( vecOut, iPos, static_cast<uint32_t> ( iCnt ), 1 );
+
+    iPos = iFrameLen - 2;
+    PutValOnStream ( vecOut, iPos, iCRC, 2 );
 }
 
 void CProtocol::PutValOnStream ( CVector<uint8_t>& vecIn,
@@ -2634,3 +3274,103 @@ void CProtocol::PutStringUTF8OnStream ( CVector<uint8_t>& vecIn,
         PutValOnStream ( vecIn, iPos, static_cast<uint32_t> ( sStringUTF8[j] ), 1 );
     }
 }
+
+void CProtocol::PutChannelInfoOnStream ( CVector<uint8_t>&   vecIn,
+                                         int&                iPos,
+                                         const CChannelInfo& ChanInfo )
+{
+    // convert strings to utf-8
+    const QByteArray strUTF8Name = ChanInfo.strName.toUtf8();
+    const QByteArray strUTF8City = ChanInfo.strCity.toUtf8();
+
+    // size of current list entry
+    const int iCurListEntrLen =
+        1 /* chan ID */ + 2 /* country */ +
+        4 /* instrument */ + 1 /* skill level */ +
+        4 /* IP address */ +
+        2 /* utf-8 str. size */ + strUTF8Name.size() +
+        2 /* utf-8 str. size */ + strUTF8City.size();
+
+    // make space for new data
+    vecIn.Enlarge ( iCurListEntrLen );
+
+    // channel ID (1 byte)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.iChanID ), 1 );
+
+    // country (2 bytes)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.eCountry ), 2 );
+
+    // instrument (4 bytes)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.iInstrument ), 4 );
+
+    // skill level (1 byte)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.eSkillLevel ), 1 );
+
+    // IP address (4 bytes)
+    PutValOnStream ( vecIn, iPos,
+        static_cast<uint32_t> ( ChanInfo.iIpAddr ), 4 );
+
+    // name
+    PutStringUTF8OnStream ( vecIn, iPos, strUTF8Name );
+
+    // city
+    PutStringUTF8OnStream ( vecIn, iPos, strUTF8City );
+}
+
+bool CProtocol::GetChannelInfoFromStream ( const CVector<uint8_t>& vecIn,
+                                           int&                    iPos,
+                                           CChannelInfo&           ChanInfo )
+{
+/*
+    note: iPos is automatically incremented in this function
+*/
+    // check size (the next 12 bytes)
+    if ( ( vecIn.Size() - iPos ) < 12 )
+    {
+        return true; // return error code
+    }
+
+    // channel ID (1 byte)
+    ChanInfo.iChanID =
+        static_cast<int> ( GetValFromStream ( vecIn, iPos, 1 ) );
+
+    // country (2 bytes)
+    ChanInfo.eCountry =
+        static_cast<QLocale::Country> ( GetValFromStream ( vecIn, iPos, 2 ) );
+
+    // instrument (4 bytes)
+    ChanInfo.iInstrument =
+        static_cast<int> ( GetValFromStream ( vecIn, iPos, 4 ) );
+
+    // skill level (1 byte)
+    ChanInfo.eSkillLevel =
+        static_cast<ESkillLevel> ( GetValFromStream ( vecIn, iPos, 1 ) );
+
+    // IP address (4 bytes)
+    ChanInfo.iIpAddr =
+        static_cast<quint32> ( GetValFromStream ( vecIn, iPos, 4 ) );
+
+    // name
+    if ( GetStringFromStream ( vecIn,
+                               iPos,
+                               MAX_LEN_FADER_TAG,
+                               ChanInfo.strName ) )
+    {
+        return true; // return error code
+    }
+
+    // city
+    if ( GetStringFromStream ( vecIn,
+                               iPos,
+                               MAX_LEN_SERVER_CITY,
+                               ChanInfo.strCity ) )
+    {
+        return true; // return error code
+    }
+
+    return false; // no error
+}
@@ -27,6 +27,7 @@
 #include <QMutex>
 #include <QTimer>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <list>
 #include "global.h"
 #include "util.h"
@@ -60,6 +61,8 @@
 #define PROTMESSID_MUTE_STATE_CHANGED         31 // mute state of your signal at another client has changed
 #define PROTMESSID_CLIENT_ID                  32 // current user ID and server status
 #define PROTMESSID_RECORDER_STATE             33 // contains the state of the jam recorder (ERecorderState)
+#define PROTMESSID_PROTOCOL_FEATURES          34 // supported features of the protocol implementation
+#define PROTMESSID_CONN_CLIENTS_LIST_DELTA    35 // changes of the channel infos for connected clients
 
 // message IDs of connection less messages (CLM)
 // DEFINITION -> start at 1000, end at 1999, see IsConnectionLessMessageID
@@ -84,8 +87,35 @@
 #define MESS_HEADER_LENGTH_BYTE         7 // TAG (2), ID (2), cnt (1), length (2)
 #define MESS_LEN_WITHOUT_DATA_BYTE      ( MESS_HEADER_LENGTH_BYTE + 2 /* CRC (2) */ )
 
-// time out for message re-send if no acknowledgement was received
+// time out for message re-send if no acknowledgement was received, this is
+// the initial value, the time out is adapted to the measured round trip time
+// and doubled on each expiry (within the given limits)
 #define SEND_MESS_TIMEOUT_MS            400 // ms
+#define SEND_MESS_MIN_TIMEOUT_MS        100 // ms
+#define SEND_MESS_MAX_TIMEOUT_MS        2000 // ms
+
+// maximum number of unacknowledged messages in flight if the peer supports
+// it (must be less than half of the 8 bit counter range since the receiver
+// uses the counter to detect duplicates and to restore the message order)
+#define PROT_SEND_WINDOW_SIZE           64
+
+// protocol feature flags of the PROTMESSID_PROTOCOL_FEATURES message
+#define PROT_FEATURE_SEND_WINDOW        0x00000001 // multiple messages in flight
+#define PROT_FEATURE_CLIENT_LIST_DELTA  0x00000002 // PROTMESSID_CONN_CLIENTS_LIST_DELTA
+#define PROT_FEATURES_SUPPORTED         ( PROT_FEATURE_SEND_WINDOW | PROT_FEATURE_CLIENT_LIST_DELTA )
+
+// change types of the PROTMESSID_CONN_CLIENTS_LIST_DELTA message
+#define PROT_CLIENT_LIST_DELTA_REMOVE   0 // channel has left
+#define PROT_CLIENT_LIST_DELTA_UPDATE   1 // channel is new or its infos have changed
+
+// The connected clients list of a server with many clients does not fit in the
+// receive buffer of the clients. The complete list message is therefore limited
+// to the buffer size (peers which do not support the list changes do not get
+// the further clients). Peers which support the list changes get a large list
+// in parts which fit in one datagram without IP fragmentation: a complete list
+// message with the first clients, followed by change messages.
+#define MAX_SIZE_BYTES_CONN_CLIENTS_LIST      ( MAX_SIZE_BYTES_NETW_BUF - MESS_LEN_WITHOUT_DATA_BYTE )
+#define MAX_SIZE_BYTES_CONN_CLIENTS_LIST_PART 1200
 
 
 /* Classes ********************************************************************/
@@ -94,6 +124,29 @@ class CProtocol : public QObject
     Q_OBJECT
 
 public:
+    // A message which is sent unchanged to multiple peers. The message frame
+    // and its CRC are built once, for each peer only the counter and the CRC
+    // are patched.
+    class CPreparedMessage
+    {
+    public:
+        CPreparedMessage() : iID ( PROTMESSID_ILLEGAL ) {}
+
+        void Init ( const int               iNID,
+                    const CVector<uint8_t>& vecData );
+
+        void GetFrame ( CVector<uint8_t>& vecOut,
+                        const int         iCnt ) const;
+
+        int GetID() const { return iID; }
+        int GetDataSize() const { return vecFrame.Size() - MESS_LEN_WITHOUT_DATA_BYTE; }
+
+    protected:
+        int              iID;
+        CVector<uint8_t> vecFrame;             // frame with counter zero
+        uint32_t         veciCRCCntBitDiff[8]; // CRC change per counter bit
+    };
+
     CProtocol();
 
     void Reset();
@@ -105,6 +158,8 @@ public:
     void CreateChanPanMes ( const int iChanID, const double dPan );
     void CreateMuteStateHasChangedMes ( const int iChanID, const bool bIsMuted );
     void CreateConClientListMes ( const CVector<CChannelInfo>& vecChanInfo );
+    void CreateConClientListMes ( const CVector<CChannelInfo>& vecChanInfo,
+                                  const CPreparedMessage&      FullListMess );
     void CreateReqConnClientsList();
     void CreateChanInfoMes ( const CChannelCoreInfo ChanInfo );
     void CreateReqChanInfoMes();
@@ -117,6 +172,21 @@ public:
     void CreateVersionAndOSMes();
     void CreateRecorderStateMes ( const ERecorderState eRecorderState );
 
+    // messages which are sent to multiple peers (see CPreparedMessage)
+    static void PrepareConClientListMes ( CPreparedMessage&            PrepMess,
+                                          const CVector<CChannelInfo>& vecChanInfo );
+    static void PrepareChatTextMes ( CPreparedMessage& PrepMess,
+                                     const QString&    strChatText );
+    static void PrepareRecorderStateMes ( CPreparedMessage&    PrepMess,
+                                          const ERecorderState eRecorderState );
+    static void PrepareCLChannelLevelListMes ( CPreparedMessage&        PrepMess,
+                                               const CVector<uint16_t>& vecLevelList,
+                                               const int                iNumClients );
+
+    void SendPreparedMessage ( const CPreparedMessage& PrepMess );
+    void SendPreparedConLessMessage ( const CPreparedMessage& PrepMess,
+                                      const CHostAddress&     InetAddr );
+
     void CreateCLPingMes               ( const CHostAddress& InetAddr, const int iMs );
     void CreateCLPingWithNumClientsMes ( const CHostAddress& InetAddr,
                                          const int           iMs,
@@ -144,6 +214,17 @@ public:
     void CreateCLRegisterServerResp    ( const CHostAddress& InetAddr,
                                          const ESvrRegResult eResult );
 
+    // Cheap check of the frame header (size, tag and length field) without
+    // calculating the CRC. Audio packets practically never pass this check so
+    // that they can be dispatched without parsing the protocol frame.
+    static bool IsProtocolMessageFrame ( const CVector<uint8_t>& vecbyData,
+                                         const int               iNumBytesIn )
+    {
+        return ( iNumBytesIn >= MESS_LEN_WITHOUT_DATA_BYTE ) &&
+               ( vecbyData[0] == 0 ) && ( vecbyData[1] == 0 ) && // 2 bytes TAG
+               ( ( vecbyData[5] | ( vecbyData[6] << 8 ) ) == iNumBytesIn - MESS_LEN_WITHOUT_DATA_BYTE ); // 2 bytes length
+    }
+
     static bool ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
                                     const int               iNumBytesIn,
                                     CVector<uint8_t>&       vecbyMesBodyData,
@@ -170,42 +251,66 @@ protected:
     {
     public:
         CSendMessage() : vecMessage ( 0 ), iID ( PROTMESSID_ILLEGAL ),
-            iCnt ( 0 ) {}
+            iCnt ( 0 ), bSent ( false ), bAcked ( false ),
+            bRetransmitted ( false ), iSendTimeMs ( 0 ) {}
         CSendMessage ( const CVector<uint8_t>& nMess, const int iNCnt,
             const int iNID ) : vecMessage ( nMess ), iID ( iNID ),
-            iCnt ( iNCnt ) {}
+            iCnt ( iNCnt ), bSent ( false ), bAcked ( false ),
+            bRetransmitted ( false ), iSendTimeMs ( 0 ) {}
 
         CSendMessage& operator= ( const CSendMessage& NewSendMess )
         {
             vecMessage.Init ( NewSendMess.vecMessage.Size() );
             vecMessage = NewSendMess.vecMessage;
 
-            iID  = NewSendMess.iID;
-            iCnt = NewSendMess.iCnt;
-            return *this; 
+            iID            = NewSendMess.iID;
+            iCnt           = NewSendMess.iCnt;
+            bSent          = NewSendMess.bSent;
+            bAcked         = NewSendMess.bAcked;
+            bRetransmitted = NewSendMess.bRetransmitted;
+            iSendTimeMs    = NewSendMess.iSendTimeMs;
+            return *this;
         }
 
         CVector<uint8_t> vecMessage;
         int              iID, iCnt;
+        bool             bSent;          // message is in flight
+        bool             bAcked;         // acknowledged but not yet at the front of the queue
+        bool             bRetransmitted; // no round trip time measurement (Karn's algorithm)
+        qint64           iSendTimeMs;    // time of the last transmission
     };
 
-    void EnqueueMessage ( CVector<uint8_t>& vecMessage,
-                          const int         iCnt,
-                          const int         iID );
+    // must be called with the mutex locked
+    void EnqueueMessage ( const int               iID,
+                          const CVector<uint8_t>& vecData );
+
+    void EnqueuePreparedMessage ( const CPreparedMessage& PrepMess );
+
+    void EnqueueFeaturesMessage();
+
+    void ProcessAcknMess ( const int iRecCounter,
+                           const int iAcknID );
 
-    void GenMessageFrame ( CVector<uint8_t>&       vecOut,
-                           const int               iCnt,
-                           const int               iID,
-                           const CVector<uint8_t>& vecData );
+    void UpdateSendTimeout ( const qint64 iRoundTripTimeMs );
 
-    void PutValOnStream ( CVector<uint8_t>& vecIn,
-                          int&              iPos,
-                          const uint32_t    iVal,
-                          const int         iNumOfBytes );
+    void StartSendMessTimer();
 
-    void PutStringUTF8OnStream ( CVector<uint8_t>& vecIn,
+    bool EvaluateMessage ( const CVector<uint8_t>& vecbyMesBodyData,
+                           const int               iRecID );
+
+    static void GenMessageFrame ( CVector<uint8_t>&       vecOut,
+                                  const int               iCnt,
+                                  const int               iID,
+                                  const CVector<uint8_t>& vecData );
+
+    static void PutValOnStream ( CVector<uint8_t>& vecIn,
                                  int&              iPos,
-                                 const QByteArray& sStringUTF8 );
+                                 const uint32_t    iVal,
+                                 const int         iNumOfBytes );
+
+    static void PutStringUTF8OnStream ( CVector<uint8_t>& vecIn,
+                                        int&              iPos,
+                                        const QByteArray& sStringUTF8 );
 
     static uint32_t GetValFromStream ( const CVector<uint8_t>& vecIn,
                                        int&                    iPos,
@@ -216,7 +321,36 @@ protected:
                                const int               iMaxStringLen,
                                QString&                strOut );
 
+    // a list entry of the connected clients list (enlarges the vector)
+    static void PutChannelInfoOnStream ( CVector<uint8_t>&   vecIn,
+                                         int&                iPos,
+                                         const CChannelInfo& ChanInfo );
+
+    // message data of the messages which can be prepared
+    static int  GenConClientListMesData ( CVector<uint8_t>&            vecData,
+                                          const CVector<CChannelInfo>& vecChanInfo,
+                                          const int                    iMaxNumBytes );
+    static void GenChatTextMesData ( CVector<uint8_t>& vecData,
+                                     const QString&    strChatText );
+    static void GenRecorderStateMesData ( CVector<uint8_t>&    vecData,
+                                          const ERecorderState eRecorderState );
+    static void GenCLChannelLevelListMesData ( CVector<uint8_t>&        vecData,
+                                               const CVector<uint16_t>& vecLevelList,
+                                               const int                iNumClients );
+
+    bool GetChannelInfoFromStream ( const CVector<uint8_t>& vecIn,
+                                    int&                    iPos,
+                                    CChannelInfo&           ChanInfo );
+
+    // must be called with the mutex locked
+    static void CreateConClientListDeltaData ( const CVector<CChannelInfo>& vecChanInfo,
+                                               const CVector<CChannelInfo>& vecOldChanInfo,
+                                               CVector<CVector<uint8_t> >&  vecvecData );
+    static void AddConClientListDeltaEntry ( CVector<CVector<uint8_t> >& vecvecData,
+                                             const CVector<uint8_t>&     vecEntry );
+
     void SendMessage();
+    void ResendTimedOutMessages();
 
     void CreateAndSendMessage ( const int               iID,
                                 const CVector<uint8_t>& vecData );
@@ -232,6 +366,7 @@ protected:
     bool EvaluateChanPanMes             ( const CVector<uint8_t>& vecData );
     bool EvaluateMuteStateHasChangedMes ( const CVector<uint8_t>& vecData );
     bool EvaluateConClientListMes       ( const CVector<uint8_t>& vecData );
+    bool EvaluateConClientListDeltaMes  ( const CVector<uint8_t>& vecData );
     bool EvaluateReqConnClientsList();
     bool EvaluateChanInfoMes            ( const CVector<uint8_t>& vecData );
     bool EvaluateReqChanInfoMes();
@@ -242,6 +377,7 @@ protected:
     bool EvaluateReqChannelLevelListMes ( const CVector<uint8_t>& vecData );
     bool EvaluateVersionAndOSMes        ( const CVector<uint8_t>& vecData );
     bool EvaluateRecorderStateMes       ( const CVector<uint8_t>& vecData );
+    bool EvaluateProtocolFeaturesMes    ( const CVector<uint8_t>& vecData );
 
     bool EvaluateCLPingMes               ( const CHostAddress&     InetAddr,
                                            const CVector<uint8_t>& vecData );
@@ -267,18 +403,49 @@ protected:
     bool EvaluateCLRegisterServerResp    ( const CHostAddress&     InetAddr,
                                            const CVector<uint8_t>& vecData );
 
-    int                     iOldRecID;
-    int                     iOldRecCnt;
-
-    // these two objects must be sequred by a mutex
+    // Receive window: the message IDs of the last received counters are used
+    // to detect resent messages. If the peer sends multiple messages in
+    // flight, messages which arrive ahead of a lost message are buffered
+    // (and acknowledged) so that all messages are evaluated in order.
+    bool                       bRecWindowSynced;
+    int                        iRecExpectedCnt;
+    CVector<int>               veciRecIDs;        // per counter, behind the expected counter
+    CVector<int>               veciRecBufIDs;     // per counter, ahead of the expected counter
+    CVector<CVector<uint8_t> > vecvecbyRecBufMess;
+
+    // these objects must be sequred by a mutex
     uint8_t                 iCounter;
     std::list<CSendMessage> SendMessQueue;
-
+    bool                    bFeaturesSent;
+    bool                    bPeerSupportsWindow;
+    bool                    bPeerSupportsListDelta;
+
+    // Connected clients list: after a full list was sent, only the changes
+    // are sent if the peer supports it. Both sides count the list versions
+    // so that the receiver can request a full list if it gets out of sync.
+    bool                    bSentChanListValid;
+    uint8_t                 iSentChanListVersion;
+    CVector<CChannelInfo>   vecSentChanList;
+
+    // receiver side of the connected clients list (only used by the
+    // receiving thread)
+    bool                    bRecChanListValid;
+    bool                    bRecChanListRequested;
+    uint8_t                 iRecChanListVersion;
+    CVector<CChannelInfo>   vecRecChanList;
+
+    // adaptive send time out (RFC 6298)
+    bool                    bRoundTripTimeValid;
+    double                  dSmoothedRoundTripTimeMs;
+    double                  dRoundTripTimeVarMs;
+    int                     iSendTimeoutMs;
+
+    QElapsedTimer           SendMessClock;
     QTimer                  TimerSendMess;
     QMutex                  Mutex;
 
 public slots:
-    void OnTimerSendMess() { SendMessage(); }
+    void OnTimerSendMess() { ResendTimedOutMessages(); }
 
 signals:
     // transmitting
@@ -30,7 +30,8 @@ CJamController::CJamController() :
     bRecorderInitialised ( false ),
     bEnableRecording     ( false ),
     strRecordingDir      ( "" ),
-    pthJamRecorder       ( nullptr )
+    pthJamRecorder       ( nullptr ),
+    iNumQueuedFrames     ( 0 )
 {
 }
 
@@ -86,7 +87,10 @@ void CJamController::SetRecordingDir ( QString newRecordingDir,
 
     if ( !newRecordingDir.isEmpty() )
     {
-        pJamRecorder = new recorder::CJamRecorder ( newRecordingDir, iServerFrameSizeSamples );
+        // the frames queued for a previous recorder thread are discarded
+        iNumQueuedFrames = 0;
+
+        pJamRecorder = new recorder::CJamRecorder ( newRecordingDir, iServerFrameSizeSamples, iNumQueuedFrames );
         strRecorderErrMsg = pJamRecorder->Init();
         bRecorderInitialised = ( strRecorderErrMsg == QString::null );
         bEnableRecording = bRecorderInitialised;
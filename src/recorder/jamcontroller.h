@@ -46,6 +46,11 @@ public:
                            int     iServerFrameSizeSamples );
     ERecorderState GetRecorderState();
 
+    // the server must call this function for each emitted audio frame, the
+    // number of frames which wait for the recorder thread is monitored
+    void AudioFrameQueued() { iNumQueuedFrames++; }
+    int GetNumQueuedFrames() { return std::max ( 0, iNumQueuedFrames.load() ); }
+
 private:
     CServer* pServer;
 
@@ -57,6 +62,8 @@ private:
     CJamRecorder* pJamRecorder;
     QString       strRecorderErrMsg;
 
+    std::atomic<int> iNumQueuedFrames;
+
 signals:
     void RestartRecorder();
     void StopRecorder();
@@ -517,6 +517,8 @@ void CJamRecorder::OnDisconnected(int iChID)
  */
 void CJamRecorder::OnFrame(const int iChID, const QString name, const CHostAddress address, const int numAudioChannels, const CVector<int16_t> data)
 {
+    numQueuedFrames--;
+
     // Make sure we are ready
     if ( !isRecording )
     {
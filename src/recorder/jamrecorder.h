@@ -27,6 +27,7 @@
 #include <QDir>
 #include <QFile>
 #include <QDateTime>
+#include <atomic>
 
 #include "../util.h"
 #include "../channel.h"
@@ -139,11 +140,13 @@ class CJamRecorder : public QObject
     Q_OBJECT
 
 public:
-    CJamRecorder ( const QString strRecordingBaseDir,
-                   const int     iServerFrameSizeSamples ) :
+    CJamRecorder ( const QString     strRecordingBaseDir,
+                   const int         iServerFrameSizeSamples,
+                   std::atomic<int>& numQueuedFrames ) :
         recordBaseDir           ( strRecordingBaseDir ),
         iServerFrameSizeSamples ( iServerFrameSizeSamples ),
-        isRecording             ( false )
+        isRecording             ( false ),
+        numQueuedFrames         ( numQueuedFrames )
     {
     }
 
@@ -170,6 +173,10 @@ private:
     bool         isRecording;
     CJamSession* currentSession;
 
+    // frames emitted by the server which are not yet processed (owned by the
+    // controller)
+    std::atomic<int>& numQueuedFrames;
+
 signals:
     void RecordingSessionStarted ( QString sessionDir );
 
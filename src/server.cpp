@@ -23,6 +23,9 @@
 \******************************************************************************/
 
 #include "server.h"
+#if defined ( __i386__ ) || defined ( __x86_64__ ) || defined ( _M_IX86 ) || defined ( _M_X64 )
+# include <emmintrin.h>
+#endif
 
 
 // CHighPrecisionTimer implementation ******************************************
@@ -115,7 +118,15 @@ void CHighPrecisionTimer::OnTimer()
 }
 #else // Mac and Linux
 CHighPrecisionTimer::CHighPrecisionTimer ( const bool bUseDoubleSystemFrameSize ) :
-    bRun ( false )
+    bRun                     ( false ),
+    iCPUCore                 ( -1 ),
+    iRealTimePriority        ( 0 ),
+    iNumMissedDeadlines      ( 0 ),
+    iNumResyncs              ( 0 ),
+    iMaxLatenessNs           ( 0 ),
+    iTotalNumMissedDeadlines ( 0 ),
+    iTotalNumResyncs         ( 0 ),
+    iCurTickLatenessNs       ( 0 )
 {
     // calculate delay in ns
     uint64_t iNsDelay;
@@ -152,6 +163,12 @@ void CHighPrecisionTimer::Start()
         // set run flag
         bRun = true;
 
+        // reset timing statistics
+        iNumMissedDeadlines = 0;
+        iNumResyncs         = 0;
+        iMaxLatenessNs      = 0;
+        iCurTickLatenessNs  = 0;
+
         // set initial end time
 #if defined ( __APPLE__ ) || defined ( __MACOSX )
         NextEnd = mach_absolute_time() + Delay;
@@ -180,17 +197,51 @@ void CHighPrecisionTimer::Stop()
     wait ( 5000 );
 }
 
+void CHighPrecisionTimer::GetAndResetTimingStats ( int&    iNumMissedDeadlinesOut,
+                                                  int&    iNumResyncsOut,
+                                                  double& dMaxLatenessMs )
+{
+    iNumMissedDeadlinesOut = iNumMissedDeadlines.exchange ( 0 );
+    iNumResyncsOut         = iNumResyncs.exchange ( 0 );
+    dMaxLatenessMs         = static_cast<double> ( iMaxLatenessNs.exchange ( 0 ) ) / 1000000;
+}
+
+void CHighPrecisionTimer::GetTotalTimingStats ( uint64_t& iNumMissedDeadlinesOut,
+                                               uint64_t& iNumResyncsOut ) const
+{
+    iNumMissedDeadlinesOut = iTotalNumMissedDeadlines.load ( std::memory_order_relaxed );
+    iNumResyncsOut         = iTotalNumResyncs.load ( std::memory_order_relaxed );
+}
+
+#if !defined ( __APPLE__ ) && !defined ( __MACOSX )
+static inline int64_t TimeDiffNs ( const timespec& TimeA,
+                                   const timespec& TimeB )
+{
+    return static_cast<int64_t> ( TimeA.tv_sec - TimeB.tv_sec ) * 1000000000 +
+        ( TimeA.tv_nsec - TimeB.tv_nsec );
+}
+#endif
+
 void CHighPrecisionTimer::run()
 {
-    // loop until the thread shall be terminated
-    while ( bRun )
+    if ( iCPUCore >= 0 )
     {
-        // call processing routine by fireing signal
+        CThreadUtil::SetCurrentThreadAffinity ( iCPUCore );
+    }
 
-// TODO by emit a signal we leave the high priority thread -> maybe use some
-//      other connection type to have something like a true callback, e.g.
-//      "Qt::DirectConnection" -> Can this work?
+    // optionally use real-time scheduling for the timer thread (the server
+    // processing runs directly in this thread)
+    if ( ( iRealTimePriority > 0 ) &&
+         !CThreadUtil::SetCurrentThreadRealTimePriority ( iRealTimePriority ) )
+    {
+        qWarning() << "the real-time priority of the timer thread could not be set";
+    }
 
+    // loop until the thread shall be terminated
+    while ( bRun )
+    {
+        // call processing routine by fireing signal (the server connects
+        // its processing directly so that it runs in this thread)
         emit timeout();
 
         // now wait until the next buffer shall be processed (we
@@ -201,10 +252,48 @@ void CHighPrecisionTimer::run()
 
         NextEnd += Delay;
 #else
-        clock_nanosleep ( CLOCK_MONOTONIC,
-                          TIMER_ABSTIME,
-                          &NextEnd,
-                          NULL );
+        timespec CurTime;
+        clock_gettime ( CLOCK_MONOTONIC, &CurTime );
+
+        const int64_t iProcLatenessNs = TimeDiffNs ( CurTime, NextEnd );
+
+        if ( iProcLatenessNs > 0 )
+        {
+            // the processing of this tick took longer than the tick period,
+            // the next tick is started immediately to catch up
+            iNumMissedDeadlines++;
+            iTotalNumMissedDeadlines++;
+
+            iCurTickLatenessNs = iProcLatenessNs;
+
+            // if we are too late (e.g. after the system was suspended), do not
+            // catch up but restart the schedule from now
+            if ( iProcLatenessNs > static_cast<int64_t> ( TIMER_RESYNC_THRESHOLD_MS ) * 1000000 )
+            {
+                NextEnd = CurTime;
+                iNumResyncs++;
+                iTotalNumResyncs++;
+            }
+        }
+        else
+        {
+            clock_nanosleep ( CLOCK_MONOTONIC,
+                              TIMER_ABSTIME,
+                              &NextEnd,
+                              NULL );
+
+            // the wake-up lateness is the scheduling jitter of the timer
+            clock_gettime ( CLOCK_MONOTONIC, &CurTime );
+
+            const int64_t iWakeUpLatenessNs = TimeDiffNs ( CurTime, NextEnd );
+
+            iCurTickLatenessNs = iWakeUpLatenessNs;
+
+            if ( iWakeUpLatenessNs > iMaxLatenessNs )
+            {
+                iMaxLatenessNs = iWakeUpLatenessNs;
+            }
+        }
 
         NextEnd.tv_nsec += Delay;
         if ( NextEnd.tv_nsec >= 1000000000L )
@@ -218,269 +307,1018 @@ void CHighPrecisionTimer::run()
 #endif
 
 
-// CServer implementation ******************************************************
-CServer::CServer ( const int          iNewMaxNumChan,
-                   const int          iMaxDaysHistory,
-                   const QString&     strLoggingFileName,
-                   const quint16      iPortNumber,
-                   const QString&     strHTMLStatusFileName,
-                   const QString&     strHistoryFileName,
-                   const QString&     strServerNameForHTMLStatusFile,
-                   const QString&     strCentralServer,
-                   const QString&     strServerInfo,
-                   const QString&     strNewWelcomeMessage,
-                   const QString&     strRecordingDirName,
-                   const bool         bNCentServPingServerInList,
-                   const bool         bNDisconnectAllClientsOnQuit,
-                   const bool         bNUseDoubleSystemFrameSize,
-                   const ELicenceType eNLicenceType ) :
-    vecWindowPosMain            (), // empty array
-    bUseDoubleSystemFrameSize   ( bNUseDoubleSystemFrameSize ),
-    iMaxNumChannels             ( iNewMaxNumChan ),
-    Socket                      ( this, iPortNumber ),
-    Logging                     ( iMaxDaysHistory ),
-    iFrameCount                 ( 0 ),
-    bWriteStatusHTMLFile        ( false ),
-    HighPrecisionTimer          ( bNUseDoubleSystemFrameSize ),
-    ServerListManager           ( iPortNumber,
-                                  strCentralServer,
-                                  strServerInfo,
-                                  iNewMaxNumChan,
-                                  bNCentServPingServerInList,
-                                  &ConnLessProtocol ),
-    bAutoRunMinimized           ( false ),
-    eLicenceType                ( eNLicenceType ),
-    bDisconnectAllClientsOnQuit ( bNDisconnectAllClientsOnQuit ),
-    pSignalHandler              ( CSignalHandler::getSingletonP() )
+// CServerWorkerPool implementation ********************************************
+// hint to the CPU that we are in a busy-wait loop
+static inline void CpuRelax()
 {
-    int iOpusError;
-    int i;
+#if defined ( __i386__ ) || defined ( __x86_64__ ) || defined ( _M_IX86 ) || defined ( _M_X64 )
+    _mm_pause();
+#elif ( defined ( __aarch64__ ) || defined ( __arm__ ) ) && defined ( __GNUC__ )
+    __asm__ __volatile__ ( "yield" );
+#endif
+}
 
-    // create OPUS encoder/decoder for each channel (must be done before
-    // enabling the channels), create a mono and stereo encoder/decoder
-    // for each channel
-    for ( i = 0; i < iMaxNumChannels; i++ )
+CServerWorkerPool::CServerWorkerPool ( CServer* pNServer ) :
+    pServer             ( pNServer ),
+    vecpWorkerThreads   ( 0 ),
+    iRTPriority         ( 0 ),
+    bRun                ( false ),
+    iGeneration         ( 0 ),
+    iNumItems           ( 0 ),
+    iNextItem           ( 0 ),
+    iNumWorkersDone     ( 0 ),
+    iNumSleepingWorkers ( 0 ),
+    bWaitingForWorkers  ( false )
+{
+}
+
+void CServerWorkerPool::Start ( const int           iNewNumWorkers,
+                                const CVector<int>& veciCPUCores,
+                                const int           iNewRTPriority )
+{
+    // only start if not already running
+    if ( bRun || ( iNewNumWorkers <= 0 ) )
     {
-        // init OPUS -----------------------------------------------------------
-        OpusMode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
-                                                DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES,
-                                                &iOpusError );
-
-        Opus64Mode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
-                                                  SYSTEM_FRAME_SIZE_SAMPLES,
-                                                  &iOpusError );
-
-        // init audio encoders and decoders
-        OpusEncoderMono[i]     = opus_custom_encoder_create ( OpusMode[i],   1, &iOpusError ); // mono encoder legacy
-        OpusDecoderMono[i]     = opus_custom_decoder_create ( OpusMode[i],   1, &iOpusError ); // mono decoder legacy
-        OpusEncoderStereo[i]   = opus_custom_encoder_create ( OpusMode[i],   2, &iOpusError ); // stereo encoder legacy
-        OpusDecoderStereo[i]   = opus_custom_decoder_create ( OpusMode[i],   2, &iOpusError ); // stereo decoder legacy
-        Opus64EncoderMono[i]   = opus_custom_encoder_create ( Opus64Mode[i], 1, &iOpusError ); // mono encoder OPUS64
-        Opus64DecoderMono[i]   = opus_custom_decoder_create ( Opus64Mode[i], 1, &iOpusError ); // mono decoder OPUS64
-        Opus64EncoderStereo[i] = opus_custom_encoder_create ( Opus64Mode[i], 2, &iOpusError ); // stereo encoder OPUS64
-        Opus64DecoderStereo[i] = opus_custom_decoder_create ( Opus64Mode[i], 2, &iOpusError ); // stereo decoder OPUS64
-
-        // we require a constant bit rate
-        opus_custom_encoder_ctl ( OpusEncoderMono[i],     OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i],   OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i],   OPUS_SET_VBR ( 0 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_VBR ( 0 ) );
+        return;
+    }
 
-        // for 64 samples frame size we have to adjust the PLC behavior to avoid loud artifacts
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i],   OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
+    bRun        = true;
+    iRTPriority = iNewRTPriority;
 
-        // we want as low delay as possible
-        opus_custom_encoder_ctl ( OpusEncoderMono[i],     OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i],   OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( Opus64EncoderMono[i],   OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
-        opus_custom_encoder_ctl ( Opus64EncoderStereo[i], OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+    // The workers are pinned to the given CPU cores. If no cores are given,
+    // the workers are pinned to the CPU cores following the first core. If
+    // we have more workers than CPU cores, we leave the scheduling to the
+    // operating system.
+    const int iNumCPUCores = CThreadUtil::GetNumCPUCores();
 
-        // set encoder low complexity for legacy 128 samples frame size
-        opus_custom_encoder_ctl ( OpusEncoderMono[i],   OPUS_SET_COMPLEXITY ( 1 ) );
-        opus_custom_encoder_ctl ( OpusEncoderStereo[i], OPUS_SET_COMPLEXITY ( 1 ) );
+    for ( int i = 0; i < iNewNumWorkers; i++ )
+    {
+        int iCPUCore = -1;
 
+        if ( veciCPUCores.Size() > 0 )
+        {
+            iCPUCore = veciCPUCores[i % veciCPUCores.Size()];
+        }
+        else if ( iNewNumWorkers < iNumCPUCores )
+        {
+            iCPUCore = i + 1;
+        }
 
-        // init double-to-normal frame size conversion buffers -----------------
-        // use worst case memory initialization to avoid allocating memory in
-        // the time-critical thread
-        DoubleFrameSizeConvBufIn[i].Init  ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
-        DoubleFrameSizeConvBufOut[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        vecpWorkerThreads.Add ( new CWorkerThread ( this, iGeneration, i + 1, iCPUCore ) );
+        vecpWorkerThreads[i]->start ( QThread::TimeCriticalPriority );
     }
+}
 
-    // define colors for chat window identifiers
-    vstrChatColors.Init ( 6 );
-    vstrChatColors[0] = "mediumblue";
-    vstrChatColors[1] = "red";
-    vstrChatColors[2] = "darkorchid";
-    vstrChatColors[3] = "green";
-    vstrChatColors[4] = "maroon";
-    vstrChatColors[5] = "coral";
-
-    // set the server frame size
-    if ( bUseDoubleSystemFrameSize )
+void CServerWorkerPool::Stop()
+{
+    if ( !bRun )
     {
-        iServerFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+        return;
     }
-    else
+
+    // set flag so that the threads can leave the main loop and wake up all
+    // sleeping threads
+    bRun = false;
+
+    MutexWakeUp.lock();
     {
-        iServerFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+        WakeUpCondition.wakeAll();
     }
+    MutexWakeUp.unlock();
 
+    for ( int i = 0; i < vecpWorkerThreads.Size(); i++ )
+    {
+        // give thread some time to terminate
+        vecpWorkerThreads[i]->wait ( 5000 );
+        delete vecpWorkerThreads[i];
+    }
 
-    // To avoid audio clitches, in the entire realtime timer audio processing
-    // routine including the ProcessData no memory must be allocated. Since we
-    // do not know the required sizes for the vectors, we allocate memory for
-    // the worst case here:
+    vecpWorkerThreads.Init ( 0 );
+}
 
-    // allocate worst case memory for the temporary vectors
-    vecChanIDsCurConChan.Init          ( iMaxNumChannels );
-    vecvecdGains.Init                  ( iMaxNumChannels );
-    vecvecdPannings.Init               ( iMaxNumChannels );
-    vecvecsData.Init                   ( iMaxNumChannels );
-    vecvecsSendData.Init               ( iMaxNumChannels );
-    vecvecbyCodedData.Init             ( iMaxNumChannels );
-    vecNumAudioChannels.Init           ( iMaxNumChannels );
-    vecNumFrameSizeConvBlocks.Init     ( iMaxNumChannels );
-    vecUseDoubleSysFraSizeConvBuf.Init ( iMaxNumChannels );
-    vecAudioComprType.Init             ( iMaxNumChannels );
+void CServerWorkerPool::Process ( const int iNewNumItems )
+{
+    const int iNumWorkers = vecpWorkerThreads.Size();
 
-    for ( i = 0; i < iMaxNumChannels; i++ )
+    // if we do not have any worker or only a single item, it is cheaper to
+    // do the processing directly
+    if ( ( iNumWorkers == 0 ) || ( iNewNumItems < 2 ) )
     {
-        // init vectors storing information of all channels
-        vecvecdGains[i].Init    ( iMaxNumChannels );
-        vecvecdPannings[i].Init ( iMaxNumChannels );
+        for ( int i = 0; i < iNewNumItems; i++ )
+        {
+            pServer->MixEncodeTransmitData ( i, 0 );
+        }
 
-        // we always use stereo audio buffers (which is the worst case)
-        vecvecsData[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        return;
+    }
 
-        // (note that we only allocate iMaxNumChannels buffers for the send
-        // and coded data because of the OMP implementation)
-        vecvecsSendData[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+    // prepare the new tick and publish it to the workers (the increment of the
+    // generation counter releases all previous stores)
+    iNumItems.store       ( iNewNumItems, std::memory_order_relaxed );
+    iNextItem.store       ( 0,            std::memory_order_relaxed );
+    iNumWorkersDone.store ( 0,            std::memory_order_relaxed );
+    iGeneration.fetch_add ( 1 );
 
-        // allocate worst case memory for the coded data
-        vecvecbyCodedData[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
+    // only take the mutex if at least one worker went to sleep
+    if ( iNumSleepingWorkers.load() > 0 )
+    {
+        MutexWakeUp.lock();
+        {
+            WakeUpCondition.wakeAll();
+        }
+        MutexWakeUp.unlock();
     }
 
-    // allocate worst case memory for the channel levels
-    vecChannelLevels.Init ( iMaxNumChannels );
+    // the calling thread works on the items, too
+    ProcessItems ( 0 );
 
-    // enable history graph (if requested)
-    if ( !strHistoryFileName.isEmpty() )
+    // barrier: wait until all workers have finished their items, busy-wait a
+    // short time and go to sleep afterwards so that we do not burn the CPU
+    // core if a worker was preempted
+    for ( int i = 0; ( i < WORKER_POOL_SPIN_COUNT ) &&
+                     ( iNumWorkersDone.load ( std::memory_order_acquire ) < iNumWorkers ); i++ )
     {
-        Logging.EnableHistory ( strHistoryFileName );
+        CpuRelax();
     }
 
-    // enable logging (if requested)
-    if ( !strLoggingFileName.isEmpty() )
+    if ( iNumWorkersDone.load ( std::memory_order_acquire ) < iNumWorkers )
     {
-        // in case the history is enabled and a logging file name is
-        // given, parse the logging file for old entries which are then
-        // added in the history on software startup
-        if ( !strHistoryFileName.isEmpty() )
+        // note that the waiting flag must be set before checking the done
+        // counter again, otherwise we could miss the wake up of the last worker
+        MutexDone.lock();
         {
-            Logging.ParseLogFile ( strLoggingFileName );
-        }
+            bWaitingForWorkers.store ( true );
 
-        Logging.Start ( strLoggingFileName );
+            while ( iNumWorkersDone.load() < iNumWorkers )
+            {
+                DoneCondition.wait ( &MutexDone );
+            }
+
+            bWaitingForWorkers.store ( false );
+        }
+        MutexDone.unlock();
     }
+}
 
-    // HTML status file writing
-    if ( !strHTMLStatusFileName.isEmpty() )
+void CServerWorkerPool::ProcessItems ( const int iThreadIdx )
+{
+    const int iCurNumItems = iNumItems.load ( std::memory_order_relaxed );
+
+    // each thread grabs the next unprocessed item until all items are done
+    // which automatically balances the load between the threads
+    int iItem = iNextItem.fetch_add ( 1, std::memory_order_relaxed );
+
+    while ( iItem < iCurNumItems )
     {
-        QString strCurServerNameForHTMLStatusFile = strServerNameForHTMLStatusFile;
+        pServer->MixEncodeTransmitData ( iItem, iThreadIdx );
 
-        // if server name is empty, substitute a default name
-        if ( strCurServerNameForHTMLStatusFile.isEmpty() )
-        {
-            strCurServerNameForHTMLStatusFile = "[server address]";
-        }
+        iItem = iNextItem.fetch_add ( 1, std::memory_order_relaxed );
+    }
+}
 
-        // (the static cast to integer of the port number is required so that it
-        // works correctly under Linux)
-        StartStatusHTMLFileWriting ( strHTMLStatusFileName,
-            strCurServerNameForHTMLStatusFile + ":" +
-            QString().number( static_cast<int> ( iPortNumber ) ) );
+void CServerWorkerPool::WorkerLoop ( uint32_t  iLastGeneration,
+                                     const int iThreadIdx,
+                                     const int iCPUCore )
+{
+    if ( iCPUCore >= 0 )
+    {
+        CThreadUtil::SetCurrentThreadAffinity ( iCPUCore );
     }
 
-    // manage welcome message: if the welcome message is a valid link to a local
-    // file, the content of that file is used as the welcome message (#361)
-    strWelcomeMessage = strNewWelcomeMessage; // first copy text, may be overwritten
-    if ( QFileInfo ( strNewWelcomeMessage ).exists() )
+    if ( iRTPriority > 0 )
     {
-        QFile file ( strNewWelcomeMessage );
+        CThreadUtil::SetCurrentThreadRealTimePriority ( iRTPriority );
+    }
 
-        if ( file.open ( QIODevice::ReadOnly | QIODevice::Text ) )
+    while ( bRun )
+    {
+        // busy-wait a short time for the next tick to avoid the wake up
+        // latency of the operating system
+        for ( int i = 0; ( i < WORKER_POOL_SPIN_COUNT ) &&
+                         ( iGeneration.load ( std::memory_order_acquire ) == iLastGeneration ); i++ )
         {
-            // use entire file content for the welcome message
-            strWelcomeMessage = file.readAll();
+            CpuRelax();
         }
-    }
 
-    // restrict welcome message to maximum allowed length
-    strWelcomeMessage = strWelcomeMessage.left ( MAX_LEN_CHAT_TEXT );
+        if ( iGeneration.load ( std::memory_order_acquire ) == iLastGeneration )
+        {
+            // no new tick arrived, go to sleep (note that the sleeping counter
+            // must be incremented before checking the generation counter again,
+            // otherwise we could miss a wake up)
+            MutexWakeUp.lock();
+            {
+                iNumSleepingWorkers.fetch_add ( 1 );
 
-    // enable jam recording (if requested) - kicks off the thread (note
-    // that jam recorder needs the frame size which is given to the jam
-    // recorder in the SetRecordingDir() function)
-    SetRecordingDir ( strRecordingDirName );
+                while ( bRun && ( iGeneration.load() == iLastGeneration ) )
+                {
+                    WakeUpCondition.wait ( &MutexWakeUp );
+                }
 
-    // enable all channels (for the server all channel must be enabled the
-    // entire life time of the software)
-    for ( i = 0; i < iMaxNumChannels; i++ )
-    {
-        vecChannels[i].SetEnable ( true );
-    }
+                iNumSleepingWorkers.fetch_sub ( 1 );
+            }
+            MutexWakeUp.unlock();
+        }
 
+        if ( !bRun )
+        {
+            break;
+        }
 
-    // Connections -------------------------------------------------------------
-    // connect timer timeout signal
-    QObject::connect ( &HighPrecisionTimer, &CHighPrecisionTimer::timeout,
-        this, &CServer::OnTimer );
+        // the generation is only incremented after all workers have reported
+        // that they are done so we cannot miss a tick here
+        iLastGeneration = iGeneration.load ( std::memory_order_acquire );
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLMessReadyForSending,
-        this, &CServer::OnSendCLProtMessage );
+        ProcessItems ( iThreadIdx );
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLPingReceived,
-        this, &CServer::OnCLPingReceived );
+        iNumWorkersDone.fetch_add ( 1 );
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLPingWithNumClientsReceived,
-        this, &CServer::OnCLPingWithNumClientsReceived );
+        // wake up the calling thread of Process() if it went to sleep
+        if ( bWaitingForWorkers.load() )
+        {
+            MutexDone.lock();
+            {
+                DoneCondition.wakeAll();
+            }
+            MutexDone.unlock();
+        }
+    }
+}
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLRegisterServerReceived,
-        this, &CServer::OnCLRegisterServerReceived );
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLUnregisterServerReceived,
-        this, &CServer::OnCLUnregisterServerReceived );
+// CServerTickStats implementation *********************************************
+void CServerTickStats::Init ( const int iNewNumThreads )
+{
+    iNumThreads = iNewNumThreads;
+    vecHistograms.reset ( new CTimingHistogram[iNumThreads * TS_NUM_STAGES] );
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLReqServerList,
-        this, &CServer::OnCLReqServerList );
+    vecveciLastCounts.Init ( TS_NUM_STAGES );
+    veciLastSumNs.Init ( TS_NUM_STAGES, 0 );
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLRegisterServerResp,
-        this, &CServer::OnCLRegisterServerResp );
+    for ( int i = 0; i < TS_NUM_STAGES; i++ )
+    {
+        vecveciLastCounts[i].Init ( TIMING_HIST_NUM_BUCKETS, 0 );
+    }
+}
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLSendEmptyMes,
-        this, &CServer::OnCLSendEmptyMes );
+void CServerTickStats::GetSnapshot ( const ETickStage   eStage,
+                                     CVector<uint64_t>& veciSnapCounts,
+                                     uint64_t&          iSnapSumNs ) const
+{
+    veciSnapCounts.Init ( TIMING_HIST_NUM_BUCKETS, 0 );
+    iSnapSumNs = 0;
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLDisconnection,
-        this, &CServer::OnCLDisconnection );
+    for ( int i = 0; i < iNumThreads; i++ )
+    {
+        vecHistograms[i * TS_NUM_STAGES + eStage].AddTo ( veciSnapCounts, iSnapSumNs );
+    }
+}
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLReqVersionAndOS,
-        this, &CServer::OnCLReqVersionAndOS );
+QString CServerTickStats::GetReport ( const bool bSinceLastReport )
+{
+    QString strReport = QString ( "%1 %2 %3 %4 %5 %6 %7\n" ).
+        arg ( "stage", -12 ).arg ( "count", 10 ).arg ( "mean", 8 ).
+        arg ( "p50", 8 ).arg ( "p99", 8 ).arg ( "p99.9", 8 ).arg ( "max", 8 );
 
-    QObject::connect ( &ConnLessProtocol, &CProtocol::CLReqConnClientsList,
-        this, &CServer::OnCLReqConnClientsList );
+    for ( int iStage = 0; iStage < TS_NUM_STAGES; iStage++ )
+    {
+        CVector<uint64_t> veciCounts;
+        uint64_t          iSumNs;
 
-    QObject::connect ( &ServerListManager, &CServerListManager::SvrRegStatusChanged,
-        this, &CServer::SvrRegStatusChanged );
+        GetSnapshot ( static_cast<ETickStage> ( iStage ), veciCounts, iSumNs );
 
-    QObject::connect ( &JamController, &recorder::CJamController::RestartRecorder,
-        this, &CServer::RestartRecorder );
+        if ( bSinceLastReport )
+        {
+            // use the difference to the last report and store the new snapshot
+            const CVector<uint64_t> veciCurCounts ( veciCounts );
+            const uint64_t          iCurSumNs = iSumNs;
 
-    QObject::connect ( &JamController, &recorder::CJamController::StopRecorder,
-        this, &CServer::StopRecorder );
+            for ( int i = 0; i < TIMING_HIST_NUM_BUCKETS; i++ )
+            {
+                veciCounts[i] -= vecveciLastCounts[iStage][i];
+            }
 
-    QObject::connect ( &JamController, &recorder::CJamController::RecordingSessionStarted,
+            iSumNs -= veciLastSumNs[iStage];
+
+            vecveciLastCounts[iStage] = veciCurCounts;
+            veciLastSumNs[iStage]     = iCurSumNs;
+        }
+
+        const uint64_t iNumValues = CTimingHistogram::GetNumValues ( veciCounts );
+        const double   dMeanUs    = ( iNumValues > 0 ) ?
+            static_cast<double> ( iSumNs ) / iNumValues / 1000 : 0;
+
+        strReport += QString ( "%1 %2 %3 %4 %5 %6 %7\n" ).
+            arg ( GetStageName ( static_cast<ETickStage> ( iStage ) ), -12 ).
+            arg ( iNumValues, 10 ).
+            arg ( dMeanUs, 8, 'f', 1 ).
+            arg ( static_cast<double> ( CTimingHistogram::GetPercentile ( veciCounts, 50 ) ) / 1000, 8, 'f', 1 ).
+            arg ( static_cast<double> ( CTimingHistogram::GetPercentile ( veciCounts, 99 ) ) / 1000, 8, 'f', 1 ).
+            arg ( static_cast<double> ( CTimingHistogram::GetPercentile ( veciCounts, 99.9 ) ) / 1000, 8, 'f', 1 ).
+            arg ( static_cast<double> ( CTimingHistogram::GetPercentile ( veciCounts, 100 ) ) / 1000, 8, 'f', 1 );
+    }
+
+    return strReport;
+}
+
+QString CServerTickStats::GetStageName ( const ETickStage eStage )
+{
+    switch ( eStage )
+    {
+    case TS_TICK_LATENESS: return "lateness";
+    case TS_TICK:          return "tick";
+    case TS_CHAN_SCAN:     return "chanscan";
+    case TS_JITBUF_GET:    return "jitbufget";
+    case TS_DECODE:        return "decode";
+    case TS_LEVELS:        return "levels";
+    case TS_FULL_MIX:      return "fullmix";
+    case TS_MIX:           return "mix";
+    case TS_ENCODE:        return "encode";
+    case TS_SEND:          return "send";
+    case TS_SEND_FLUSH:    return "sendflush";
+    default:               return "";
+    }
+}
+
+
+// CServer implementation ******************************************************
+// Address to channel index ----------------------------------------------------
+void CChanAddrIndex::Init ( const int iMaxNumChannels )
+{
+    // use the smallest power of two number of slots which is at least twice
+    // the maximum number of channels
+    iNumBits = 1;
+
+    while ( ( 1 << iNumBits ) < 2 * iMaxNumChannels )
+    {
+        iNumBits++;
+    }
+
+    iMask = ( 1 << iNumBits ) - 1;
+
+    vecKeys.Init    ( 1 << iNumBits, 0 );
+    vecChanIDs.Init ( 1 << iNumBits, INVALID_CHANNEL_ID );
+}
+
+bool CChanAddrIndex::GetKey ( const CHostAddress& Addr,
+                              uint64_t&           iKey )
+{
+    if ( Addr.InetAddr.protocol() != QAbstractSocket::IPv4Protocol )
+    {
+        return false;
+    }
+
+    // IPv4 address and port, bit 48 is set so that a valid key is never zero
+    iKey = ( UINT64_C ( 1 ) << 48 ) |
+           ( static_cast<uint64_t> ( Addr.InetAddr.toIPv4Address() ) << 16 ) |
+           Addr.iPort;
+
+    return true;
+}
+
+int CChanAddrIndex::Find ( const uint64_t iKey ) const
+{
+    for ( int iSlot = GetHomeSlot ( iKey ); vecKeys[iSlot] != 0; iSlot = ( iSlot + 1 ) & iMask )
+    {
+        if ( vecKeys[iSlot] == iKey )
+        {
+            return vecChanIDs[iSlot];
+        }
+    }
+
+    return INVALID_CHANNEL_ID;
+}
+
+void CChanAddrIndex::Insert ( const uint64_t iKey,
+                              const int      iChanID )
+{
+    int iSlot = GetHomeSlot ( iKey );
+
+    // either overwrite the existing entry or use the first free slot
+    while ( ( vecKeys[iSlot] != 0 ) && ( vecKeys[iSlot] != iKey ) )
+    {
+        iSlot = ( iSlot + 1 ) & iMask;
+    }
+
+    vecKeys[iSlot]    = iKey;
+    vecChanIDs[iSlot] = iChanID;
+}
+
+void CChanAddrIndex::Remove ( const uint64_t iKey )
+{
+    int iSlot = GetHomeSlot ( iKey );
+
+    while ( vecKeys[iSlot] != iKey )
+    {
+        if ( vecKeys[iSlot] == 0 )
+        {
+            return; // key not found
+        }
+
+        iSlot = ( iSlot + 1 ) & iMask;
+    }
+
+    // backward shift deletion: move the following entries of the probe
+    // sequence into the gap so that no tombstones are required
+    int iNext = ( iSlot + 1 ) & iMask;
+
+    while ( vecKeys[iNext] != 0 )
+    {
+        // the entry can be moved if the gap lies between its home slot and
+        // its current position (cyclically)
+        const int iHome = GetHomeSlot ( vecKeys[iNext] );
+
+        if ( ( ( iNext - iHome ) & iMask ) >= ( ( iNext - iSlot ) & iMask ) )
+        {
+            vecKeys[iSlot]    = vecKeys[iNext];
+            vecChanIDs[iSlot] = vecChanIDs[iNext];
+            iSlot             = iNext;
+        }
+
+        iNext = ( iNext + 1 ) & iMask;
+    }
+
+    vecKeys[iSlot]    = 0;
+    vecChanIDs[iSlot] = INVALID_CHANNEL_ID;
+}
+
+
+// Opus codec pool -------------------------------------------------------------
+COpusCodecPool::COpusCodecPool()
+{
+    int iOpusError;
+
+    // the modes are shared by all codec states
+    OpusMode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
+                                         DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES,
+                                         &iOpusError );
+
+    Opus64Mode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
+                                           SYSTEM_FRAME_SIZE_SAMPLES,
+                                           &iOpusError );
+
+    for ( int i = 0; i < NUM_CODEC_TYPES; i++ )
+    {
+        iNumFree[i] = 0;
+    }
+}
+
+COpusCodecPool::~COpusCodecPool()
+{
+    // free all codec states (assigned, unused and released ones)
+    for ( int i = 0; i < vecpEncoders.Size(); i++ )
+    {
+        if ( vecpEncoders[i] != nullptr )
+        {
+            opus_custom_encoder_destroy ( vecpEncoders[i] );
+            opus_custom_decoder_destroy ( vecpDecoders[i] );
+        }
+    }
+
+    for ( int i = 0; i < NUM_CODEC_TYPES; i++ )
+    {
+        for ( int j = 0; j < iNumFree[i]; j++ )
+        {
+            opus_custom_encoder_destroy ( vecpFreeEncoders[i][j] );
+            opus_custom_decoder_destroy ( vecpFreeDecoders[i][j] );
+        }
+    }
+
+    for ( size_t i = 0; i < vecpReleasedEncoders.size(); i++ )
+    {
+        opus_custom_encoder_destroy ( vecpReleasedEncoders[i] );
+        opus_custom_decoder_destroy ( vecpReleasedDecoders[i] );
+    }
+
+    // free audio modes
+    opus_custom_mode_destroy ( OpusMode );
+    opus_custom_mode_destroy ( Opus64Mode );
+}
+
+void COpusCodecPool::Init ( const int iNewNumChannels )
+{
+    vecpEncoders.Init  ( iNewNumChannels, nullptr );
+    vecpDecoders.Init  ( iNewNumChannels, nullptr );
+    vecCodecTypes.Init ( iNewNumChannels, INVALID_INDEX );
+
+    // each channel holds at most one codec state, therefore the number of
+    // unused codec states of one type is limited by the number of channels
+    for ( int i = 0; i < NUM_CODEC_TYPES; i++ )
+    {
+        vecpFreeEncoders[i].Init ( iNewNumChannels, nullptr );
+        vecpFreeDecoders[i].Init ( iNewNumChannels, nullptr );
+    }
+
+    vecpReleasedEncoders.reserve  ( iNewNumChannels );
+    vecpReleasedDecoders.reserve  ( iNewNumChannels );
+    vecReleasedCodecTypes.reserve ( iNewNumChannels );
+}
+
+int COpusCodecPool::GetCodecType ( const EAudComprType eAudComprType,
+                                   const int           iNumAudioChannels )
+{
+    const int iStereoOffset = ( iNumAudioChannels == 1 ) ? 0 : 1;
+
+    if ( eAudComprType == CT_OPUS )
+    {
+        return iStereoOffset;
+    }
+    else if ( eAudComprType == CT_OPUS64 )
+    {
+        return 2 + iStereoOffset;
+    }
+
+    return INVALID_INDEX; // no codec state required
+}
+
+void COpusCodecPool::CreateCodec ( const int           iCodecType,
+                                   OpusCustomEncoder*& pEncoder,
+                                   OpusCustomDecoder*& pDecoder )
+{
+    int             iOpusError;
+    const bool      bIsOpus64         = ( iCodecType >= 2 );
+    const int       iNumAudioChannels = ( iCodecType % 2 ) + 1;
+    OpusCustomMode* CurMode           = bIsOpus64 ? Opus64Mode : OpusMode;
+
+    pEncoder = opus_custom_encoder_create ( CurMode, iNumAudioChannels, &iOpusError );
+    pDecoder = opus_custom_decoder_create ( CurMode, iNumAudioChannels, &iOpusError );
+
+    // we require a constant bit rate
+    opus_custom_encoder_ctl ( pEncoder, OPUS_SET_VBR ( 0 ) );
+
+    // we want as low delay as possible
+    opus_custom_encoder_ctl ( pEncoder, OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+    if ( bIsOpus64 )
+    {
+        // for 64 samples frame size we have to adjust the PLC behavior to avoid loud artifacts
+        opus_custom_encoder_ctl ( pEncoder, OPUS_SET_PACKET_LOSS_PERC ( 35 ) );
+    }
+    else
+    {
+        // set encoder low complexity for legacy 128 samples frame size
+        opus_custom_encoder_ctl ( pEncoder, OPUS_SET_COMPLEXITY ( 1 ) );
+    }
+}
+
+void COpusCodecPool::Assign ( const int           iChanID,
+                              const EAudComprType eAudComprType,
+                              const int           iNumAudioChannels )
+{
+    const int iCodecType = GetCodecType ( eAudComprType, iNumAudioChannels );
+
+    if ( iCodecType == vecCodecTypes[iChanID] )
+    {
+        return; // the channel already has the correct codec states
+    }
+
+    Release ( iChanID );
+
+    if ( iCodecType == INVALID_INDEX )
+    {
+        return;
+    }
+
+    if ( iNumFree[iCodecType] > 0 )
+    {
+        // reuse an unused codec state, it must not keep any state of the
+        // previous client
+        iNumFree[iCodecType]--;
+        vecpEncoders[iChanID] = vecpFreeEncoders[iCodecType][iNumFree[iCodecType]];
+        vecpDecoders[iChanID] = vecpFreeDecoders[iCodecType][iNumFree[iCodecType]];
+
+        opus_custom_encoder_ctl ( vecpEncoders[iChanID], OPUS_RESET_STATE );
+        opus_custom_decoder_ctl ( vecpDecoders[iChanID], OPUS_RESET_STATE );
+    }
+    else
+    {
+        CreateCodec ( iCodecType, vecpEncoders[iChanID], vecpDecoders[iChanID] );
+    }
+
+    vecCodecTypes[iChanID] = iCodecType;
+}
+
+void COpusCodecPool::Release ( const int iChanID )
+{
+    if ( vecCodecTypes[iChanID] != INVALID_INDEX )
+    {
+        vecpReleasedEncoders.push_back  ( vecpEncoders[iChanID] );
+        vecpReleasedDecoders.push_back  ( vecpDecoders[iChanID] );
+        vecReleasedCodecTypes.push_back ( vecCodecTypes[iChanID] );
+
+        vecpEncoders[iChanID]  = nullptr;
+        vecpDecoders[iChanID]  = nullptr;
+        vecCodecTypes[iChanID] = INVALID_INDEX;
+    }
+}
+
+void COpusCodecPool::Recycle()
+{
+    for ( size_t i = 0; i < vecReleasedCodecTypes.size(); i++ )
+    {
+        const int iCodecType = vecReleasedCodecTypes[i];
+
+        if ( iNumFree[iCodecType] < vecpFreeEncoders[iCodecType].Size() )
+        {
+            vecpFreeEncoders[iCodecType][iNumFree[iCodecType]] = vecpReleasedEncoders[i];
+            vecpFreeDecoders[iCodecType][iNumFree[iCodecType]] = vecpReleasedDecoders[i];
+            iNumFree[iCodecType]++;
+        }
+        else
+        {
+            // more unused codec states than channels, this can only happen if
+            // clients change their codec very often
+            opus_custom_encoder_destroy ( vecpReleasedEncoders[i] );
+            opus_custom_decoder_destroy ( vecpReleasedDecoders[i] );
+        }
+    }
+
+    // note that clear() keeps the allocated memory
+    vecpReleasedEncoders.clear();
+    vecpReleasedDecoders.clear();
+    vecReleasedCodecTypes.clear();
+}
+
+
+CServer::CServer ( const int                  iNewMaxNumChan,
+                   const int                  iMaxDaysHistory,
+                   const QString&             strLoggingFileName,
+                   const quint16              iPortNumber,
+                   const QString&             strHTMLStatusFileName,
+                   const QString&             strHistoryFileName,
+                   const QString&             strServerNameForHTMLStatusFile,
+                   const QString&             strCentralServer,
+                   const QString&             strServerInfo,
+                   const QString&             strNewWelcomeMessage,
+                   const QString&             strRecordingDirName,
+                   const bool                 bNCentServPingServerInList,
+                   const bool                 bNDisconnectAllClientsOnQuit,
+                   const bool                 bNUseDoubleSystemFrameSize,
+                   const bool                 bNUseMultithreading,
+                   const int                  iNumRecvSockets,
+                   const bool                 bUseIoUring,
+                   const CServerThreadConfig& ThreadConfig,
+                   const int                  iNTickStatsInterval,
+                   const QString&             strMetricsAddress,
+                   const ELicenceType         eNLicenceType ) :
+    vecWindowPosMain            (), // empty array
+    bUseDoubleSystemFrameSize   ( bNUseDoubleSystemFrameSize ),
+    vecChannels                 ( new CChannel[iNewMaxNumChan] ),
+    iMaxNumChannels             ( iNewMaxNumChan ),
+    iNumActiveClients           ( 0 ),
+    iNumMixGroups               ( 0 ),
+    iNumChannelLevelsSent       ( 0 ),
+    iNumSkippedChannelLevels    ( 0 ),
+    bNewChannelLevelsSubscriber ( false ),
+    bCurSendChannelLevels       ( false ),
+    WorkerPool                  ( this ),
+    Socket                      ( this, iPortNumber, 0, iNumRecvSockets > 1 ),
+    Logging                     ( iMaxDaysHistory ),
+    iFrameCount                 ( 0 ),
+    bWriteStatusHTMLFile        ( false ),
+    HighPrecisionTimer          ( bNUseDoubleSystemFrameSize ),
+    bStopRequested              ( false ),
+    iTickStatsInterval          ( iNTickStatsInterval ),
+    Metrics                     ( this ),
+    ServerListManager           ( iPortNumber,
+                                  strCentralServer,
+                                  strServerInfo,
+                                  iNewMaxNumChan,
+                                  bNCentServPingServerInList,
+                                  &ConnLessProtocol ),
+    bAutoRunMinimized           ( false ),
+    eLicenceType                ( eNLicenceType ),
+    bDisconnectAllClientsOnQuit ( bNDisconnectAllClientsOnQuit ),
+    pSignalHandler              ( CSignalHandler::getSingletonP() )
+{
+    int i;
+
+    // the Opus codec states are allocated on demand when a client sets its
+    // network transport properties, the conversion buffers are allocated for
+    // all channels
+    OpusCodecPool.Init             ( iMaxNumChannels );
+    vecpOpusEncoders.Init          ( iMaxNumChannels, nullptr );
+    DoubleFrameSizeConvBufIn.Init  ( iMaxNumChannels );
+    DoubleFrameSizeConvBufOut.Init ( iMaxNumChannels );
+
+    for ( i = 0; i < iMaxNumChannels; i++ )
+    {
+        // init double-to-normal frame size conversion buffers -----------------
+        // use worst case memory initialization to avoid allocating memory in
+        // the time-critical thread
+        DoubleFrameSizeConvBufIn[i].Init  ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        DoubleFrameSizeConvBufOut[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+    }
+
+    // define colors for chat window identifiers
+    vstrChatColors.Init ( 6 );
+    vstrChatColors[0] = "mediumblue";
+    vstrChatColors[1] = "red";
+    vstrChatColors[2] = "darkorchid";
+    vstrChatColors[3] = "green";
+    vstrChatColors[4] = "maroon";
+    vstrChatColors[5] = "coral";
+
+    // set the server frame size
+    if ( bUseDoubleSystemFrameSize )
+    {
+        iServerFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+    else
+    {
+        iServerFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+
+
+    // To avoid audio clitches, in the entire realtime timer audio processing
+    // routine including the ProcessData no memory must be allocated. Since we
+    // do not know the required sizes for the vectors, we allocate memory for
+    // the worst case here:
+
+    // allocate worst case memory for the temporary vectors
+    vecChanIDsCurConChan.Init          ( iMaxNumChannels );
+    vecvecdGains.Init                  ( iMaxNumChannels );
+    vecvecdPannings.Init               ( iMaxNumChannels );
+    vecvecfData.Init                   ( iMaxNumChannels );
+    vecvecsData.Init                   ( iMaxNumChannels );
+    vecfPeakLevels.Init                ( iMaxNumChannels );
+    vecActiveClients.Init              ( iMaxNumChannels );
+    vecvecfIntermProcBuf.Init          ( iMaxNumChannels );
+    vecvecfSendData.Init               ( iMaxNumChannels );
+    vecvecbyCodedData.Init             ( iMaxNumChannels );
+    vecNumAudioChannels.Init           ( iMaxNumChannels );
+    vecNumFrameSizeConvBlocks.Init     ( iMaxNumChannels );
+    vecUseDoubleSysFraSizeConvBuf.Init ( iMaxNumChannels );
+    vecAudioComprType.Init             ( iMaxNumChannels );
+    vecdFadeInGains.Init               ( iMaxNumChannels );
+    vecdCenterPannings.Init            ( iMaxNumChannels, 0.5 );
+    vecUseFullMix.Init                 ( iMaxNumChannels );
+    vecfFullMixMono.Init               ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+    vecfFullMixStereo.Init             ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+    vecNetwFrameSizes.Init             ( iMaxNumChannels );
+    vecMixSignatures.Init              ( iMaxNumChannels );
+    vecMixGroupLeaders.Init            ( iMaxNumChannels );
+    vecMixGroupLastMembers.Init        ( iMaxNumChannels );
+    vecMixGroupNextMembers.Init        ( iMaxNumChannels );
+    vecStreamSrcChanIDs.Init           ( iMaxNumChannels, INVALID_CHANNEL_ID );
+    vecpStreamSrcEncoders.Init         ( iMaxNumChannels, nullptr );
+    vecConChanIdx.Init                 ( iMaxNumChannels, INVALID_INDEX );
+    vecStreamSrcIdx.Init               ( iMaxNumChannels, INVALID_INDEX );
+    vecStreamSrcCnt.Init               ( iMaxNumChannels, 0 );
+    vecIsStreamSrc.Init                ( iMaxNumChannels, 0 );
+    vecChanAddrIndices.Init            ( iNumRecvSockets );
+    vecvecChanAddrKeys.Init            ( iNumRecvSockets );
+
+    // each channel sends at most two network packets per timer tick (if the
+    // frame size conversion blocks are used)
+    Socket.InitSendQueue ( 2 * iMaxNumChannels );
+
+    for ( i = 0; i < iNumRecvSockets; i++ )
+    {
+        vecChanAddrIndices[i].Init ( iMaxNumChannels );
+        vecvecChanAddrKeys[i].Init ( iMaxNumChannels, 0 );
+    }
+
+    vecChanAssignedAddrKeys.reset ( new std::atomic<uint64_t>[iMaxNumChannels] );
+
+    for ( i = 0; i < iMaxNumChannels; i++ )
+    {
+        vecChanAssignedAddrKeys[i].store ( 0 );
+    }
+
+    // additional receive sockets which share the port with the main socket,
+    // the kernel distributes the clients over all sockets so that the audio
+    // packets are put in the jitter buffers by multiple threads in parallel
+    for ( i = 1; i < iNumRecvSockets; i++ )
+    {
+        vecpAddRecSockets.Add ( new CHighPrioSocket ( this, iPortNumber, i, true ) );
+    }
+
+    // use the io_uring network engine if requested and supported by the kernel
+    if ( bUseIoUring )
+    {
+        bool bIoUringOK = Socket.EnableIoUring();
+
+        for ( i = 0; i < vecpAddRecSockets.Size(); i++ )
+        {
+            bIoUringOK = vecpAddRecSockets[i]->EnableIoUring() && bIoUringOK;
+        }
+
+        if ( !bIoUringOK )
+        {
+            qWarning() << "io_uring is not available, the standard socket functions are used";
+        }
+    }
+
+    for ( i = 0; i < iMaxNumChannels; i++ )
+    {
+        // init vectors storing information of all channels
+        vecvecdGains[i].Init    ( iMaxNumChannels );
+        vecvecdPannings[i].Init ( iMaxNumChannels );
+
+        // we always use stereo audio buffers (which is the worst case)
+        vecvecfData[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        vecvecsData[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+
+        // (note that we only allocate iMaxNumChannels buffers for the send
+        // and coded data because of the worker thread implementation)
+        vecvecfIntermProcBuf[i].Init ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+        vecvecfSendData[i].Init      ( 2 /* stereo */ * DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES /* worst case buffer size */ );
+
+        // allocate worst case memory for the coded data
+        vecvecbyCodedData[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
+    }
+
+    // allocate worst case memory for the channel levels
+    vecChannelLevels.Init ( iMaxNumChannels );
+    vecChannelLevelsSent.Init ( iMaxNumChannels );
+    vecChannelLevelsSentChanIDs.Init ( iMaxNumChannels, INVALID_CHANNEL_ID );
+
+    // start the worker threads for the mixing and encoding, the calling
+    // thread of the timer tick does the processing, too
+    if ( bNUseMultithreading )
+    {
+        // if CPU cores are given for the workers, we use one worker per core,
+        // otherwise the number of workers depends on the number of channels
+        // (the workers run at a high priority and busy-wait, we do not want to
+        // occupy all CPU cores of a shared host)
+        const int iNumWorkers = ( ThreadConfig.veciWorkerCPUCores.Size() > 0 ) ?
+            ThreadConfig.veciWorkerCPUCores.Size() :
+            std::min ( std::min ( iMaxNumChannels / WORKER_POOL_CHANNELS_PER_WORKER,
+                                  WORKER_POOL_MAX_DEFAULT_WORKERS ),
+                       CThreadUtil::GetNumCPUCores() - 1 );
+
+        WorkerPool.Start ( iNumWorkers,
+                           ThreadConfig.veciWorkerCPUCores,
+                           ThreadConfig.iRTPriority );
+    }
+
+    // timing statistics for the timer thread and all worker threads
+    TickStats.Init ( 1 + WorkerPool.GetNumWorkers() );
+
+    // enable history graph (if requested)
+    if ( !strHistoryFileName.isEmpty() )
+    {
+        Logging.EnableHistory ( strHistoryFileName );
+    }
+
+    // enable logging (if requested)
+    if ( !strLoggingFileName.isEmpty() )
+    {
+        // in case the history is enabled and a logging file name is
+        // given, parse the logging file for old entries which are then
+        // added in the history on software startup
+        if ( !strHistoryFileName.isEmpty() )
+        {
+            Logging.ParseLogFile ( strLoggingFileName );
+        }
+
+        Logging.Start ( strLoggingFileName );
+    }
+
+    // HTML status file writing
+    if ( !strHTMLStatusFileName.isEmpty() )
+    {
+        QString strCurServerNameForHTMLStatusFile = strServerNameForHTMLStatusFile;
+
+        // if server name is empty, substitute a default name
+        if ( strCurServerNameForHTMLStatusFile.isEmpty() )
+        {
+            strCurServerNameForHTMLStatusFile = "[server address]";
+        }
+
+        // (the static cast to integer of the port number is required so that it
+        // works correctly under Linux)
+        StartStatusHTMLFileWriting ( strHTMLStatusFileName,
+            strCurServerNameForHTMLStatusFile + ":" +
+            QString().number( static_cast<int> ( iPortNumber ) ) );
+    }
+
+    // metrics listener (if requested)
+    if ( !strMetricsAddress.isEmpty() && !Metrics.Start ( strMetricsAddress ) )
+    {
+        throw CGenErr ( "Cannot start the metrics listener on " +
+                        strMetricsAddress + ".", "Network Error" );
+    }
+
+    // manage welcome message: if the welcome message is a valid link to a local
+    // file, the content of that file is used as the welcome message (#361)
+    strWelcomeMessage = strNewWelcomeMessage; // first copy text, may be overwritten
+    if ( QFileInfo ( strNewWelcomeMessage ).exists() )
+    {
+        QFile file ( strNewWelcomeMessage );
+
+        if ( file.open ( QIODevice::ReadOnly | QIODevice::Text ) )
+        {
+            // use entire file content for the welcome message
+            strWelcomeMessage = file.readAll();
+        }
+    }
+
+    // restrict welcome message to maximum allowed length
+    strWelcomeMessage = strWelcomeMessage.left ( MAX_LEN_CHAT_TEXT );
+
+    // the formatted welcome message is sent to every new client, it is only
+    // encoded once
+    CProtocol::PrepareChatTextMes ( WelcomeMessageMess,
+        "<b>Server Welcome Message:</b> " + strWelcomeMessage );
+
+    // enable jam recording (if requested) - kicks off the thread (note
+    // that jam recorder needs the frame size which is given to the jam
+    // recorder in the SetRecordingDir() function)
+    SetRecordingDir ( strRecordingDirName );
+
+    // enable all channels (for the server all channel must be enabled the
+    // entire life time of the software)
+    for ( i = 0; i < iMaxNumChannels; i++ )
+    {
+        vecChannels[i].SetEnable ( true );
+    }
+
+
+    // optional CPU pinning and real-time scheduling of the timer thread which
+    // runs the server processing (if no separate priority is given, the
+    // priority of the other server threads is used)
+    HighPrecisionTimer.SetCPUCore ( ThreadConfig.iMixerCPUCore );
+    HighPrecisionTimer.SetRealTimePriority ( ( ThreadConfig.iMixerRTPriority > 0 ) ?
+                                             ThreadConfig.iMixerRTPriority : ThreadConfig.iRTPriority );
+
+
+    // Connections -------------------------------------------------------------
+    // connect timer timeout signal (except for the QTimer based Windows timer,
+    // the server processing runs directly in the high priority timer thread
+    // and not in the main event loop)
+#ifdef _WIN32
+    QObject::connect ( &HighPrecisionTimer, &CHighPrecisionTimer::timeout,
+        this, &CServer::OnTimer );
+#else
+    QObject::connect ( &HighPrecisionTimer, &CHighPrecisionTimer::timeout,
+        this, &CServer::OnTimer, Qt::DirectConnection );
+#endif
+
+    // the server processing must not block on the main thread, therefore these
+    // requests are processed in the main thread
+    QObject::connect ( this, &CServer::StopRequested,
+        this, &CServer::OnStopRequested, Qt::QueuedConnection );
+
+    QObject::connect ( this, &CServer::ChanListUpdateRequired,
+        this, &CServer::CreateAndSendChanListForAllConChannels, Qt::QueuedConnection );
+
+    QObject::connect ( &TimerCheckTimingStats, &QTimer::timeout,
+        this, &CServer::OnTimerCheckTimingStats );
+
+    QObject::connect ( &TimerTickStatsReport, &QTimer::timeout,
+        this, &CServer::OnTimerTickStatsReport );
+
+    if ( iTickStatsInterval > 0 )
+    {
+        TimerTickStatsReport.start ( iTickStatsInterval * 1000 );
+    }
+
+    // connection less messages are sent directly from the calling thread (the
+    // channel levels are sent by the server processing)
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLMessReadyForSending,
+        this, &CServer::OnSendCLProtMessage, Qt::DirectConnection );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLPingReceived,
+        this, &CServer::OnCLPingReceived );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLPingWithNumClientsReceived,
+        this, &CServer::OnCLPingWithNumClientsReceived );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLRegisterServerReceived,
+        this, &CServer::OnCLRegisterServerReceived );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLUnregisterServerReceived,
+        this, &CServer::OnCLUnregisterServerReceived );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLReqServerList,
+        this, &CServer::OnCLReqServerList );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLRegisterServerResp,
+        this, &CServer::OnCLRegisterServerResp );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLSendEmptyMes,
+        this, &CServer::OnCLSendEmptyMes );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLDisconnection,
+        this, &CServer::OnCLDisconnection );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLReqVersionAndOS,
+        this, &CServer::OnCLReqVersionAndOS );
+
+    QObject::connect ( &ConnLessProtocol, &CProtocol::CLReqConnClientsList,
+        this, &CServer::OnCLReqConnClientsList );
+
+    QObject::connect ( &ServerListManager, &CServerListManager::SvrRegStatusChanged,
+        this, &CServer::SvrRegStatusChanged );
+
+    QObject::connect ( &JamController, &recorder::CJamController::RestartRecorder,
+        this, &CServer::RestartRecorder );
+
+    QObject::connect ( &JamController, &recorder::CJamController::StopRecorder,
+        this, &CServer::StopRecorder );
+
+    QObject::connect ( &JamController, &recorder::CJamController::RecordingSessionStarted,
         this, &CServer::RecordingSessionStarted );
 
     QObject::connect ( &JamController, &recorder::CJamController::EndRecorderThread,
@@ -502,63 +1340,75 @@ CServer::CServer ( const int          iNewMaxNumChan,
     QObject::connect ( pSignalHandler, &CSignalHandler::HandledSignal,
         this, &CServer::OnHandledSignal );
 
-    connectChannelSignalsToServerSlots<MAX_NUM_CHANNELS>();
-
-    // start the socket (it is important to start the socket after all
-    // initializations and connections)
-    Socket.Start();
-}
+    for ( i = 0; i < iMaxNumChannels; i++ )
+    {
+        ConnectChannelSignals ( i );
+    }
 
-template<unsigned int slotId>
-inline void CServer::connectChannelSignalsToServerSlots()
-{
-    int iCurChanID = slotId - 1;
+    // the memory of the server (all buffers are allocated and initialized at
+    // this point) is locked so that the real-time threads do not suffer from
+    // page faults
+    if ( ThreadConfig.bLockMemory && !CThreadUtil::LockMemory() )
+    {
+        qWarning() << "the memory could not be locked (check the memlock limit)";
+    }
 
-    void ( CServer::* pOnSendProtMessCh )( CVector<uint8_t> ) =
-        &CServerSlots<slotId>::OnSendProtMessCh;
+    // start the sockets (it is important to start the sockets after all
+    // initializations and connections), the receive threads are pinned to the
+    // given CPU cores or, if requested and if we have enough CPU cores, to
+    // the last CPU cores
+    const int  iNumCPUCores = CThreadUtil::GetNumCPUCores();
+    const bool bPinThreads  = ThreadConfig.bPinRecvThreads && ( iNumRecvSockets <= iNumCPUCores );
 
-    void ( CServer::* pOnReqConnClientsListCh )() =
-        &CServerSlots<slotId>::OnReqConnClientsListCh;
+    for ( i = 0; i <= vecpAddRecSockets.Size(); i++ )
+    {
+        CHighPrioSocket* pCurSocket = ( i == 0 ) ? &Socket : vecpAddRecSockets[i - 1];
+        int              iCPUCore   = -1;
 
-    void ( CServer::* pOnChatTextReceivedCh )( QString ) =
-        &CServerSlots<slotId>::OnChatTextReceivedCh;
+        if ( ThreadConfig.veciRecvCPUCores.Size() > 0 )
+        {
+            iCPUCore = ThreadConfig.veciRecvCPUCores[i % ThreadConfig.veciRecvCPUCores.Size()];
+        }
+        else if ( bPinThreads )
+        {
+            iCPUCore = iNumCPUCores - 1 - i;
+        }
 
-    void ( CServer::* pOnMuteStateHasChangedCh )( int, bool ) =
-        &CServerSlots<slotId>::OnMuteStateHasChangedCh;
+        pCurSocket->Start ( iCPUCore, ThreadConfig.iRTPriority );
+    }
+}
 
-    void ( CServer::* pOnServerAutoSockBufSizeChangeCh )( int ) =
-        &CServerSlots<slotId>::OnServerAutoSockBufSizeChangeCh;
+void CServer::ConnectChannelSignals ( const int iChanID )
+{
+    // the channel ID is captured by the lambda functions so that the number
+    // of channels is not limited by a compile time constant
+    CChannel* pChannel = &vecChannels[iChanID];
 
     // send message
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::MessReadyForSending,
-                       this, pOnSendProtMessCh );
+    QObject::connect ( pChannel, &CChannel::MessReadyForSending,
+                       this, [this, iChanID] ( CVector<uint8_t> mess ) { SendProtMessage ( iChanID, mess ); } );
 
     // request connected clients list
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ReqConnClientsList,
-                       this, pOnReqConnClientsListCh );
+    QObject::connect ( pChannel, &CChannel::ReqConnClientsList,
+                       this, [this, iChanID]() { CreateAndSendChanListForThisChan ( iChanID ); } );
 
     // channel info has changed
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ChanInfoHasChanged,
+    QObject::connect ( pChannel, &CChannel::ChanInfoHasChanged,
                        this, &CServer::CreateAndSendChanListForAllConChannels );
 
     // chat text received
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ChatTextReceived,
-                       this, pOnChatTextReceivedCh );
+    QObject::connect ( pChannel, &CChannel::ChatTextReceived,
+                       this, [this, iChanID] ( QString strChatText ) { CreateAndSendChatTextForAllConChannels ( iChanID, strChatText ); } );
 
     // other mute state has changed
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::MuteStateHasChanged,
-                       this, pOnMuteStateHasChangedCh );
+    QObject::connect ( pChannel, &CChannel::MuteStateHasChanged,
+                       this, [this, iChanID] ( int iOtherChanID, bool bIsMuted ) { CreateOtherMuteStateChanged ( iChanID, iOtherChanID, bIsMuted ); } );
 
     // auto socket buffer size change
-    QObject::connect ( &vecChannels[iCurChanID], &CChannel::ServerAutoSockBufSizeChange,
-                       this, pOnServerAutoSockBufSizeChangeCh );
-
-    connectChannelSignalsToServerSlots<slotId - 1>();
+    QObject::connect ( pChannel, &CChannel::ServerAutoSockBufSizeChange,
+                       this, [this, iChanID] ( int iNNumFra ) { CreateAndSendJitBufMessage ( iChanID, iNNumFra ); } );
 }
 
-template<>
-inline void CServer::connectChannelSignalsToServerSlots<0>() {}
-
 void CServer::CreateAndSendJitBufMessage ( const int iCurChanID,
                                            const int iNNumFra )
 {
@@ -567,21 +1417,17 @@ void CServer::CreateAndSendJitBufMessage ( const int iCurChanID,
 
 CServer::~CServer()
 {
-    for ( int i = 0; i < iMaxNumChannels; i++ )
-    {
-        // free audio encoders and decoders
-        opus_custom_encoder_destroy ( OpusEncoderMono[i] );
-        opus_custom_decoder_destroy ( OpusDecoderMono[i] );
-        opus_custom_encoder_destroy ( OpusEncoderStereo[i] );
-        opus_custom_decoder_destroy ( OpusDecoderStereo[i] );
-        opus_custom_encoder_destroy ( Opus64EncoderMono[i] );
-        opus_custom_decoder_destroy ( Opus64DecoderMono[i] );
-        opus_custom_encoder_destroy ( Opus64EncoderStereo[i] );
-        opus_custom_decoder_destroy ( Opus64DecoderStereo[i] );
+    // the server processing runs in the timer thread, stop it first
+    HighPrecisionTimer.Stop();
 
-        // free audio modes
-        opus_custom_mode_destroy ( OpusMode[i] );
-        opus_custom_mode_destroy ( Opus64Mode[i] );
+    // stop the worker threads before freeing any resources they may use (the
+    // codec states are freed by the codec pool)
+    WorkerPool.Stop();
+
+    // stop the additional receive threads before the channels are freed
+    for ( int i = 0; i < vecpAddRecSockets.Size(); i++ )
+    {
+        delete vecpAddRecSockets[i];
     }
 }
 
@@ -631,12 +1477,9 @@ void CServer::OnNewConnection ( int          iChID,
     // send welcome message (if enabled)
     if ( !strWelcomeMessage.isEmpty() )
     {
-        // create formatted server welcome message and send it just to
-        // the client which just connected to the server
-        const QString strWelcomeMessageFormated =
-            "<b>Server Welcome Message:</b> " + strWelcomeMessage;
-
-        vecChannels[iChID].CreateChatTextMes ( strWelcomeMessageFormated );
+        // send the formatted server welcome message just to the client which
+        // just connected to the server
+        vecChannels[iChID].SendPreparedMes ( WelcomeMessageMess );
     }
 
     // send licence request message (if enabled)
@@ -715,6 +1558,12 @@ void CServer::OnAboutToQuit()
 
     Stop();
 
+    // dump the tick statistics of the complete run time
+    if ( iTickStatsInterval > 0 )
+    {
+        PrintTickStatsReport ( "since the start of the server", TickStats.GetReport ( false ) );
+    }
+
     // if server was registered at the central server, unregister on shutdown
     if ( GetServerListEnabled() )
     {
@@ -762,7 +1611,9 @@ void CServer::Start()
     if ( !IsRunning() )
     {
         // start timer
+        bStopRequested = false;
         HighPrecisionTimer.Start();
+        TimerCheckTimingStats.start ( TIMER_STATS_CHECK_INTERVAL_MS );
 
         // emit start signal
         emit Started();
@@ -779,20 +1630,81 @@ void CServer::Stop()
     {
         // stop timer
         HighPrecisionTimer.Stop();
+        TimerCheckTimingStats.stop();
+
+        // logging (add "server stopped" logging entry)
+        Logging.AddServerStopped();
+
+        // emit stopped signal
+        emit Stopped();
+    }
+}
+
+void CServer::OnStopRequested()
+{
+    bStopRequested = false;
+
+    // a client may have connected in the meantime
+    if ( GetNumberOfConnectedClients() == 0 )
+    {
+        Stop();
+    }
+}
+
+void CServer::OnTimerCheckTimingStats()
+{
+    int    iNumMissedDeadlines;
+    int    iNumResyncs;
+    double dMaxLatenessMs;
+
+    HighPrecisionTimer.GetAndResetTimingStats ( iNumMissedDeadlines,
+                                                iNumResyncs,
+                                                dMaxLatenessMs );
+
+    if ( iNumMissedDeadlines > 0 )
+    {
+        qWarning() << "server timer missed" << iNumMissedDeadlines << "deadlines (" <<
+            iNumResyncs << "restarts of the tick schedule ), max. wake-up lateness:" <<
+            dMaxLatenessMs << "ms";
+    }
+}
+
+void CServer::OnTimerTickStatsReport()
+{
+    // the interval report is only shown if the server processing runs (note
+    // that the snapshots are updated anyway)
+    const QString strReport = TickStats.GetReport ( true );
+
+    if ( IsRunning() )
+    {
+        PrintTickStatsReport ( QString ( "of the last %1 s" ).arg ( iTickStatsInterval ), strReport );
+    }
+}
 
-        // logging (add "server stopped" logging entry)
-        Logging.AddServerStopped();
+void CServer::PrintTickStatsReport ( const QString& strPeriod,
+                                     const QString& strReport )
+{
+    static QTextStream& tsConsole = *( ( new ConsoleWriterFactory() )->get() );
 
-        // emit stopped signal
-        emit Stopped();
-    }
+    tsConsole << "Server tick statistics " << strPeriod << " [us]:" << endl <<
+        strReport << endl;
 }
 
 void CServer::OnTimer()
 {
-/*
-static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure(); // TEST do a timer jitter measurement
-*/
+    // timing statistics of the tick (the tick runs in the thread with index 0)
+    const int64_t iTickStartNs  = CTimingHistogram::GetTimeNs();
+    const int64_t iTickLateness = HighPrecisionTimer.GetCurTickLatenessNs();
+    int64_t       iStageStartNs = iTickStartNs;
+    int64_t       iStageEndNs;
+    int64_t       iJitBufGetNs  = 0;
+    int64_t       iDecodeNs     = 0;
+
+    if ( iTickLateness >= 0 )
+    {
+        TickStats.Add ( 0, CServerTickStats::TS_TICK_LATENESS, iTickLateness );
+    }
+
     // Get data from all connected clients -------------------------------------
     // some inits
     int  iUnused;
@@ -805,6 +1717,9 @@ static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure(); // TE
     // afterwards!
     Mutex.lock();
     {
+        // the codec states released in the last tick are not in use anymore
+        OpusCodecPool.Recycle();
+
         // first, get number and IDs of connected channels
         for ( int i = 0; i < iMaxNumChannels; i++ )
         {
@@ -815,10 +1730,18 @@ static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure(); // TE
                 // connected clients is less, only a subset of elements of this
                 // vector are actually used and the others are dummy elements)
                 vecChanIDsCurConChan[iNumClients] = i;
+
+                // get the audio fade-in gain once per channel (it is applied
+                // in the mix of all clients)
+                vecdFadeInGains[iNumClients] = vecChannels[i].GetFadeInGain();
+
                 iNumClients++;
             }
         }
 
+        iStageEndNs = CTimingHistogram::GetTimeNs();
+        TickStats.Add ( 0, CServerTickStats::TS_CHAN_SCAN, iStageEndNs - iStageStartNs );
+
         // process connected channels
         for ( int i = 0; i < iNumClients; i++ )
         {
@@ -852,39 +1775,25 @@ static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure(); // TE
                 DoubleFrameSizeConvBufOut[iCurChanID].SetBufferSize ( DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES  * vecNumAudioChannels[i] );
             }
 
-            // select the opus decoder and raw audio frame length
+            // select the raw audio frame length
             if ( vecAudioComprType[i] == CT_OPUS )
             {
                 iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
-
-                if ( vecNumAudioChannels[i] == 1 )
-                {
-                    CurOpusDecoder = OpusDecoderMono[iCurChanID];
-                }
-                else
-                {
-                    CurOpusDecoder = OpusDecoderStereo[iCurChanID];
-                }
             }
             else if ( vecAudioComprType[i] == CT_OPUS64 )
             {
                 iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
-
-                if ( vecNumAudioChannels[i] == 1 )
-                {
-                    CurOpusDecoder = Opus64DecoderMono[iCurChanID];
-                }
-                else
-                {
-                    CurOpusDecoder = Opus64DecoderStereo[iCurChanID];
-                }
-            }
-            else
-            {
-                CurOpusDecoder = nullptr;
             }
 
+            // get the opus decoder and encoder which are assigned to the
+            // channel for its current codec (no codec is assigned if the
+            // network transport properties are not yet known)
+            CurOpusDecoder      = OpusCodecPool.GetDecoder ( iCurChanID );
+            vecpOpusEncoders[i] = OpusCodecPool.GetEncoder ( iCurChanID );
+
             // get gains of all connected channels
+            bool bHasDefaultMix = true;
+
             for ( int j = 0; j < iNumClients; j++ )
             {
                 // The second index of "vecvecdGains" does not represent
@@ -893,40 +1802,68 @@ static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure(); // TE
                 // connected channels
                 vecvecdGains[i][j] = vecChannels[iCurChanID].GetGain ( vecChanIDsCurConChan[j] );
 
-                // consider audio fade-in
-                vecvecdGains[i][j] *= vecChannels[vecChanIDsCurConChan[j]].GetFadeInGain();
-
                 // panning
                 vecvecdPannings[i][j] = vecChannels[iCurChanID].GetPan ( vecChanIDsCurConChan[j] );
+
+                // check if the fader of the other client is at its default
+                // position (for a mono mix the panning is not relevant)
+                if ( ( j != i ) &&
+                     ( ( vecvecdGains[i][j] != 1.0 ) ||
+                       ( ( vecNumAudioChannels[i] == 2 ) && ( vecvecdPannings[i][j] != 0.5 ) ) ) )
+                {
+                    bHasDefaultMix = false;
+                }
+
+                // consider audio fade-in
+                vecvecdGains[i][j] *= vecdFadeInGains[j];
             }
 
+            vecUseFullMix[i] = bHasDefaultMix;
+
             // flag for updating channel levels (if at least one clients wants it)
             if ( vecChannels[iCurChanID].ChannelLevelsRequired() )
             {
                 bUpdateChannelLevels = true;
             }
 
+            // a client which just opted in must get the next level update even
+            // if the levels did not change
+            if ( vecChannels[iCurChanID].GetAndResetNewLevelsSubscriber() )
+            {
+                bNewChannelLevelsSubscriber = true;
+            }
+
             // If the server frame size is smaller than the received OPUS frame size, we need a conversion
             // buffer which stores the large buffer.
             // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
             // is false and the Get() function is not called at all. Therefore if the buffer is not needed
             // we do not spend any time in the function but go directly inside the if condition.
             if ( ( vecUseDoubleSysFraSizeConvBuf[i] == 0 ) ||
-                 !DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecsData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] ) )
+                 !DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecfData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] ) )
             {
                 // get current number of OPUS coded bytes
                 const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetNetwFrameSize();
 
                 for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[i]; iB++ )
                 {
+                    iStageStartNs = CTimingHistogram::GetTimeNs();
+
                     // get data
                     const EGetDataStat eGetStat = vecChannels[iCurChanID].GetData ( vecvecbyCodedData[i], iCeltNumCodedBytes );
 
+                    iStageEndNs   = CTimingHistogram::GetTimeNs();
+                    iJitBufGetNs += iStageEndNs - iStageStartNs;
+
                     // if channel was just disconnected, set flag that connected
                     // client list is sent to all other clients
                     // and emit the client disconnected signal
                     if ( eGetStat == GS_CHAN_NOW_DISCONNECTED )
                     {
+                        // return the codec states to the pool (they are still
+                        // used in this tick, the pool reuses them not before
+                        // the next tick)
+                        OpusCodecPool.Release ( iCurChanID );
+
                         if ( JamController.GetRecordingEnabled() )
                         {
                             emit ClientDisconnected ( iCurChanID ); // TODO do this outside the mutex lock?
@@ -946,32 +1883,43 @@ static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure(); // TE
                         pCurCodedData = nullptr;
                     }
 
-                    // OPUS decode received data stream
+                    // OPUS decode received data stream (the float API directly
+                    // delivers the samples for the float mixing bus)
                     if ( CurOpusDecoder != nullptr )
                     {
-                        iUnused = opus_custom_decode ( CurOpusDecoder,
-                                                       pCurCodedData,
-                                                       iCeltNumCodedBytes,
-                                                       &vecvecsData[i][iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i]],
-                                                       iClientFrameSizeSamples );
+                        iUnused = opus_custom_decode_float ( CurOpusDecoder,
+                                                             pCurCodedData,
+                                                             iCeltNumCodedBytes,
+                                                             &vecvecfData[i][iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i]],
+                                                             iClientFrameSizeSamples );
                     }
+
+                    iDecodeNs += CTimingHistogram::GetTimeNs() - iStageEndNs;
                 }
 
                 // a new large frame is ready, if the conversion buffer is required, put it in the buffer
                 // and read out the small frame size immediately for further processing
                 if ( vecUseDoubleSysFraSizeConvBuf[i] != 0 )
                 {
-                    DoubleFrameSizeConvBufIn[iCurChanID].PutAll ( vecvecsData[i] );
-                    DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecsData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] );
+                    DoubleFrameSizeConvBufIn[iCurChanID].PutAll ( vecvecfData[i] );
+                    DoubleFrameSizeConvBufIn[iCurChanID].Get ( vecvecfData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] );
                 }
             }
+
+            // get the peak of the decoded frame while it is still in the cache, it
+            // is used for the silence detection and the level meter
+            vecfPeakLevels[i] = CMixKernels::GetPeak ( vecvecfData[i].data(),
+                                                       iServerFrameSizeSamples * vecNumAudioChannels[i] );
+
+            vecChannels[iCurChanID].UpdateLevelPeak ( vecfPeakLevels[i] );
         }
 
         // a channel is now disconnected, take action on it
         if ( bChannelIsNowDisconnected )
         {
-            // update channel list for all currently connected clients
-            CreateAndSendChanListForAllConChannels();
+            // update channel list for all currently connected clients (the
+            // protocol messages are created in the main thread)
+            emit ChanListUpdateRequired();
         }
     }
     Mutex.unlock(); // release mutex
@@ -982,286 +1930,718 @@ static CTimingMeas JitterMeas ( 1000, "test2.dat" ); JitterMeas.Measure(); // TE
     // one client is connected.
     if ( iNumClients > 0 )
     {
+        TickStats.Add ( 0, CServerTickStats::TS_JITBUF_GET, iJitBufGetNs );
+        TickStats.Add ( 0, CServerTickStats::TS_DECODE, iDecodeNs );
+
         // calculate levels for all connected clients
         if ( bUpdateChannelLevels )
         {
-            bSendChannelLevels = CreateLevelsForAllConChannels ( iNumClients,
-                                                                 vecNumAudioChannels,
-                                                                 vecvecsData,
-                                                                 vecChannelLevels );
+            iStageStartNs = CTimingHistogram::GetTimeNs();
+
+            bSendChannelLevels = CreateLevelsForAllConChannels ( iNumClients,
+                                                                 vecChannelLevels );
+
+            // the same message is sent to all clients which requested the levels
+            if ( bSendChannelLevels )
+            {
+                CProtocol::PrepareCLChannelLevelListMes ( ChannelLevelListMess,
+                                                          vecChannelLevels,
+                                                          iNumClients );
+            }
+
+            TickStats.Add ( 0, CServerTickStats::TS_LEVELS, CTimingHistogram::GetTimeNs() - iStageStartNs );
+        }
+
+        // Channels which are digitally silent (e.g. musicians who are resting)
+        // do not contribute to any mix. Only the active channels are mixed.
+        iNumActiveClients = 0;
+
+        for ( int i = 0; i < iNumClients; i++ )
+        {
+            if ( vecfPeakLevels[i] >= MIX_SILENCE_THRESHOLD )
+            {
+                vecActiveClients[iNumActiveClients] = i;
+                iNumActiveClients++;
+            }
+        }
+
+        // Most clients do not change their faders so that they get the same
+        // mix of all clients. For these clients we calculate the mix of all
+        // clients only once and only correct the own signal afterwards. This
+        // is only worth it if at least two clients can use the same mix.
+        // Note that only the group leaders actually calculate a mix.
+        CreateMixGroups ( iNumClients );
+
+        int iNumFullMixMono   = 0;
+        int iNumFullMixStereo = 0;
+
+        for ( int iG = 0; iG < iNumMixGroups; iG++ )
+        {
+            const int i = vecMixGroupLeaders[iG];
+
+            if ( vecUseFullMix[i] != 0 )
+            {
+                if ( vecNumAudioChannels[i] == 1 )
+                {
+                    iNumFullMixMono++;
+                }
+                else
+                {
+                    iNumFullMixStereo++;
+                }
+            }
+        }
+
+        for ( int iG = 0; iG < iNumMixGroups; iG++ )
+        {
+            const int i = vecMixGroupLeaders[iG];
+
+            if ( ( vecNumAudioChannels[i] == 1 ) ? ( iNumFullMixMono < 2 ) : ( iNumFullMixStereo < 2 ) )
+            {
+                vecUseFullMix[i] = false;
+            }
+        }
+
+        iStageStartNs = CTimingHistogram::GetTimeNs();
+
+        if ( iNumFullMixMono >= 2 )
+        {
+            MixData ( vecvecfData,
+                      vecdFadeInGains,
+                      vecdCenterPannings,
+                      vecNumAudioChannels,
+                      vecfFullMixMono,
+                      1,
+                      vecActiveClients,
+                      iNumActiveClients );
+        }
+
+        if ( iNumFullMixStereo >= 2 )
+        {
+            MixData ( vecvecfData,
+                      vecdFadeInGains,
+                      vecdCenterPannings,
+                      vecNumAudioChannels,
+                      vecfFullMixStereo,
+                      2,
+                      vecActiveClients,
+                      iNumActiveClients );
+        }
+
+        if ( ( iNumFullMixMono >= 2 ) || ( iNumFullMixStereo >= 2 ) )
+        {
+            TickStats.Add ( 0, CServerTickStats::TS_FULL_MIX, CTimingHistogram::GetTimeNs() - iStageStartNs );
+        }
+
+        // mix, encode and transmit the data for each group of clients with
+        // identical mixes (if multithreading is enabled, the groups are
+        // distributed over the worker threads)
+        bCurSendChannelLevels = bSendChannelLevels;
+
+        WorkerPool.Process ( iNumMixGroups );
+
+        // send all audio packets of this tick with one system call
+        iStageStartNs = CTimingHistogram::GetTimeNs();
+
+        Socket.FlushSendQueue();
+
+        iStageEndNs = CTimingHistogram::GetTimeNs();
+        TickStats.Add ( 0, CServerTickStats::TS_SEND_FLUSH, iStageEndNs - iStageStartNs );
+        TickStats.Add ( 0, CServerTickStats::TS_TICK, iStageEndNs - iTickStartNs );
+    }
+    else
+    {
+        // Disable server if no clients are connected. In this case the server
+        // does not consume any significant CPU when no client is connected.
+        // The timer thread cannot stop itself, the main thread stops it.
+        if ( !bStopRequested.exchange ( true ) )
+        {
+            emit StopRequested();
+        }
+    }
+
+    Q_UNUSED ( iUnused )
+}
+
+static inline uint64_t CalcMixSignature ( uint64_t     iSignature,
+                                          const double dValue )
+{
+    // FNV-1a hash over the bit pattern of the value
+    uint64_t iValueBits;
+    memcpy ( &iValueBits, &dValue, sizeof ( iValueBits ) );
+
+    for ( int iByte = 0; iByte < 8; iByte++ )
+    {
+        iSignature ^= ( iValueBits >> ( 8 * iByte ) ) & 0xFF;
+        iSignature *= 1099511628211ULL;
+    }
+
+    return iSignature;
+}
+
+void CServer::CreateMixGroups ( const int iNumClients )
+{
+    iNumMixGroups = 0;
+
+    for ( int i = 0; i < iNumClients; i++ )
+    {
+        const int iCurChanID = vecChanIDsCurConChan[i];
+
+        vecNetwFrameSizes[i]      = vecChannels[iCurChanID].GetNetwFrameSize();
+        vecMixGroupNextMembers[i] = INVALID_INDEX;
+
+        // Clients which use the frame size conversion buffer cannot share the
+        // encoded data since the conversion buffer has a state per client.
+        // The panning is only relevant for stereo mixes.
+        if ( vecUseDoubleSysFraSizeConvBuf[i] == 0 )
+        {
+            uint64_t iSignature = 14695981039346656037ULL;
+
+            iSignature = CalcMixSignature ( iSignature, vecAudioComprType[i] );
+            iSignature = CalcMixSignature ( iSignature, vecNumAudioChannels[i] );
+            iSignature = CalcMixSignature ( iSignature, vecNetwFrameSizes[i] );
+
+            for ( int j = 0; j < iNumClients; j++ )
+            {
+                iSignature = CalcMixSignature ( iSignature, vecvecdGains[i][j] );
+
+                if ( vecNumAudioChannels[i] == 2 )
+                {
+                    iSignature = CalcMixSignature ( iSignature, vecvecdPannings[i][j] );
+                }
+            }
+
+            vecMixSignatures[i] = iSignature;
+
+            // search for an existing group with an identical mix
+            int iGroup = INVALID_INDEX;
+
+            for ( int iG = 0; ( iG < iNumMixGroups ) && ( iGroup == INVALID_INDEX ); iG++ )
+            {
+                const int iLeader = vecMixGroupLeaders[iG];
+
+                if ( ( vecMixSignatures[iLeader]              == iSignature ) &&
+                     ( vecUseDoubleSysFraSizeConvBuf[iLeader] == 0 ) &&
+                     ( vecAudioComprType[iLeader]             == vecAudioComprType[i] ) &&
+                     ( vecNumAudioChannels[iLeader]           == vecNumAudioChannels[i] ) &&
+                     ( vecNetwFrameSizes[iLeader]             == vecNetwFrameSizes[i] ) )
+                {
+                    bool bIsSameMix = true;
+
+                    for ( int j = 0; ( j < iNumClients ) && bIsSameMix; j++ )
+                    {
+                        bIsSameMix = ( vecvecdGains[iLeader][j] == vecvecdGains[i][j] ) &&
+                                     ( ( vecNumAudioChannels[i] == 1 ) ||
+                                       ( vecvecdPannings[iLeader][j] == vecvecdPannings[i][j] ) );
+                    }
+
+                    if ( bIsSameMix )
+                    {
+                        iGroup = iG;
+                    }
+                }
+            }
+
+            if ( iGroup != INVALID_INDEX )
+            {
+                // append the client to the member list of the group
+                vecMixGroupNextMembers[vecMixGroupLastMembers[iGroup]] = i;
+                vecMixGroupLastMembers[iGroup]                         = i;
+                continue;
+            }
+        }
+
+        // the client is the leader of a new group
+        vecMixGroupLeaders[iNumMixGroups]     = i;
+        vecMixGroupLastMembers[iNumMixGroups] = i;
+        iNumMixGroups++;
+    }
+
+    AssignMixGroupStreams ( iNumClients );
+}
+
+void CServer::AssignMixGroupStreams ( const int iNumClients )
+{
+    // All members of a group receive the packets of the encoder of the group
+    // leader. A client must not be switched to the stream of another encoder
+    // just because the groups changed since the decoder would then get a
+    // stream which does not match its state. Therefore the leader is chosen
+    // so that most members continue their stream of the last tick. A stream
+    // is only switched if its source left the group (or disconnected).
+
+    // map the channel IDs to the client indices of the current tick
+    vecConChanIdx.Reset ( INVALID_INDEX );
+
+    for ( int i = 0; i < iNumClients; i++ )
+    {
+        vecConChanIdx[vecChanIDsCurConChan[i]] = i;
+        vecIsStreamSrc[i]                      = 0;
+    }
+
+    // find the stream source of each client, the source is only valid if its
+    // channel is still connected and still uses the same encoder
+    for ( int i = 0; i < iNumClients; i++ )
+    {
+        const int iCurChanID = vecChanIDsCurConChan[i];
+        const int iSrcChanID = vecStreamSrcChanIDs[iCurChanID];
+
+        vecStreamSrcIdx[i] = INVALID_INDEX;
+
+        if ( iSrcChanID != INVALID_CHANNEL_ID )
+        {
+            const int iSrcIdx = vecConChanIdx[iSrcChanID];
+
+            if ( ( iSrcIdx != INVALID_INDEX ) &&
+                 ( vecpOpusEncoders[iSrcIdx] != nullptr ) &&
+                 ( vecpOpusEncoders[iSrcIdx] == vecpStreamSrcEncoders[iCurChanID] ) )
+            {
+                vecStreamSrcIdx[i]      = iSrcIdx;
+                vecIsStreamSrc[iSrcIdx] = 1;
+            }
+        }
+    }
+
+    for ( int iG = 0; iG < iNumMixGroups; iG++ )
+    {
+        const int iFirstMember = vecMixGroupLeaders[iG];
+        int       iSrcIdx      = INVALID_INDEX;
+        int       iMaxSrcCnt   = 0;
+
+        // the stream which most members received in the last tick is continued
+        for ( int iMember = iFirstMember; iMember != INVALID_INDEX; iMember = vecMixGroupNextMembers[iMember] )
+        {
+            const int iCurSrcIdx = vecStreamSrcIdx[iMember];
+
+            if ( iCurSrcIdx != INVALID_INDEX )
+            {
+                vecStreamSrcCnt[iCurSrcIdx]++;
+
+                if ( vecStreamSrcCnt[iCurSrcIdx] > iMaxSrcCnt )
+                {
+                    iMaxSrcCnt = vecStreamSrcCnt[iCurSrcIdx];
+                    iSrcIdx    = iCurSrcIdx;
+                }
+            }
+        }
+
+        for ( int iMember = iFirstMember; iMember != INVALID_INDEX; iMember = vecMixGroupNextMembers[iMember] )
+        {
+            if ( vecStreamSrcIdx[iMember] != INVALID_INDEX )
+            {
+                vecStreamSrcCnt[vecStreamSrcIdx[iMember]] = 0;
+            }
+        }
+
+        int iLeader = INVALID_INDEX;
+
+        if ( iSrcIdx != INVALID_INDEX )
+        {
+            // if the source is a member of the group, it simply keeps encoding
+            for ( int iMember = iFirstMember; ( iMember != INVALID_INDEX ) && ( iLeader == INVALID_INDEX ); iMember = vecMixGroupNextMembers[iMember] )
+            {
+                if ( iMember == iSrcIdx )
+                {
+                    iLeader = iMember;
+                }
+            }
+
+            // otherwise a member is chosen whose encoder is not the stream
+            // source of any other client
+            for ( int iMember = iFirstMember; ( iMember != INVALID_INDEX ) && ( iLeader == INVALID_INDEX ); iMember = vecMixGroupNextMembers[iMember] )
+            {
+                if ( vecIsStreamSrc[iMember] == 0 )
+                {
+                    iLeader = iMember;
+                }
+            }
+        }
+
+        if ( iLeader == INVALID_INDEX )
+        {
+            iLeader = iFirstMember;
+        }
+
+        // If the encoder of the leader did not produce a stream in the last
+        // tick, it starts a new stream from a reset state (the encoder state
+        // cannot be handed over, the members which switch the stream get one
+        // transition frame).
+        if ( ( vecIsStreamSrc[iLeader] == 0 ) && ( vecpOpusEncoders[iLeader] != nullptr ) )
+        {
+            opus_custom_encoder_ctl ( vecpOpusEncoders[iLeader], OPUS_RESET_STATE );
+        }
+
+        if ( ( iLeader != INVALID_INDEX ) && ( iLeader != iFirstMember ) )
+        {
+            // move the new leader to the front of the member list
+            int iPrevMember = iFirstMember;
+
+            while ( vecMixGroupNextMembers[iPrevMember] != iLeader )
+            {
+                iPrevMember = vecMixGroupNextMembers[iPrevMember];
+            }
+
+            vecMixGroupNextMembers[iPrevMember] = vecMixGroupNextMembers[iLeader];
+            vecMixGroupNextMembers[iLeader]     = iFirstMember;
+            vecMixGroupLeaders[iG]              = iLeader;
+
+            if ( vecMixGroupLastMembers[iG] == iLeader )
+            {
+                vecMixGroupLastMembers[iG] = iPrevMember;
+            }
+        }
+
+        // store the stream source of all members for the next tick
+        const int iLeaderChanID = vecChanIDsCurConChan[vecMixGroupLeaders[iG]];
+
+        for ( int iMember = vecMixGroupLeaders[iG]; iMember != INVALID_INDEX; iMember = vecMixGroupNextMembers[iMember] )
+        {
+            vecStreamSrcChanIDs[vecChanIDsCurConChan[iMember]]   = iLeaderChanID;
+            vecpStreamSrcEncoders[vecChanIDsCurConChan[iMember]] = vecpOpusEncoders[vecMixGroupLeaders[iG]];
+        }
+    }
+}
+
+void CServer::MixEncodeTransmitData ( const int iMixGroup,
+                                      const int iThreadIdx )
+{
+    int                iUnused;
+    int                iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
+    OpusCustomEncoder* CurOpusEncoder;
+
+    // the mix is calculated and encoded by the group leader only, i.e. the
+    // encoder of the group leader is shared by all members of the group
+    const int iChanCnt = vecMixGroupLeaders[iMixGroup];
+
+    // get actual ID of current channel
+    const int iCurChanID = vecChanIDsCurConChan[iChanCnt];
+
+    // get number of audio channels of current channel
+    const int iCurNumAudChan = vecNumAudioChannels[iChanCnt];
+
+    // export the audio data for recording purpose
+    if ( JamController.GetRecordingEnabled() )
+    {
+        for ( int iMember = iChanCnt; iMember != INVALID_INDEX; iMember = vecMixGroupNextMembers[iMember] )
+        {
+            const int iMemberChanID = vecChanIDsCurConChan[iMember];
+
+            // the jam recorder works on 16 bit samples
+            CMixKernels::ConvertToInt16 ( vecvecfData[iMember].data(),
+                                          &vecvecsData[iMember][0],
+                                          iServerFrameSizeSamples * vecNumAudioChannels[iMember] );
+
+            JamController.AudioFrameQueued();
+
+            emit AudioFrame ( iMemberChanID,
+                              vecChannels[iMemberChanID].GetName(),
+                              vecChannels[iMemberChanID].GetAddress(),
+                              vecNumAudioChannels[iMember],
+                              vecvecsData[iMember] );
+        }
+    }
+
+    // generate a separate mix for each channel
+    // actual processing of audio data -> mix
+    int64_t iStageStartNs = CTimingHistogram::GetTimeNs();
+
+    if ( vecUseFullMix[iChanCnt] != 0 )
+    {
+        // the client uses the default mix, i.e. only the own signal differs
+        // from the common mix of all clients
+        ProcessDataFromFullMix ( ( iCurNumAudChan == 1 ) ? vecfFullMixMono : vecfFullMixStereo,
+                                 vecvecfData[iChanCnt],
+                                 vecvecdGains[iChanCnt][iChanCnt],
+                                 vecvecdPannings[iChanCnt][iChanCnt],
+                                 vecdFadeInGains[iChanCnt],
+                                 vecNumAudioChannels[iChanCnt],
+                                 vecfPeakLevels[iChanCnt] < MIX_SILENCE_THRESHOLD,
+                                 vecvecfIntermProcBuf[iChanCnt],
+                                 vecvecfSendData[iChanCnt],
+                                 iCurNumAudChan );
+    }
+    else
+    {
+        ProcessData ( vecvecfData,
+                      vecvecdGains[iChanCnt],
+                      vecvecdPannings[iChanCnt],
+                      vecNumAudioChannels,
+                      vecvecfIntermProcBuf[iChanCnt],
+                      vecvecfSendData[iChanCnt],
+                      iCurNumAudChan,
+                      vecActiveClients,
+                      iNumActiveClients );
+    }
+
+    int64_t iStageEndNs = CTimingHistogram::GetTimeNs();
+
+    TickStats.Add ( iThreadIdx, CServerTickStats::TS_MIX, iStageEndNs - iStageStartNs );
+
+    // get current number of CELT coded bytes
+    const int iCeltNumCodedBytes = vecNetwFrameSizes[iChanCnt];
+
+    // select the opus encoder and raw audio frame length
+    CurOpusEncoder = vecpOpusEncoders[iChanCnt];
+
+    if ( vecAudioComprType[iChanCnt] == CT_OPUS )
+    {
+        iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+    else if ( vecAudioComprType[iChanCnt] == CT_OPUS64 )
+    {
+        iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+
+    // If the server frame size is smaller than the received OPUS frame size, we need a conversion
+    // buffer which stores the large buffer.
+    // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
+    // is false and the Get() function is not called at all. Therefore if the buffer is not needed
+    // we do not spend any time in the function but go directly inside the if condition.
+    if ( ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] == 0 ) ||
+         DoubleFrameSizeConvBufOut[iCurChanID].Put ( vecvecfSendData[iChanCnt], SYSTEM_FRAME_SIZE_SAMPLES * iCurNumAudChan ) )
+    {
+        if ( vecUseDoubleSysFraSizeConvBuf[iChanCnt] != 0 )
+        {
+            // get the large frame from the conversion buffer
+            DoubleFrameSizeConvBufOut[iCurChanID].GetAll ( vecvecfSendData[iChanCnt], DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * iCurNumAudChan );
         }
 
-#ifdef USE_OMP
-// TODO This does not work as expected, the CPU is at high levels even if not much work is to be done. So we
-// have an issue using OMP in the OnTimer() function. Even if #pragma omp parallel for is used on a trivial
-// for loop for testing, still the CPU usage goes to very high values -> What is the cause of this issue?
-// NOTE Most probably it is the overhead of threads creation/destruction which causes this effect.
-// See https://software.intel.com/content/www/us/en/develop/articles/performance-obstacles-for-threading-how-do-they-affect-openmp-code.html
-// "[...] overhead numbers are high enough that it doesn’t make sense to thread that code. In those cases, we’re better off leaving the code in its original serial form."
-# pragma omp parallel for
-#endif
-        for ( int i = 0; i < iNumClients; i++ )
+        int64_t iEncodeNs = 0;
+        int64_t iSendNs   = 0;
+
+        for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[iChanCnt]; iB++ )
         {
-            int                iClientFrameSizeSamples = 0; // initialize to avoid a compiler warning
-            OpusCustomEncoder* CurOpusEncoder;
+            iStageStartNs = CTimingHistogram::GetTimeNs();
 
-            // get actual ID of current channel
-            const int iCurChanID = vecChanIDsCurConChan[i];
+            // OPUS encoding
+            if ( CurOpusEncoder != nullptr )
+            {
+// TODO find a better place than this: the setting does not change all the time
+//      so for speed optimization it would be better to set it only if the network
+//      frame size is changed
+opus_custom_encoder_ctl ( CurOpusEncoder,
+                          OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iClientFrameSizeSamples ) ) );
+
+                iUnused = opus_custom_encode_float ( CurOpusEncoder,
+                                                     &vecvecfSendData[iChanCnt][iB * SYSTEM_FRAME_SIZE_SAMPLES * iCurNumAudChan],
+                                                     iClientFrameSizeSamples,
+                                                     &vecvecbyCodedData[iChanCnt][0],
+                                                     iCeltNumCodedBytes );
+            }
 
-            // get number of audio channels of current channel
-            const int iCurNumAudChan = vecNumAudioChannels[i];
+            iStageEndNs  = CTimingHistogram::GetTimeNs();
+            iEncodeNs   += iStageEndNs - iStageStartNs;
 
-            // export the audio data for recording purpose
-            if ( JamController.GetRecordingEnabled() )
+            // send separate mix to all clients of the group
+            for ( int iMember = iChanCnt; iMember != INVALID_INDEX; iMember = vecMixGroupNextMembers[iMember] )
             {
-                emit AudioFrame ( iCurChanID,
-                                  vecChannels[iCurChanID].GetName(),
-                                  vecChannels[iCurChanID].GetAddress(),
-                                  iCurNumAudChan,
-                                  vecvecsData[i] );
+                vecChannels[vecChanIDsCurConChan[iMember]].PrepAndSendPacket ( &Socket,
+                                                                               vecvecbyCodedData[iChanCnt],
+                                                                               iCeltNumCodedBytes );
             }
 
-            // generate a separate mix for each channel
-            // actual processing of audio data -> mix
-            ProcessData ( vecvecsData,
-                          vecvecdGains[i],
-                          vecvecdPannings[i],
-                          vecNumAudioChannels,
-                          vecvecsSendData[i],
-                          iCurNumAudChan,
-                          iNumClients );
-
-            // get current number of CELT coded bytes
-            const int iCeltNumCodedBytes = vecChannels[iCurChanID].GetNetwFrameSize();
+            iStageStartNs  = CTimingHistogram::GetTimeNs();
+            iSendNs       += iStageStartNs - iStageEndNs;
+        }
 
-            // select the opus encoder and raw audio frame length
-            if ( vecAudioComprType[i] == CT_OPUS )
-            {
-                iClientFrameSizeSamples = DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES;
+        for ( int iMember = iChanCnt; iMember != INVALID_INDEX; iMember = vecMixGroupNextMembers[iMember] )
+        {
+            const int iMemberChanID = vecChanIDsCurConChan[iMember];
 
-                if ( vecNumAudioChannels[i] == 1 )
-                {
-                    CurOpusEncoder = OpusEncoderMono[iCurChanID];
-                }
-                else
-                {
-                    CurOpusEncoder = OpusEncoderStereo[iCurChanID];
-                }
-            }
-            else if ( vecAudioComprType[i] == CT_OPUS64 )
-            {
-                iClientFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+            // update socket buffer size
+            vecChannels[iMemberChanID].UpdateSocketBufferSize();
 
-                if ( vecNumAudioChannels[i] == 1 )
-                {
-                    CurOpusEncoder = Opus64EncoderMono[iCurChanID];
-                }
-                else
-                {
-                    CurOpusEncoder = Opus64EncoderStereo[iCurChanID];
-                }
-            }
-            else
+            // send channel levels
+            if ( bCurSendChannelLevels && vecChannels[iMemberChanID].ChannelLevelsRequired() )
             {
-                CurOpusEncoder = nullptr;
+                ConnLessProtocol.SendPreparedConLessMessage ( ChannelLevelListMess,
+                                                              vecChannels[iMemberChanID].GetAddress() );
             }
+        }
 
-            // If the server frame size is smaller than the received OPUS frame size, we need a conversion
-            // buffer which stores the large buffer.
-            // Note that we have a shortcut here. If the conversion buffer is not needed, the boolean flag
-            // is false and the Get() function is not called at all. Therefore if the buffer is not needed
-            // we do not spend any time in the function but go directly inside the if condition.
-            if ( ( vecUseDoubleSysFraSizeConvBuf[i] == 0 ) ||
-                 DoubleFrameSizeConvBufOut[iCurChanID].Put ( vecvecsSendData[i], SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] ) )
-            {
-                if ( vecUseDoubleSysFraSizeConvBuf[i] != 0 )
-                {
-                    // get the large frame from the conversion buffer
-                    DoubleFrameSizeConvBufOut[iCurChanID].GetAll ( vecvecsSendData[i], DOUBLE_SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i] );
-                }
+        iSendNs += CTimingHistogram::GetTimeNs() - iStageStartNs;
 
-                for ( int iB = 0; iB < vecNumFrameSizeConvBlocks[i]; iB++ )
-                {
-                    // OPUS encoding
-                    if ( CurOpusEncoder != nullptr )
-                    {
-// TODO find a better place than this: the setting does not change all the time
-//      so for speed optimization it would be better to set it only if the network
-//      frame size is changed
-opus_custom_encoder_ctl ( CurOpusEncoder,
-                          OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iClientFrameSizeSamples ) ) );
+        TickStats.Add ( iThreadIdx, CServerTickStats::TS_ENCODE, iEncodeNs );
+        TickStats.Add ( iThreadIdx, CServerTickStats::TS_SEND, iSendNs );
+    }
 
-                        iUnused = opus_custom_encode ( CurOpusEncoder,
-                                                       &vecvecsSendData[i][iB * SYSTEM_FRAME_SIZE_SAMPLES * vecNumAudioChannels[i]],
-                                                       iClientFrameSizeSamples,
-                                                       &vecvecbyCodedData[i][0],
-                                                       iCeltNumCodedBytes );
-                    }
+    Q_UNUSED ( iUnused )
+}
 
-                    // send separate mix to current clients
-                    vecChannels[iCurChanID].PrepAndSendPacket ( &Socket,
-                                                                vecvecbyCodedData[i],
-                                                                iCeltNumCodedBytes );
-                }
+/// @brief Mix all audio data from all clients together.
+void CServer::ProcessData ( const CVector<CVector<float> >& vecvecfData,
+                            const CVector<double>&          vecdGains,
+                            const CVector<double>&          vecdPannings,
+                            const CVector<int>&             vecNumAudioChannels,
+                            CVector<float>&                 vecfIntermProcBuf,
+                            CVector<float>&                 vecfOutData,
+                            const int                       iCurNumAudChan,
+                            const CVector<int>&             vecActiveClients,
+                            const int                       iNumActiveClients )
+{
+    // The mixing is done with the vectorized kernels in a float intermediate
+    // buffer without any intermediate clipping. The limiter is only applied
+    // once after all clients are mixed together.
+    MixData ( vecvecfData,
+              vecdGains,
+              vecdPannings,
+              vecNumAudioChannels,
+              vecfIntermProcBuf,
+              iCurNumAudChan,
+              vecActiveClients,
+              iNumActiveClients );
+
+    // apply the final limiter on the mix
+    CMixKernels::Clip ( &vecfIntermProcBuf[0], &vecfOutData[0], iServerFrameSizeSamples * iCurNumAudChan );
+}
 
-                // update socket buffer size
-                vecChannels[iCurChanID].UpdateSocketBufferSize();
+/// @brief Derive the mix of a client with default fader settings from the
+///        common mix of all clients by only correcting the own signal.
+void CServer::ProcessDataFromFullMix ( const CVector<float>& vecfFullMix,
+                                       const CVector<float>& vecfOwnData,
+                                       const double          dOwnGain,
+                                       const double          dOwnPan,
+                                       const double          dOwnFullMixGain,
+                                       const int             iOwnNumAudChan,
+                                       const bool            bOwnIsSilent,
+                                       CVector<float>&       vecfIntermProcBuf,
+                                       CVector<float>&       vecfOutData,
+                                       const int             iCurNumAudChan )
+{
+    const int iNumOutValues = iServerFrameSizeSamples * iCurNumAudChan;
 
-                // send channel levels
-                if ( bSendChannelLevels && vecChannels[iCurChanID].ChannelLevelsRequired() )
-                {
-                    ConnLessProtocol.CreateCLChannelLevelListMes ( vecChannels[iCurChanID].GetAddress(),
-                                                                   vecChannelLevels,
-                                                                   iNumClients );
-                }
-            }
+    // the own signal is contained in the common mix with the fade-in gain
+    // only, i.e. we have to add the difference to the actual own gain/pan
+    float fCorrGainL;
+    float fCorrGainR;
+
+    if ( iCurNumAudChan == 1 )
+    {
+        fCorrGainL = static_cast<float> ( dOwnGain - dOwnFullMixGain );
+        fCorrGainR = fCorrGainL;
+    }
+    else
+    {
+        fCorrGainL = static_cast<float> ( MathUtils::GetLeftPan ( dOwnPan, false ) * dOwnGain - dOwnFullMixGain );
+        fCorrGainR = static_cast<float> ( MathUtils::GetRightPan ( dOwnPan, false ) * dOwnGain - dOwnFullMixGain );
+    }
+
+    if ( bOwnIsSilent || ( ( fCorrGainL == 0.0f ) && ( fCorrGainR == 0.0f ) ) )
+    {
+        // the client gets exactly the common mix
+        CMixKernels::Clip ( vecfFullMix.data(), &vecfOutData[0], iNumOutValues );
+        return;
+    }
+
+    float*       pfIntermProcBuf = &vecfIntermProcBuf[0];
+    const float* pfOwnData       = vecfOwnData.data();
+
+    std::copy ( vecfFullMix.data(), vecfFullMix.data() + iNumOutValues, pfIntermProcBuf );
+
+    if ( iCurNumAudChan == 1 )
+    {
+        if ( iOwnNumAudChan == 1 )
+        {
+            CMixKernels::AddGain ( pfOwnData, pfIntermProcBuf, iServerFrameSizeSamples, fCorrGainL, fCorrGainL );
+        }
+        else
+        {
+            CMixKernels::AddStereoToMono ( pfOwnData, pfIntermProcBuf, iServerFrameSizeSamples, fCorrGainL );
         }
     }
     else
     {
-        // Disable server if no clients are connected. In this case the server
-        // does not consume any significant CPU when no client is connected.
-        Stop();
+        if ( iOwnNumAudChan == 1 )
+        {
+            CMixKernels::AddMonoToStereo ( pfOwnData, pfIntermProcBuf, iServerFrameSizeSamples, fCorrGainL, fCorrGainR );
+        }
+        else
+        {
+            CMixKernels::AddGain ( pfOwnData, pfIntermProcBuf, 2 * iServerFrameSizeSamples, fCorrGainL, fCorrGainR );
+        }
     }
 
-    Q_UNUSED ( iUnused )
+    // apply the final limiter on the mix
+    CMixKernels::Clip ( pfIntermProcBuf, &vecfOutData[0], iNumOutValues );
 }
 
-/// @brief Mix all audio data from all clients together.
-void CServer::ProcessData ( const CVector<CVector<int16_t> >& vecvecsData,
-                            const CVector<double>&            vecdGains,
-                            const CVector<double>&            vecdPannings,
-                            const CVector<int>&               vecNumAudioChannels,
-                            CVector<int16_t>&                 vecsOutData,
-                            const int                         iCurNumAudChan,
-                            const int                         iNumClients )
+/// @brief Accumulate the audio data of all active (not silent) clients in a float buffer.
+void CServer::MixData ( const CVector<CVector<float> >& vecvecfData,
+                        const CVector<double>&          vecdGains,
+                        const CVector<double>&          vecdPannings,
+                        const CVector<int>&             vecNumAudioChannels,
+                        CVector<float>&                 vecfIntermProcBuf,
+                        const int                       iCurNumAudChan,
+                        const CVector<int>&             vecActiveClients,
+                        const int                       iNumActiveClients )
 {
-    int i, j, k;
+    float*    pfIntermProcBuf = &vecfIntermProcBuf[0];
+    const int iNumOutValues   = iServerFrameSizeSamples * iCurNumAudChan;
 
-    // init return vector with zeros since we mix all channels on that vector
-    vecsOutData.Reset ( 0 );
+    // init intermediate buffer with zeros since we mix all channels on that buffer
+    std::fill ( pfIntermProcBuf, pfIntermProcBuf + iNumOutValues, 0.0f );
 
     // distinguish between stereo and mono mode
     if ( iCurNumAudChan == 1 )
     {
         // Mono target channel -------------------------------------------------
-        for ( j = 0; j < iNumClients; j++ )
+        for ( int k = 0; k < iNumActiveClients; k++ )
         {
-            // get a reference to the audio data and gain of the current client
-            const CVector<int16_t>& vecsData = vecvecsData[j];
-            const double            dGain    = vecdGains[j];
+            const int j = vecActiveClients[k];
 
-            // if channel gain is 1, avoid multiplication for speed optimization
-            if ( dGain == static_cast<double> ( 1.0 ) )
+            // muted clients do not contribute to the mix
+            if ( vecdGains[j] == 0 )
             {
-                if ( vecNumAudioChannels[j] == 1 )
-                {
-                    // mono
-                    for ( i = 0; i < iServerFrameSizeSamples; i++ )
-                    {
-                        vecsOutData[i] = Double2Short (
-                            static_cast<double> ( vecsOutData[i] ) + vecsData[i] );
-                    }
-                }
-                else
-                {
-                    // stereo: apply stereo-to-mono attenuation
-                    for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                    {
-                        vecsOutData[i] =
-                            Double2Short ( vecsOutData[i] +
-                            ( static_cast<double> ( vecsData[k] ) + vecsData[k + 1] ) / 2 );
-                    }
-                }
+                continue;
+            }
+
+            // get a pointer to the audio data and gain of the current client
+            const float* pfData = vecvecfData[j].data();
+            const float  fGain  = static_cast<float> ( vecdGains[j] );
+
+            if ( vecNumAudioChannels[j] == 1 )
+            {
+                // mono
+                CMixKernels::AddGain ( pfData, pfIntermProcBuf, iServerFrameSizeSamples, fGain, fGain );
             }
             else
             {
-                if ( vecNumAudioChannels[j] == 1 )
-                {
-                    // mono
-                    for ( i = 0; i < iServerFrameSizeSamples; i++ )
-                    {
-                        vecsOutData[i] = Double2Short (
-                            vecsOutData[i] + vecsData[i] * dGain );
-                    }
-                }
-                else
-                {
-                    // stereo: apply stereo-to-mono attenuation
-                    for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                    {
-                        vecsOutData[i] =
-                            Double2Short ( vecsOutData[i] + dGain *
-                            ( static_cast<double> ( vecsData[k] ) + vecsData[k + 1] ) / 2 );
-                    }
-                }
+                // stereo: apply stereo-to-mono attenuation
+                CMixKernels::AddStereoToMono ( pfData, pfIntermProcBuf, iServerFrameSizeSamples, fGain );
             }
         }
     }
     else
     {
         // Stereo target channel -----------------------------------------------
-        for ( j = 0; j < iNumClients; j++ )
+        for ( int k = 0; k < iNumActiveClients; k++ )
         {
-            // get a reference to the audio data and gain/pan of the current client
-            const CVector<int16_t>& vecsData = vecvecsData[j];
-            const double            dGain    = vecdGains[j];
-            const double            dPan     = vecdPannings[j];
+            const int j = vecActiveClients[k];
+
+            // muted clients do not contribute to the mix
+            if ( vecdGains[j] == 0 )
+            {
+                continue;
+            }
+
+            // get a pointer to the audio data and gain/pan of the current client
+            const float* pfData = vecvecfData[j].data();
+            const double dGain  = vecdGains[j];
+            const double dPan   = vecdPannings[j];
 
             // calculate combined gain/pan for each stereo channel where we define
             // the panning that center equals full gain for both channels
-            const double dGainL = MathUtils::GetLeftPan ( dPan, false ) * dGain;
-            const double dGainR = MathUtils::GetRightPan ( dPan, false ) * dGain;
+            const float fGainL = static_cast<float> ( MathUtils::GetLeftPan ( dPan, false ) * dGain );
+            const float fGainR = static_cast<float> ( MathUtils::GetRightPan ( dPan, false ) * dGain );
 
-            // if channel gain is 1, avoid multiplication for speed optimization
-            if ( ( dGainL == static_cast<double> ( 1.0 ) ) && ( dGainR == static_cast<double> ( 1.0 ) ) )
+            if ( vecNumAudioChannels[j] == 1 )
             {
-                if ( vecNumAudioChannels[j] == 1 )
-                {
-                    // mono: copy same mono data in both out stereo audio channels
-                    for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                    {
-                        // left channel
-                        vecsOutData[k] = Double2Short (
-                            static_cast<double> ( vecsOutData[k] ) + vecsData[i] );
-
-                        // right channel
-                        vecsOutData[k + 1] = Double2Short (
-                            static_cast<double> ( vecsOutData[k + 1] ) + vecsData[i] );
-                    }
-                }
-                else
-                {
-                    // stereo
-                    for ( i = 0; i < ( 2 * iServerFrameSizeSamples ); i++ )
-                    {
-                        vecsOutData[i] = Double2Short (
-                            static_cast<double> ( vecsOutData[i] ) + vecsData[i] );
-                    }
-                }
+                // mono: copy same mono data in both out stereo audio channels
+                CMixKernels::AddMonoToStereo ( pfData, pfIntermProcBuf, iServerFrameSizeSamples, fGainL, fGainR );
             }
             else
             {
-                if ( vecNumAudioChannels[j] == 1 )
-                {
-                    // mono: copy same mono data in both out stereo audio channels
-                    for ( i = 0, k = 0; i < iServerFrameSizeSamples; i++, k += 2 )
-                    {
-                        // left/right channel
-                        vecsOutData[k]     = Double2Short ( vecsOutData[k] +     vecsData[i] * dGainL );
-                        vecsOutData[k + 1] = Double2Short ( vecsOutData[k + 1] + vecsData[i] * dGainR );
-                    }
-                }
-                else
-                {
-                    // stereo
-                    for ( i = 0; i < ( 2 * iServerFrameSizeSamples ); i += 2 )
-                    {
-                        // left/right channel
-                        vecsOutData[i]     = Double2Short ( vecsOutData[i] +     vecsData[i] *     dGainL );
-                        vecsOutData[i + 1] = Double2Short ( vecsOutData[i + 1] + vecsData[i + 1] * dGainR );
-                    }
-                }
+                // stereo
+                CMixKernels::AddGain ( pfData, pfIntermProcBuf, 2 * iServerFrameSizeSamples, fGainL, fGainR );
             }
         }
     }
@@ -1292,13 +2672,18 @@ void CServer::CreateAndSendChanListForAllConChannels()
     // create channel list
     CVector<CChannelInfo> vecChanInfo ( CreateChannelList() );
 
+    // the complete list is only encoded once, it is sent to the clients which
+    // do not support list changes or do not know the previous list
+    CProtocol::CPreparedMessage FullListMess;
+    CProtocol::PrepareConClientListMes ( FullListMess, vecChanInfo );
+
     // now send connected channels list to all connected clients
     for ( int i = 0; i < iMaxNumChannels; i++ )
     {
         if ( vecChannels[i].IsConnected() )
         {
             // send message
-            vecChannels[i].CreateConClientListMes ( vecChanInfo );
+            vecChannels[i].CreateConClientListMes ( vecChanInfo, FullListMess );
         }
     }
 
@@ -1337,20 +2722,25 @@ void CServer::CreateAndSendChatTextForAllConChannels ( const int      iCurChanID
 
 
     // Send chat text to all connected clients ---------------------------------
+    // the message is only encoded once
+    CProtocol::CPreparedMessage ChatTextMess;
+    CProtocol::PrepareChatTextMes ( ChatTextMess, strActualMessageText );
+
     for ( int i = 0; i < iMaxNumChannels; i++ )
     {
         if ( vecChannels[i].IsConnected() )
         {
             // send message
-            vecChannels[i].CreateChatTextMes ( strActualMessageText );
+            vecChannels[i].SendPreparedMes ( ChatTextMess );
         }
     }
 }
 
 void CServer::CreateAndSendRecorderStateForAllConChannels()
 {
-    // get recorder state
-    ERecorderState eRecorderState = JamController.GetRecorderState();
+    // get recorder state and encode the message only once
+    CProtocol::CPreparedMessage RecorderStateMess;
+    CProtocol::PrepareRecorderStateMes ( RecorderStateMess, JamController.GetRecorderState() );
 
     // now send recorder state to all connected clients
     for ( int i = 0; i < iMaxNumChannels; i++ )
@@ -1358,7 +2748,7 @@ void CServer::CreateAndSendRecorderStateForAllConChannels()
         if ( vecChannels[i].IsConnected() )
         {
             // send message
-            vecChannels[i].CreateRecorderStateMes ( eRecorderState );
+            vecChannels[i].SendPreparedMes ( RecorderStateMess );
         }
     }
 }
@@ -1429,6 +2819,52 @@ int CServer::FindChannel ( const CHostAddress& CheckAddr )
     return INVALID_CHANNEL_ID;
 }
 
+int CServer::FindChannelInIndex ( const int      iSocketIdx,
+                                  const uint64_t iAddrKey )
+{
+/*
+    this function must only be called by the receive thread of the socket
+*/
+    const int iChanID = vecChanAddrIndices[iSocketIdx].Find ( iAddrKey );
+
+    // the channel may have been disconnected in the meantime or may have been
+    // assigned to another client by another receive thread, in that case the
+    // index entry is outdated and is removed
+    if ( ( iChanID != INVALID_CHANNEL_ID ) &&
+         ( !vecChannels[iChanID].IsConnected() || ( vecChanAssignedAddrKeys[iChanID].load() != iAddrKey ) ) )
+    {
+        vecChanAddrIndices[iSocketIdx].Remove ( iAddrKey );
+        vecvecChanAddrKeys[iSocketIdx][iChanID] = 0;
+
+        return INVALID_CHANNEL_ID;
+    }
+
+    return iChanID;
+}
+
+void CServer::UpdateChanAddrIndex ( const int      iSocketIdx,
+                                    const int      iChanID,
+                                    const uint64_t iAddrKey )
+{
+/*
+    this function must only be called by the receive thread of the socket
+*/
+    uint64_t& iCurAddrKey = vecvecChanAddrKeys[iSocketIdx][iChanID];
+
+    if ( iCurAddrKey != iAddrKey )
+    {
+        // a channel has at most one entry in the index, i.e. the table never
+        // runs full
+        if ( iCurAddrKey != 0 )
+        {
+            vecChanAddrIndices[iSocketIdx].Remove ( iCurAddrKey );
+        }
+
+        vecChanAddrIndices[iSocketIdx].Insert ( iAddrKey, iChanID );
+        iCurAddrKey = iAddrKey;
+    }
+}
+
 void CServer::OnProtcolMessageReceived ( int              iRecCounter,
                                          int              iRecID,
                                          CVector<uint8_t> vecbyMesBodyData,
@@ -1446,6 +2882,12 @@ void CServer::OnProtcolMessageReceived ( int              iRecCounter,
                                                      iRecID,
                                                      vecbyMesBodyData,
                                                      RecHostAddr );
+
+            // the message may have changed the network transport properties,
+            // make sure the channel has the codec states for its codec
+            OpusCodecPool.Assign ( iCurChanID,
+                                   vecChannels[iCurChanID].GetAudioCompressionType(),
+                                   vecChannels[iCurChanID].GetNumAudioChannels() );
         }
     }
     Mutex.unlock();
@@ -1454,15 +2896,34 @@ void CServer::OnProtcolMessageReceived ( int              iRecCounter,
 bool CServer::PutAudioData ( const CVector<uint8_t>& vecbyRecBuf,
                              const int               iNumBytesRead,
                              const CHostAddress&     HostAdr,
+                             const int               iSocketIdx,
                              int&                    iCurChanID )
 {
     bool bNewConnection = false; // init return value
     bool bChanOK        = true;  // init with ok, might be overwritten
 
-    Mutex.lock();
+    // Get channel ID ----------------------------------------------------------
+    // check address (the lookup of an already connected channel does not need
+    // the server mutex since the channel addresses are only modified below
+    // inside the mutex and each receive socket has its own address index, this
+    // way the network receive threads are not blocked by the mixer)
+    uint64_t   iAddrKey    = 0;
+    const bool bHasAddrKey = CChanAddrIndex::GetKey ( HostAdr, iAddrKey );
+
+    if ( bHasAddrKey )
+    {
+        iCurChanID = FindChannelInIndex ( iSocketIdx, iAddrKey );
+    }
+    else
+    {
+        iCurChanID = FindChannel ( HostAdr );
+    }
+
+    if ( iCurChanID == INVALID_CHANNEL_ID )
     {
-        // Get channel ID ------------------------------------------------------
-        // check address
+        QMutexLocker locker ( &Mutex );
+
+        // check again inside the mutex region
         iCurChanID = FindChannel ( HostAdr );
 
         if ( iCurChanID == INVALID_CHANNEL_ID )
@@ -1475,6 +2936,7 @@ bool CServer::PutAudioData ( const CVector<uint8_t>& vecbyRecBuf,
                 // initialize current channel by storing the calling host
                 // address
                 vecChannels[iCurChanID].SetAddress ( HostAdr );
+                vecChanAssignedAddrKeys[iCurChanID].store ( iAddrKey );
 
                 // reset channel info
                 vecChannels[iCurChanID].ResetInfo();
@@ -1497,21 +2959,26 @@ bool CServer::PutAudioData ( const CVector<uint8_t>& vecbyRecBuf,
             }
         }
 
+        if ( bChanOK && bHasAddrKey )
+        {
+            UpdateChanAddrIndex ( iSocketIdx, iCurChanID, iAddrKey );
+        }
+    }
+
 
-        // Put received audio data in jitter buffer ----------------------------
-        if ( bChanOK )
+    // Put received audio data in jitter buffer --------------------------------
+    // (the jitter buffer is lock-free, no server mutex required)
+    if ( bChanOK )
+    {
+        // put packet in socket buffer
+        if ( vecChannels[iCurChanID].PutAudioData ( vecbyRecBuf,
+                                                    iNumBytesRead,
+                                                    HostAdr ) == PS_NEW_CONNECTION )
         {
-            // put packet in socket buffer
-            if ( vecChannels[iCurChanID].PutAudioData ( vecbyRecBuf,
-                                                        iNumBytesRead,
-                                                        HostAdr ) == PS_NEW_CONNECTION )
-            {
-                // in case we have a new connection return this information
-                bNewConnection = true;
-            }
+            // in case we have a new connection return this information
+            bNewConnection = true;
         }
     }
-    Mutex.unlock();
 
     // return the state if a new connection was happening
     return bNewConnection;
@@ -1544,6 +3011,185 @@ void CServer::GetConCliParam ( CVector<CHostAddress>& vecHostAddresses,
     }
 }
 
+QString CServer::GetMetrics()
+{
+    // upper bounds of the buckets of the tick stage duration histograms (the
+    // fine buckets of the timing histograms are merged to these buckets)
+    const int64_t veciBucketBoundsNs[] = { 10000, 25000, 50000, 100000, 250000,
+        500000, 1000000, 2500000, 5000000, 10000000, 25000000 };
+
+    QString     strMetrics;
+    QTextStream streamMetrics ( &strMetrics );
+
+    // server state
+    streamMetrics << "# HELP jamulus_server_running Whether the server processing is running.\n"
+        "# TYPE jamulus_server_running gauge\n"
+        "jamulus_server_running " << ( IsRunning() ? 1 : 0 ) << "\n";
+
+    streamMetrics << "# HELP jamulus_clients_connected Number of connected clients.\n"
+        "# TYPE jamulus_clients_connected gauge\n"
+        "jamulus_clients_connected " << GetNumberOfConnectedClients() << "\n";
+
+    streamMetrics << "# HELP jamulus_clients_max Maximum number of clients.\n"
+        "# TYPE jamulus_clients_max gauge\n"
+        "jamulus_clients_max " << iMaxNumChannels << "\n";
+
+    // timing of the server timer tick
+    streamMetrics << "# HELP jamulus_tick_stage_duration_seconds Duration of the processing stages of the server timer tick.\n"
+        "# TYPE jamulus_tick_stage_duration_seconds histogram\n";
+
+    for ( int iStage = 0; iStage < CServerTickStats::TS_NUM_STAGES; iStage++ )
+    {
+        const CServerTickStats::ETickStage eStage = static_cast<CServerTickStats::ETickStage> ( iStage );
+        const QString                      strStage = CServerTickStats::GetStageName ( eStage );
+        CVector<uint64_t>                  veciCounts;
+        uint64_t                           iSumNs;
+        uint64_t                           iCumCount = 0;
+        int                                iBucket   = 0;
+
+        TickStats.GetSnapshot ( eStage, veciCounts, iSumNs );
+
+        for ( const int64_t iBoundNs : veciBucketBoundsNs )
+        {
+            while ( ( iBucket < TIMING_HIST_NUM_BUCKETS ) &&
+                    ( CTimingHistogram::GetBucketUpperBound ( iBucket ) <= iBoundNs ) )
+            {
+                iCumCount += veciCounts[iBucket++];
+            }
+
+            streamMetrics << "jamulus_tick_stage_duration_seconds_bucket{stage=\"" << strStage <<
+                "\",le=\"" << QString::number ( static_cast<double> ( iBoundNs ) / 1000000000, 'f', 6 ) <<
+                "\"} " << iCumCount << "\n";
+        }
+
+        streamMetrics << "jamulus_tick_stage_duration_seconds_bucket{stage=\"" << strStage << "\",le=\"+Inf\"} " <<
+            CTimingHistogram::GetNumValues ( veciCounts ) << "\n";
+
+        streamMetrics << "jamulus_tick_stage_duration_seconds_sum{stage=\"" << strStage << "\"} " <<
+            QString::number ( static_cast<double> ( iSumNs ) / 1000000000, 'f', 6 ) << "\n";
+
+        streamMetrics << "jamulus_tick_stage_duration_seconds_count{stage=\"" << strStage << "\"} " <<
+            CTimingHistogram::GetNumValues ( veciCounts ) << "\n";
+    }
+
+    uint64_t iNumMissedDeadlines;
+    uint64_t iNumResyncs;
+
+    HighPrecisionTimer.GetTotalTimingStats ( iNumMissedDeadlines, iNumResyncs );
+
+    streamMetrics << "# HELP jamulus_timer_missed_deadlines_total Server timer ticks which finished after the deadline of the next tick.\n"
+        "# TYPE jamulus_timer_missed_deadlines_total counter\n"
+        "jamulus_timer_missed_deadlines_total " << iNumMissedDeadlines << "\n";
+
+    streamMetrics << "# HELP jamulus_timer_resyncs_total Restarts of the server tick schedule.\n"
+        "# TYPE jamulus_timer_resyncs_total counter\n"
+        "jamulus_timer_resyncs_total " << iNumResyncs << "\n";
+
+    // network traffic of all sockets
+    uint64_t iNumPacketsRec  = 0;
+    uint64_t iNumBytesRec    = 0;
+    uint64_t iNumPacketsSent = 0;
+    uint64_t iNumBytesSent   = 0;
+    uint64_t iNumProtQueueOv = 0;
+
+    for ( int i = 0; i <= vecpAddRecSockets.Size(); i++ )
+    {
+        const CHighPrioSocket& CurSocket = ( i == 0 ) ? Socket : *vecpAddRecSockets[i - 1];
+        uint64_t               iCurNumPacketsRec;
+        uint64_t               iCurNumBytesRec;
+        uint64_t               iCurNumPacketsSent;
+        uint64_t               iCurNumBytesSent;
+
+        CurSocket.GetTrafficCounters ( iCurNumPacketsRec,
+                                       iCurNumBytesRec,
+                                       iCurNumPacketsSent,
+                                       iCurNumBytesSent );
+
+        iNumPacketsRec  += iCurNumPacketsRec;
+        iNumBytesRec    += iCurNumBytesRec;
+        iNumPacketsSent += iCurNumPacketsSent;
+        iNumBytesSent   += iCurNumBytesSent;
+        iNumProtQueueOv += CurSocket.GetNumProtMessageQueueOverflows();
+    }
+
+    streamMetrics << "# HELP jamulus_network_received_packets_total Received UDP packets.\n"
+        "# TYPE jamulus_network_received_packets_total counter\n"
+        "jamulus_network_received_packets_total " << iNumPacketsRec << "\n";
+
+    streamMetrics << "# HELP jamulus_network_received_bytes_total Received UDP payload bytes.\n"
+        "# TYPE jamulus_network_received_bytes_total counter\n"
+        "jamulus_network_received_bytes_total " << iNumBytesRec << "\n";
+
+    streamMetrics << "# HELP jamulus_network_sent_packets_total Sent UDP packets.\n"
+        "# TYPE jamulus_network_sent_packets_total counter\n"
+        "jamulus_network_sent_packets_total " << iNumPacketsSent << "\n";
+
+    streamMetrics << "# HELP jamulus_network_sent_bytes_total Sent UDP payload bytes.\n"
+        "# TYPE jamulus_network_sent_bytes_total counter\n"
+        "jamulus_network_sent_bytes_total " << iNumBytesSent << "\n";
+
+    streamMetrics << "# HELP jamulus_network_protocol_queue_overflows_total Received protocol messages which did not fit in the message queue.\n"
+        "# TYPE jamulus_network_protocol_queue_overflows_total counter\n"
+        "jamulus_network_protocol_queue_overflows_total " << iNumProtQueueOv << "\n";
+
+    // jitter buffers of the connected channels (the counters are cumulative
+    // over all connections which used the channel), the series are only
+    // labeled with the channel ID: the client names are personal data and
+    // would create a new series for each name
+    QString strJitBufFrames, strJitBufAuto, strAutoChanges, strUnderruns, strOverruns;
+
+    for ( int i = 0; i < iMaxNumChannels; i++ )
+    {
+        if ( vecChannels[i].IsConnected() )
+        {
+            const QString strLabels = QString ( "{channel=\"%1\"} " ).arg ( i );
+
+            strJitBufFrames += "jamulus_channel_jitter_buffer_frames" + strLabels +
+                QString::number ( vecChannels[i].GetSockBufNumFrames() ) + "\n";
+
+            strJitBufAuto += "jamulus_channel_jitter_buffer_auto" + strLabels +
+                QString::number ( vecChannels[i].GetDoAutoSockBufSize() ? 1 : 0 ) + "\n";
+
+            strAutoChanges += "jamulus_channel_jitter_buffer_auto_changes_total" + strLabels +
+                QString::number ( vecChannels[i].GetBufNumAutoSettingChanges() ) + "\n";
+
+            strUnderruns += "jamulus_channel_jitter_buffer_underruns_total" + strLabels +
+                QString::number ( vecChannels[i].GetBufNumUnderruns() ) + "\n";
+
+            strOverruns += "jamulus_channel_jitter_buffer_overruns_total" + strLabels +
+                QString::number ( vecChannels[i].GetBufNumOverruns() ) + "\n";
+        }
+    }
+
+    streamMetrics << "# HELP jamulus_channel_jitter_buffer_frames Jitter buffer size of the channel in blocks.\n"
+        "# TYPE jamulus_channel_jitter_buffer_frames gauge\n" << strJitBufFrames;
+
+    streamMetrics << "# HELP jamulus_channel_jitter_buffer_auto Whether the jitter buffer size of the channel is set automatically.\n"
+        "# TYPE jamulus_channel_jitter_buffer_auto gauge\n" << strJitBufAuto;
+
+    streamMetrics << "# HELP jamulus_channel_jitter_buffer_auto_changes_total Changes of the automatic jitter buffer size decision.\n"
+        "# TYPE jamulus_channel_jitter_buffer_auto_changes_total counter\n" << strAutoChanges;
+
+    streamMetrics << "# HELP jamulus_channel_jitter_buffer_underruns_total Ticks without an audio block in the jitter buffer.\n"
+        "# TYPE jamulus_channel_jitter_buffer_underruns_total counter\n" << strUnderruns;
+
+    streamMetrics << "# HELP jamulus_channel_jitter_buffer_overruns_total Received audio packets dropped because the jitter buffer was full.\n"
+        "# TYPE jamulus_channel_jitter_buffer_overruns_total counter\n" << strOverruns;
+
+    // jam recorder
+    streamMetrics << "# HELP jamulus_recorder_recording Whether the jam recorder is enabled.\n"
+        "# TYPE jamulus_recorder_recording gauge\n"
+        "jamulus_recorder_recording " << ( GetRecordingEnabled() ? 1 : 0 ) << "\n";
+
+    streamMetrics << "# HELP jamulus_recorder_queued_frames Audio frames waiting for the jam recorder thread.\n"
+        "# TYPE jamulus_recorder_queued_frames gauge\n"
+        "jamulus_recorder_queued_frames " << JamController.GetNumQueuedFrames() << "\n";
+
+    streamMetrics.flush();
+
+    return strMetrics;
+}
+
 void CServer::SetEnableRecording ( bool bNewEnableRecording )
 {
     JamController.SetEnableRecording ( bNewEnableRecording, IsRunning() );
@@ -1619,10 +3265,8 @@ void CServer::customEvent ( QEvent* pEvent )
     }
 }
 
-/// @brief Compute frame peak level for each client
+/// @brief Compute the peak level for each client, returns true if the levels must be sent
 bool CServer::CreateLevelsForAllConChannels ( const int                        iNumClients,
-                                              const CVector<int>&              vecNumAudioChannels,
-                                              const CVector<CVector<int16_t> > vecvecsData,
                                               CVector<uint16_t>&               vecLevelsOut )
 {
     bool bLevelsWereUpdated = false;
@@ -1635,15 +3279,45 @@ bool CServer::CreateLevelsForAllConChannels ( const int                        i
 
         for ( int j = 0; j < iNumClients; j++ )
         {
-            // update and get signal level for meter in dB for each channel
+            // update and get signal level for meter in dB for each channel (the
+            // peaks are collected in the decoding of each timer tick)
             const double dCurSigLevelForMeterdB = vecChannels[vecChanIDsCurConChan[j]].
-                UpdateAndGetLevelForMeterdB ( vecvecsData[j],
-                                              iServerFrameSizeSamples,
-                                              vecNumAudioChannels[j] > 1 );
+                UpdateAndGetLevelForMeterdB();
 
             // map value to integer for transmission via the protocol (4 bit available)
             vecLevelsOut[j] = static_cast<uint16_t> ( ceil ( dCurSigLevelForMeterdB ) );
         }
+
+        // only send the levels if they have changed since the last sent levels,
+        // in a quiet session most of the updates can be skipped (the levels
+        // are always sent if the connected channels changed or a client has
+        // just opted in so that it does not wait for the keep alive update)
+        bool bLevelsChanged = ( iNumClients != iNumChannelLevelsSent ) || bNewChannelLevelsSubscriber;
+
+        for ( int j = 0; ( j < iNumClients ) && !bLevelsChanged; j++ )
+        {
+            bLevelsChanged = ( vecChanIDsCurConChan[j] != vecChannelLevelsSentChanIDs[j] ) ||
+                             ( abs ( static_cast<int> ( vecLevelsOut[j] ) -
+                                     static_cast<int> ( vecChannelLevelsSent[j] ) ) >= CHANNEL_LEVEL_MIN_CHANGE );
+        }
+
+        if ( bLevelsChanged || ( iNumSkippedChannelLevels >= CHANNEL_LEVEL_KEEP_ALIVE_UPDATES ) )
+        {
+            for ( int j = 0; j < iNumClients; j++ )
+            {
+                vecChannelLevelsSent[j]        = vecLevelsOut[j];
+                vecChannelLevelsSentChanIDs[j] = vecChanIDsCurConChan[j];
+            }
+
+            iNumChannelLevelsSent       = iNumClients;
+            iNumSkippedChannelLevels    = 0;
+            bNewChannelLevelsSubscriber = false;
+        }
+        else
+        {
+            bLevelsWereUpdated = false;
+            iNumSkippedChannelLevels++;
+        }
     }
 
     // increment the frame counter needed for low frequency update trigger
@@ -29,7 +29,12 @@
 #include <QDateTime>
 #include <QHostAddress>
 #include <QFileInfo>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QScopedPointer>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #ifdef USE_OPUS_SHARED_LIB
 # include "opus/opus_custom.h"
 #else
@@ -41,7 +46,9 @@
 #include "socket.h"
 #include "channel.h"
 #include "util.h"
+#include "mixkernels.h"
 #include "serverlogging.h"
+#include "servermetrics.h"
 #include "serverlist.h"
 #include "recorder/jamcontroller.h"
 
@@ -49,6 +56,27 @@
 // no valid channel number
 #define INVALID_CHANNEL_ID                  ( MAX_NUM_CHANNELS + 1 )
 
+// number of busy-wait iterations of a worker thread before it goes to sleep
+// (also used by the timer thread waiting for the workers to finish)
+#define WORKER_POOL_SPIN_COUNT              4000
+
+// default number of worker threads if no CPU cores are given: one worker for
+// the given number of channels (i.e., no workers for a small server) but at
+// most the given number of workers and at most all CPU cores but one
+#define WORKER_POOL_CHANNELS_PER_WORKER     25
+#define WORKER_POOL_MAX_DEFAULT_WORKERS     4
+
+// channels with a peak level below half of the 16 bit LSB are digitally silent
+// and are not mixed
+#define MIX_SILENCE_THRESHOLD               ( 0.5f / 32768 )
+
+// if the server timer is late by more than this time, the missed ticks are not
+// caught up but the tick schedule is restarted
+#define TIMER_RESYNC_THRESHOLD_MS           100
+
+// interval for checking the timer statistics for missed deadlines
+#define TIMER_STATS_CHECK_INTERVAL_MS       10000
+
 
 /* Classes ********************************************************************/
 #if ( defined ( WIN32 ) || defined ( _WIN32 ) )
@@ -64,6 +92,19 @@ public:
     void Stop();
     bool isActive() const { return Timer.isActive(); }
 
+    // thread settings and timing statistics are not supported by the QTimer
+    // based implementation
+    void SetCPUCore ( const int ) {}
+    void SetRealTimePriority ( const int ) {}
+    int64_t GetCurTickLatenessNs() const { return -1; } // unknown
+    void GetAndResetTimingStats ( int&    iNumMissedDeadlinesOut,
+                                  int&    iNumResyncsOut,
+                                  double& dMaxLatenessMs )
+        { iNumMissedDeadlinesOut = 0; iNumResyncsOut = 0; dMaxLatenessMs = 0; }
+    void GetTotalTimingStats ( uint64_t& iNumMissedDeadlinesOut,
+                               uint64_t& iNumResyncsOut ) const
+        { iNumMissedDeadlinesOut = 0; iNumResyncsOut = 0; }
+
 protected:
     QTimer       Timer;
     CVector<int> veciTimeOutIntervals;
@@ -87,6 +128,8 @@ signals:
 #  include <sys/time.h>
 # endif
 
+// The timeout signal is emitted in the timer thread itself, i.e., a directly
+// connected slot runs with the priority of the timer thread.
 class CHighPrecisionTimer : public QThread
 {
     Q_OBJECT
@@ -98,10 +141,39 @@ public:
     void Stop();
     bool isActive() { return bRun; }
 
+    // CPU core of the timer thread (-1 = no pinning) and SCHED_FIFO priority
+    // (0 = no real-time scheduling), must be set before the timer is started
+    void SetCPUCore ( const int iNewCPUCore ) { iCPUCore = iNewCPUCore; }
+    void SetRealTimePriority ( const int iNewPriority ) { iRealTimePriority = iNewPriority; }
+
+    // lateness of the start of the current tick relative to its deadline (must
+    // be called in the timer thread)
+    int64_t GetCurTickLatenessNs() const { return iCurTickLatenessNs; }
+
+    // returns the number of ticks which finished after the deadline of the
+    // next tick and the maximum wake-up lateness since the last call
+    void GetAndResetTimingStats ( int&    iNumMissedDeadlinesOut,
+                                  int&    iNumResyncsOut,
+                                  double& dMaxLatenessMs );
+
+    // cumulative counters since the creation of the timer
+    void GetTotalTimingStats ( uint64_t& iNumMissedDeadlinesOut,
+                               uint64_t& iNumResyncsOut ) const;
+
 protected:
     virtual void run();
 
-    bool bRun;
+    std::atomic<bool> bRun;
+    int               iCPUCore;
+    int               iRealTimePriority;
+
+    // timing statistics (written by the timer thread)
+    std::atomic<int>      iNumMissedDeadlines;
+    std::atomic<int>      iNumResyncs;
+    std::atomic<int64_t>  iMaxLatenessNs;
+    std::atomic<uint64_t> iTotalNumMissedDeadlines;
+    std::atomic<uint64_t> iTotalNumResyncs;
+    int64_t               iCurTickLatenessNs;
 
 # if defined ( __APPLE__ ) || defined ( __MACOSX )
     uint64_t Delay;
@@ -117,71 +189,279 @@ signals:
 #endif
 
 
-template<unsigned int slotId>
-class CServerSlots : public CServerSlots<slotId - 1>
+class CServer; // forward declaration of CServer
+
+// CPU placement and scheduling settings of the server threads and memory
+// locking (set by command line options)
+class CServerThreadConfig
 {
 public:
-    void OnSendProtMessCh ( CVector<uint8_t> mess ) { SendProtMessage ( slotId - 1,  mess ); }
-    void OnReqConnClientsListCh()  { CreateAndSendChanListForThisChan ( slotId - 1 ); }
+    CServerThreadConfig() :
+        bPinRecvThreads  ( false ),
+        iMixerCPUCore    ( -1 ),
+        iRTPriority      ( 0 ),
+        iMixerRTPriority ( 0 ),
+        bLockMemory      ( false ) {}
+
+    bool         bPinRecvThreads;    // pin receive threads to the last CPU cores
+    CVector<int> veciRecvCPUCores;   // CPU cores of the receive threads
+    CVector<int> veciWorkerCPUCores; // CPU cores of the worker threads
+    int          iMixerCPUCore;      // CPU core of the timer thread
+    int          iRTPriority;        // SCHED_FIFO priority of the server threads
+    int          iMixerRTPriority;   // SCHED_FIFO priority of the timer thread
+    bool         bLockMemory;        // lock the memory with mlockall
+};
+
+// The per-client mix, encode and send processing of a server timer tick is
+// distributed over a pool of worker threads. The threads are created once
+// and are kept alive for the life time of the server to avoid the thread
+// creation overhead on each tick. A worker busy-waits a short time for the
+// next tick and goes to sleep afterwards so that an idle server does not
+// consume CPU.
+class CServerWorkerPool
+{
+public:
+    CServerWorkerPool ( CServer* pNServer );
+    virtual ~CServerWorkerPool() { Stop(); }
+
+    // if no CPU cores are given, the workers are pinned automatically if we
+    // have enough CPU cores
+    void Start ( const int           iNewNumWorkers,
+                 const CVector<int>& veciCPUCores,
+                 const int           iNewRTPriority );
+    void Stop();
+    int  GetNumWorkers() { return vecpWorkerThreads.Size(); }
+
+    // processes the items 0, ..., iNewNumItems - 1 using the calling thread
+    // and all worker threads, returns when all items are processed
+    void Process ( const int iNewNumItems );
 
-    void OnChatTextReceivedCh ( QString strChatText )
+protected:
+    class CWorkerThread : public QThread
     {
-        CreateAndSendChatTextForAllConChannels ( slotId - 1, strChatText );
-    }
+    public:
+        CWorkerThread ( CServerWorkerPool* pNewPool,
+                        const uint32_t     iNewGeneration,
+                        const int          iNewThreadIdx,
+                        const int          iNewCPUCore ) :
+          pPool ( pNewPool ), iStartGeneration ( iNewGeneration ), iThreadIdx ( iNewThreadIdx ),
+          iCPUCore ( iNewCPUCore ) {}
+
+    protected:
+        virtual void run() { pPool->WorkerLoop ( iStartGeneration, iThreadIdx, iCPUCore ); }
+
+        CServerWorkerPool* pPool;
+        uint32_t           iStartGeneration;
+        int                iThreadIdx;
+        int                iCPUCore;
+    };
+
+    // the calling thread of Process() has the thread index 0, the worker
+    // threads have the indices 1, ..., number of workers
+    void WorkerLoop ( uint32_t  iLastGeneration,
+                      const int iThreadIdx,
+                      const int iCPUCore );
+    void ProcessItems ( const int iThreadIdx );
+
+    CServer*                pServer;
+    CVector<CWorkerThread*> vecpWorkerThreads;
+    int                     iRTPriority;
+
+    std::atomic<bool>       bRun;
+    std::atomic<uint32_t>   iGeneration;
+    std::atomic<int>        iNumItems;
+    std::atomic<int>        iNextItem;
+    std::atomic<int>        iNumWorkersDone;
+    std::atomic<int>        iNumSleepingWorkers;
+    QMutex                  MutexWakeUp;
+    QWaitCondition          WakeUpCondition;
+
+    // the calling thread of Process() sleeps if the workers do not finish
+    // within the busy-wait time (e.g. if a worker was preempted)
+    std::atomic<bool>       bWaitingForWorkers;
+    QMutex                  MutexDone;
+    QWaitCondition          DoneCondition;
+};
 
-    void OnMuteStateHasChangedCh ( int iChanID, bool bIsMuted )
+
+// Timing statistics of the stages of the server timer tick. Each thread which
+// takes part in the tick processing has its own set of histograms (index 0 is
+// the timer thread, the worker threads follow) so that no synchronization is
+// required for recording. The per tick stages are recorded once per tick, the
+// per mix group stages once per group of clients with an identical mix.
+class CServerTickStats
+{
+public:
+    enum ETickStage
+    {
+        TS_TICK_LATENESS, // start of the tick relative to its deadline
+        TS_TICK,          // processing of the complete tick
+        TS_CHAN_SCAN,     // scan for connected channels
+        TS_JITBUF_GET,    // jitter buffer get of all channels
+        TS_DECODE,        // decoding of all channels
+        TS_LEVELS,        // channel level calculation
+        TS_FULL_MIX,      // common mixes of all clients
+        TS_MIX,           // mix of a mix group
+        TS_ENCODE,        // encoding of a mix group
+        TS_SEND,          // sending of the packets of a mix group
+        TS_SEND_FLUSH,    // sending of the queued packets of the tick
+        TS_NUM_STAGES
+    };
+
+    CServerTickStats() : iNumThreads ( 0 ) {}
+
+    void Init ( const int iNewNumThreads );
+
+    void Add ( const int        iThreadIdx,
+               const ETickStage eStage,
+               const int64_t    iTimeNs )
     {
-        CreateOtherMuteStateChanged ( slotId - 1, iChanID, bIsMuted );
+        vecHistograms[iThreadIdx * TS_NUM_STAGES + eStage].Add ( iTimeNs );
     }
 
-    void OnServerAutoSockBufSizeChangeCh ( int iNNumFra )
+    // cumulative histogram of a stage merged over all threads
+    void GetSnapshot ( const ETickStage   eStage,
+                       CVector<uint64_t>& veciSnapCounts,
+                       uint64_t&          iSnapSumNs ) const;
+
+    // text report of all stages since the start of the server or since the
+    // last interval report (must always be called by the same thread)
+    QString GetReport ( const bool bSinceLastReport );
+
+    static QString GetStageName ( const ETickStage eStage );
+
+protected:
+    int                                   iNumThreads;
+    QScopedArrayPointer<CTimingHistogram> vecHistograms;
+
+    // snapshots of the last interval report
+    CVector<CVector<uint64_t> >           vecveciLastCounts;
+    CVector<uint64_t>                     veciLastSumNs;
+};
+
+
+// Address to channel index used for the demultiplexing of the received audio
+// packets. It is a flat open addressing hash table (linear probing) keyed on
+// the IPv4 address and the port. The table has at least twice as many slots
+// as channels so that it never runs full and the probe sequences are short.
+class CChanAddrIndex
+{
+public:
+    CChanAddrIndex() : iNumBits ( 0 ), iMask ( 0 ) {}
+
+    void Init ( const int iMaxNumChannels );
+
+    // returns false if the address cannot be used as a key (no IPv4 address)
+    static bool GetKey ( const CHostAddress& Addr, uint64_t& iKey );
+
+    int  Find ( const uint64_t iKey ) const;
+    void Insert ( const uint64_t iKey, const int iChanID );
+    void Remove ( const uint64_t iKey );
+
+protected:
+    int GetHomeSlot ( const uint64_t iKey ) const
     {
-        CreateAndSendJitBufMessage ( slotId - 1, iNNumFra );
+        // Fibonacci hashing
+        return static_cast<int> ( ( iKey * UINT64_C ( 0x9E3779B97F4A7C15 ) ) >> ( 64 - iNumBits ) );
     }
 
+    CVector<uint64_t> vecKeys; // zero marks an empty slot
+    CVector<int>      vecChanIDs;
+    int               iNumBits;
+    int               iMask;
+};
+
+
+// Pool of the Opus codec states of the server. A channel only gets an encoder
+// and a decoder for the codec and number of audio channels it actually uses.
+// The states are created on demand and are returned to the pool on
+// disconnection so that they can be reused by other channels. The two Opus
+// modes are immutable and are shared by all codec states. All functions must
+// be called with the server mutex locked.
+class COpusCodecPool
+{
+public:
+    COpusCodecPool();
+    virtual ~COpusCodecPool();
+
+    void Init ( const int iNewNumChannels );
+
+    // assigns codec states for the given codec and number of audio channels
+    // to the channel (nothing happens if the channel already has them)
+    void Assign ( const int           iChanID,
+                  const EAudComprType eAudComprType,
+                  const int           iNumAudioChannels );
+
+    // returns the codec states of the channel to the pool, the states may
+    // still be in use until the current server timer tick is finished
+    void Release ( const int iChanID );
+
+    // makes the released codec states available for reuse, must only be
+    // called if none of them is in use anymore
+    void Recycle();
+
+    OpusCustomEncoder* GetEncoder ( const int iChanID ) const { return vecpEncoders[iChanID]; }
+    OpusCustomDecoder* GetDecoder ( const int iChanID ) const { return vecpDecoders[iChanID]; }
+
 protected:
-    virtual void SendProtMessage ( int              iChID,
-                                   CVector<uint8_t> vecMessage ) = 0;
+    // Opus or Opus64, each mono or stereo
+    enum { NUM_CODEC_TYPES = 4 };
 
-    virtual void CreateAndSendChanListForThisChan ( const int iCurChanID ) = 0;
+    static int GetCodecType ( const EAudComprType eAudComprType,
+                              const int           iNumAudioChannels );
 
-    virtual void CreateAndSendChatTextForAllConChannels ( const int      iCurChanID,
-                                                          const QString& strChatText ) = 0;
+    void CreateCodec ( const int           iCodecType,
+                       OpusCustomEncoder*& pEncoder,
+                       OpusCustomDecoder*& pDecoder );
 
-    virtual void CreateOtherMuteStateChanged ( const int  iCurChanID,
-                                               const int  iOtherChanID,
-                                               const bool bIsMuted ) = 0;
+    OpusCustomMode*                  OpusMode;
+    OpusCustomMode*                  Opus64Mode;
 
-    virtual void CreateAndSendJitBufMessage ( const int iCurChanID,
-                                              const int iNNumFra ) = 0;
-};
+    // codec states assigned to the channels
+    CVector<OpusCustomEncoder*>      vecpEncoders;
+    CVector<OpusCustomDecoder*>      vecpDecoders;
+    CVector<int>                     vecCodecTypes;
 
-template<>
-class CServerSlots<0> {};
+    // unused codec states for each codec type
+    CVector<OpusCustomEncoder*>      vecpFreeEncoders[NUM_CODEC_TYPES];
+    CVector<OpusCustomDecoder*>      vecpFreeDecoders[NUM_CODEC_TYPES];
+    int                              iNumFree[NUM_CODEC_TYPES];
 
+    // released codec states which are not yet recycled
+    std::vector<OpusCustomEncoder*>  vecpReleasedEncoders;
+    std::vector<OpusCustomDecoder*>  vecpReleasedDecoders;
+    std::vector<int>                 vecReleasedCodecTypes;
+};
 
-class CServer :
-        public QObject,
-        public CServerSlots<MAX_NUM_CHANNELS>
+
+class CServer : public QObject
 {
     Q_OBJECT
 
+    friend class CServerWorkerPool;
+
 public:
-    CServer ( const int          iNewMaxNumChan,
-              const int          iMaxDaysHistory,
-              const QString&     strLoggingFileName,
-              const quint16      iPortNumber,
-              const QString&     strHTMLStatusFileName,
-              const QString&     strHistoryFileName,
-              const QString&     strServerNameForHTMLStatusFile,
-              const QString&     strCentralServer,
-              const QString&     strServerInfo,
-              const QString&     strNewWelcomeMessage,
-              const QString&     strRecordingDirName,
-              const bool         bNCentServPingServerInList,
-              const bool         bNDisconnectAllClientsOnQuit,
-              const bool         bNUseDoubleSystemFrameSize,
-              const ELicenceType eNLicenceType );
+    CServer ( const int                  iNewMaxNumChan,
+              const int                  iMaxDaysHistory,
+              const QString&             strLoggingFileName,
+              const quint16              iPortNumber,
+              const QString&             strHTMLStatusFileName,
+              const QString&             strHistoryFileName,
+              const QString&             strServerNameForHTMLStatusFile,
+              const QString&             strCentralServer,
+              const QString&             strServerInfo,
+              const QString&             strNewWelcomeMessage,
+              const QString&             strRecordingDirName,
+              const bool                 bNCentServPingServerInList,
+              const bool                 bNDisconnectAllClientsOnQuit,
+              const bool                 bNUseDoubleSystemFrameSize,
+              const bool                 bNUseMultithreading,
+              const int                  iNumRecvSockets,
+              const bool                 bUseIoUring,
+              const CServerThreadConfig& ThreadConfig,
+              const int                  iNTickStatsInterval,
+              const QString&             strMetricsAddress,
+              const ELicenceType         eNLicenceType );
 
     virtual ~CServer();
 
@@ -192,6 +472,7 @@ public:
     bool PutAudioData ( const CVector<uint8_t>& vecbyRecBuf,
                         const int               iNumBytesRead,
                         const CHostAddress&     HostAdr,
+                        const int               iSocketIdx,
                         int&                    iCurChanID );
 
     void GetConCliParam ( CVector<CHostAddress>& vecHostAddresses,
@@ -199,6 +480,9 @@ public:
                           CVector<int>&          veciJitBufNumFrames,
                           CVector<int>&          veciNetwFrameSizeFact );
 
+    // metrics of the server in the Prometheus text format
+    QString GetMetrics();
+
 
     // Jam recorder ------------------------------------------------------------
     bool GetRecorderInitialised() { return JamController.GetRecorderInitialised(); }
@@ -277,10 +561,13 @@ protected:
 
     int GetFreeChan();
     int FindChannel ( const CHostAddress& CheckAddr );
+    int FindChannelInIndex ( const int iSocketIdx, const uint64_t iAddrKey );
+    void UpdateChanAddrIndex ( const int iSocketIdx, const int iChanID, const uint64_t iAddrKey );
     int GetNumberOfConnectedClients();
     CVector<CChannelInfo> CreateChannelList();
 
     virtual void CreateAndSendChanListForAllConChannels();
+
     virtual void CreateAndSendChanListForThisChan ( const int iCurChanID );
 
     virtual void CreateAndSendChatTextForAllConChannels ( const int      iCurChanID,
@@ -296,18 +583,49 @@ protected:
     virtual void SendProtMessage ( int              iChID,
                                    CVector<uint8_t> vecMessage );
 
-    template<unsigned int slotId>
-    inline void connectChannelSignalsToServerSlots();
+    void ConnectChannelSignals ( const int iChanID );
 
     void WriteHTMLChannelList();
 
-    void ProcessData ( const CVector<CVector<int16_t> >& vecvecsData,
-                       const CVector<double>&            vecdGains,
-                       const CVector<double>&            vecdPannings,
-                       const CVector<int>&               vecNumAudioChannels,
-                       CVector<int16_t>&                 vecsOutData,
-                       const int                         iCurNumAudChan,
-                       const int                         iNumClients );
+    void PrintTickStatsReport ( const QString& strPeriod,
+                                const QString& strReport );
+
+    void CreateMixGroups ( const int iNumClients );
+
+    void AssignMixGroupStreams ( const int iNumClients );
+
+    void MixEncodeTransmitData ( const int iMixGroup,
+                                 const int iThreadIdx );
+
+    void ProcessData ( const CVector<CVector<float> >& vecvecfData,
+                       const CVector<double>&          vecdGains,
+                       const CVector<double>&          vecdPannings,
+                       const CVector<int>&             vecNumAudioChannels,
+                       CVector<float>&                 vecfIntermProcBuf,
+                       CVector<float>&                 vecfOutData,
+                       const int                       iCurNumAudChan,
+                       const CVector<int>&             vecActiveClients,
+                       const int                       iNumActiveClients );
+
+    void ProcessDataFromFullMix ( const CVector<float>& vecfFullMix,
+                                  const CVector<float>& vecfOwnData,
+                                  const double          dOwnGain,
+                                  const double          dOwnPan,
+                                  const double          dOwnFullMixGain,
+                                  const int             iOwnNumAudChan,
+                                  const bool            bOwnIsSilent,
+                                  CVector<float>&       vecfIntermProcBuf,
+                                  CVector<float>&       vecfOutData,
+                                  const int             iCurNumAudChan );
+
+    void MixData ( const CVector<CVector<float> >& vecvecfData,
+                   const CVector<double>&          vecdGains,
+                   const CVector<double>&          vecdPannings,
+                   const CVector<int>&             vecNumAudioChannels,
+                   CVector<float>&                 vecfIntermProcBuf,
+                   const int                       iCurNumAudChan,
+                   const CVector<int>&             vecActiveClients,
+                   const int                       iNumActiveClients );
 
     virtual void customEvent ( QEvent* pEvent );
 
@@ -316,49 +634,89 @@ protected:
     int                        iServerFrameSizeSamples;
 
     bool CreateLevelsForAllConChannels  ( const int                        iNumClients,
-                                          const CVector<int>&              vecNumAudioChannels,
-                                          const CVector<CVector<int16_t> > vecvecsData,
                                           CVector<uint16_t>&               vecLevelsOut );
 
     // do not use the vector class since CChannel does not have appropriate
-    // copy constructor/operator
-    CChannel                   vecChannels[MAX_NUM_CHANNELS];
+    // copy constructor/operator (the channels are allocated for the maximum
+    // number of channels given on the command line)
+    QScopedArrayPointer<CChannel> vecChannels;
     int                        iMaxNumChannels;
+
+    // address to channel index, each network receive socket has its own
+    // index which is only accessed by its receive thread
+    CVector<CChanAddrIndex>    vecChanAddrIndices;
+    CVector<CVector<uint64_t> > vecvecChanAddrKeys; // key of each channel in the index of each socket (zero: none)
+    QScopedArrayPointer<std::atomic<uint64_t> > vecChanAssignedAddrKeys; // key of the address assigned to each channel
     CProtocol                  ConnLessProtocol;
     QMutex                     Mutex;
 
     // audio encoder/decoder
-    OpusCustomMode*            Opus64Mode[MAX_NUM_CHANNELS];
-    OpusCustomEncoder*         Opus64EncoderMono[MAX_NUM_CHANNELS];
-    OpusCustomDecoder*         Opus64DecoderMono[MAX_NUM_CHANNELS];
-    OpusCustomEncoder*         Opus64EncoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomDecoder*         Opus64DecoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomMode*            OpusMode[MAX_NUM_CHANNELS];
-    OpusCustomEncoder*         OpusEncoderMono[MAX_NUM_CHANNELS];
-    OpusCustomDecoder*         OpusDecoderMono[MAX_NUM_CHANNELS];
-    OpusCustomEncoder*         OpusEncoderStereo[MAX_NUM_CHANNELS];
-    OpusCustomDecoder*         OpusDecoderStereo[MAX_NUM_CHANNELS];
-    CConvBuf<int16_t>          DoubleFrameSizeConvBufIn[MAX_NUM_CHANNELS];
-    CConvBuf<int16_t>          DoubleFrameSizeConvBufOut[MAX_NUM_CHANNELS];
+    COpusCodecPool              OpusCodecPool;
+    CVector<OpusCustomEncoder*> vecpOpusEncoders; // encoders of the connected channels in the current tick
+    CVector<CConvBuf<float> >   DoubleFrameSizeConvBufIn;
+    CVector<CConvBuf<float> >   DoubleFrameSizeConvBufOut;
 
     CVector<QString>           vstrChatColors;
     CVector<int>               vecChanIDsCurConChan;
 
     CVector<CVector<double> >  vecvecdGains;
     CVector<CVector<double> >  vecvecdPannings;
-    CVector<CVector<int16_t> > vecvecsData;
+    CVector<CVector<float> >   vecvecfData;
+    CVector<CVector<int16_t> > vecvecsData; // only for the jam recorder
+    CVector<float>             vecfPeakLevels;
+    CVector<int>               vecActiveClients;
+    int                        iNumActiveClients;
     CVector<int>               vecNumAudioChannels;
     CVector<int>               vecNumFrameSizeConvBlocks;
     CVector<int>               vecUseDoubleSysFraSizeConvBuf;
     CVector<EAudComprType>     vecAudioComprType;
-    CVector<CVector<int16_t> > vecvecsSendData;
+    CVector<CVector<float> >   vecvecfIntermProcBuf;
+    CVector<double>            vecdFadeInGains;
+    CVector<double>            vecdCenterPannings;
+    CVector<int>               vecUseFullMix;
+    CVector<float>             vecfFullMixMono;
+    CVector<float>             vecfFullMixStereo;
+
+    // clients with identical mixes are grouped so that the mix is only
+    // calculated and encoded once for the entire group (the first client of
+    // the group is the group leader)
+    CVector<int>               vecNetwFrameSizes;
+    CVector<uint64_t>          vecMixSignatures;
+    CVector<int>               vecMixGroupLeaders;
+    CVector<int>               vecMixGroupLastMembers;
+    CVector<int>               vecMixGroupNextMembers;
+    int                        iNumMixGroups;
+
+    // Each client decodes the continuous stream of one encoder. To avoid
+    // artifacts, a client keeps the stream it received in the last tick as
+    // long as possible (stored per channel ID: the channel whose encoder
+    // produced the stream and the encoder itself).
+    CVector<int>                vecStreamSrcChanIDs;
+    CVector<OpusCustomEncoder*> vecpStreamSrcEncoders;
+    CVector<int>                vecConChanIdx;     // client index of each channel ID in the current tick
+    CVector<int>                vecStreamSrcIdx;   // client index of the stream source in the current tick
+    CVector<int>                vecStreamSrcCnt;
+    CVector<int>                vecIsStreamSrc;
+    CVector<CVector<float> >   vecvecfSendData;
     CVector<CVector<uint8_t> > vecvecbyCodedData;
 
-    // Channel levels
+    // Channel levels (the message is only encoded once per update)
     CVector<uint16_t>          vecChannelLevels;
-
-    // actual working objects
+    CVector<uint16_t>          vecChannelLevelsSent;
+    CVector<int>               vecChannelLevelsSentChanIDs;
+    int                        iNumChannelLevelsSent;
+    int                        iNumSkippedChannelLevels;
+    bool                       bNewChannelLevelsSubscriber;
+    CProtocol::CPreparedMessage ChannelLevelListMess;
+
+    // state of the current timer tick which is shared with the worker threads
+    bool                       bCurSendChannelLevels;
+    CServerWorkerPool          WorkerPool;
+
+    // actual working objects (the first socket is used for sending, the
+    // additional sockets share its port and are only used for receiving)
     CHighPrioSocket            Socket;
+    CVector<CHighPrioSocket*>  vecpAddRecSockets;
 
     // logging
     CServerLogging             Logging;
@@ -372,6 +730,16 @@ protected:
     QString                    strServerNameWithPort;
 
     CHighPrecisionTimer        HighPrecisionTimer;
+    QTimer                     TimerCheckTimingStats;
+    std::atomic<bool>          bStopRequested;
+
+    // timing statistics of the tick stages
+    CServerTickStats           TickStats;
+    QTimer                     TimerTickStatsReport;
+    int                        iTickStatsInterval;
+
+    // metrics listener
+    CServerMetrics             Metrics;
 
     // server list
     CServerListManager         ServerListManager;
@@ -384,6 +752,7 @@ protected:
 
     // messaging
     QString                    strWelcomeMessage;
+    CProtocol::CPreparedMessage WelcomeMessageMess;
     ELicenceType               eLicenceType;
     bool                       bDisconnectAllClientsOnQuit;
 
@@ -394,6 +763,10 @@ signals:
     void Stopped();
     void ClientDisconnected ( const int iChID );
     void SvrRegStatusChanged();
+
+    // requests from the timer thread which are processed in the main thread
+    void StopRequested();
+    void ChanListUpdateRequired();
     void AudioFrame ( const int              iChID,
                       const QString          stChName,
                       const CHostAddress     RecHostAddr,
@@ -481,6 +854,12 @@ public slots:
     void OnAboutToQuit();
 
     void OnHandledSignal ( int sigNum );
+
+    void OnStopRequested();
+
+    void OnTimerCheckTimingStats();
+
+    void OnTimerTickStatsReport();
 };
 
 Q_DECLARE_METATYPE(CVector<int16_t>)
@@ -197,15 +197,8 @@ lvwClients->setMinimumWidth ( 170 + 130 + 60 + 205 );
 lvwClients->setMinimumHeight ( 140 );
 
 
-    // insert items in reverse order because in Windows all of them are
-    // always visible -> put first item on the top
-    vecpListViewItems.Init ( MAX_NUM_CHANNELS );
-
-    for ( int i = MAX_NUM_CHANNELS - 1; i >= 0; i-- )
-    {
-        vecpListViewItems[i] = new QTreeWidgetItem ( lvwClients );
-        vecpListViewItems[i]->setHidden ( true );
-    }
+    // the list view items are created on demand in the timer since the server
+    // may support many channels
 
     // central server address type combo box
     cbxCentServAddrType->clear();
@@ -570,6 +563,17 @@ void CServerDlg::OnTimer()
         {
             if ( !( vecHostAddresses[i].InetAddr == QHostAddress ( static_cast<quint32> ( 0 ) ) ) )
             {
+                // create the missing list view items up to the current channel
+                // (appended so that the first item is on the top)
+                while ( vecpListViewItems.Size() <= i )
+                {
+                    QTreeWidgetItem* pNewListViewItem = new QTreeWidgetItem();
+
+                    pNewListViewItem->setHidden ( true );
+                    lvwClients->addTopLevelItem ( pNewListViewItem );
+                    vecpListViewItems.Add ( pNewListViewItem );
+                }
+
                 // IP, port number
                 vecpListViewItems[i]->setText ( 0,
                     vecHostAddresses[i].toString ( CHostAddress::SM_IP_PORT ) );
@@ -583,7 +587,7 @@ void CServerDlg::OnTimer()
 
                 vecpListViewItems[i]->setHidden ( false );
             }
-            else
+            else if ( i < vecpListViewItems.Size() )
             {
                 vecpListViewItems[i]->setHidden ( true );
             }
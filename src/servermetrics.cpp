@@ -0,0 +1,194 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2020
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#include "servermetrics.h"
+#include "server.h"
+
+
+/* Implementation *************************************************************/
+bool CServerMetrics::Start ( const QString& strListenAddress )
+{
+    bool          bIsPort;
+    const quint16 iPort = strListenAddress.toUShort ( &bIsPort );
+
+    if ( bIsPort )
+    {
+        QObject::connect ( &TcpServer, &QTcpServer::newConnection,
+            this, &CServerMetrics::OnNewTcpConnection );
+
+        return TcpServer.listen ( QHostAddress::LocalHost, iPort );
+    }
+
+    // remove a stale socket file of a previous run
+    QLocalServer::removeServer ( strListenAddress );
+
+    QObject::connect ( &LocalServer, &QLocalServer::newConnection,
+        this, &CServerMetrics::OnNewLocalConnection );
+
+    return LocalServer.listen ( strListenAddress );
+}
+
+void CServerMetrics::OnNewTcpConnection()
+{
+    while ( TcpServer.hasPendingConnections() )
+    {
+        QTcpSocket* pTcpSocket = TcpServer.nextPendingConnection();
+
+        QObject::connect ( pTcpSocket, &QTcpSocket::disconnected,
+            this, &CServerMetrics::OnDisconnected );
+
+        AddConnection ( pTcpSocket );
+    }
+}
+
+void CServerMetrics::OnNewLocalConnection()
+{
+    while ( LocalServer.hasPendingConnections() )
+    {
+        QLocalSocket* pLocalSocket = LocalServer.nextPendingConnection();
+
+        QObject::connect ( pLocalSocket, &QLocalSocket::disconnected,
+            this, &CServerMetrics::OnDisconnected );
+
+        AddConnection ( pLocalSocket );
+    }
+}
+
+void CServerMetrics::AddConnection ( QIODevice* pDevice )
+{
+    mapRequests.insert ( pDevice, QByteArray() );
+
+    QObject::connect ( pDevice, &QIODevice::readyRead,
+        this, &CServerMetrics::OnReadyRead );
+
+    // the request may already be received
+    ProcessRequest ( pDevice );
+}
+
+void CServerMetrics::OnReadyRead()
+{
+    ProcessRequest ( qobject_cast<QIODevice*> ( sender() ) );
+}
+
+void CServerMetrics::ProcessRequest ( QIODevice* pDevice )
+{
+    if ( ( pDevice == nullptr ) || !mapRequests.contains ( pDevice ) )
+    {
+        return;
+    }
+
+    QByteArray& vecbyRequest = mapRequests[pDevice];
+
+    vecbyRequest += pDevice->readAll();
+
+    // only the request header is evaluated, wait until it is complete
+    if ( !vecbyRequest.contains ( "\r\n\r\n" ) && !vecbyRequest.contains ( "\n\n" ) )
+    {
+        if ( vecbyRequest.size() > MAX_METRICS_REQUEST_SIZE_BYTES )
+        {
+            mapRequests.remove ( pDevice );
+            CloseConnection ( pDevice );
+        }
+
+        return;
+    }
+
+    const QByteArray vecbyResponse = CreateResponse ( vecbyRequest );
+
+    mapRequests.remove ( pDevice );
+
+    pDevice->write ( vecbyResponse );
+    CloseConnection ( pDevice );
+}
+
+void CServerMetrics::CloseConnection ( QIODevice* pDevice )
+{
+    QObject::disconnect ( pDevice, &QIODevice::readyRead,
+        this, &CServerMetrics::OnReadyRead );
+
+    // the sockets are closed after all pending data is written, then the
+    // disconnected signal deletes the socket object
+    QTcpSocket* pTcpSocket = qobject_cast<QTcpSocket*> ( pDevice );
+
+    if ( pTcpSocket != nullptr )
+    {
+        pTcpSocket->disconnectFromHost();
+    }
+    else
+    {
+        QLocalSocket* pLocalSocket = qobject_cast<QLocalSocket*> ( pDevice );
+
+        if ( pLocalSocket != nullptr )
+        {
+            pLocalSocket->disconnectFromServer();
+        }
+    }
+}
+
+void CServerMetrics::OnDisconnected()
+{
+    QIODevice* pDevice = qobject_cast<QIODevice*> ( sender() );
+
+    if ( pDevice != nullptr )
+    {
+        mapRequests.remove ( pDevice );
+        pDevice->deleteLater();
+    }
+}
+
+QByteArray CServerMetrics::CreateResponse ( const QByteArray& vecbyRequest )
+{
+    // request line: [method] [path] [protocol version]
+    const QList<QByteArray> vecRequestLine =
+        vecbyRequest.left ( vecbyRequest.indexOf ( '\n' ) ).trimmed().split ( ' ' );
+
+    QByteArray vecbyStatus;
+    QByteArray vecbyBody;
+
+    if ( ( vecRequestLine.size() < 2 ) || ( vecRequestLine[0] != "GET" ) )
+    {
+        vecbyStatus = "405 Method Not Allowed";
+    }
+    else
+    {
+        // ignore the query parameters
+        const QByteArray vecbyPath = vecRequestLine[1].split ( '?' )[0];
+
+        if ( ( vecbyPath == "/metrics" ) || ( vecbyPath == "/" ) )
+        {
+            vecbyStatus = "200 OK";
+            vecbyBody   = pServer->GetMetrics().toUtf8();
+        }
+        else
+        {
+            vecbyStatus = "404 Not Found";
+        }
+    }
+
+    return "HTTP/1.0 " + vecbyStatus + "\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: " + QByteArray::number ( vecbyBody.size() ) + "\r\n"
+        "Connection: close\r\n"
+        "\r\n" + vecbyBody;
+}
@@ -0,0 +1,77 @@
+/******************************************************************************\
+ * Copyright (c) 2004-2020
+ *
+ * Author(s):
+ *  Volker Fischer
+ *
+ ******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+\******************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QByteArray>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include "global.h"
+
+
+/* Definitions ****************************************************************/
+// maximum size of the header of a metrics request, larger requests are dropped
+#define MAX_METRICS_REQUEST_SIZE_BYTES 8192
+
+
+/* Classes ********************************************************************/
+class CServer; // forward declaration of CServer
+
+// Serves the metrics of the server in the Prometheus text format with a
+// minimal HTTP implementation. The listener only accepts local connections
+// (TCP on the loopback interface or a Unix domain socket). Each request is
+// answered and the connection is closed afterwards.
+class CServerMetrics : public QObject
+{
+    Q_OBJECT
+
+public:
+    CServerMetrics ( CServer* pNServP ) : pServer ( pNServP ) {}
+
+    // a numeric listen address is used as the TCP port on the local host,
+    // otherwise it is the path of a Unix domain socket, returns false if the
+    // listener cannot be started
+    bool Start ( const QString& strListenAddress );
+
+protected:
+    void       AddConnection ( QIODevice* pDevice );
+    void       ProcessRequest ( QIODevice* pDevice );
+    void       CloseConnection ( QIODevice* pDevice );
+    QByteArray CreateResponse ( const QByteArray& vecbyRequest );
+
+    CServer*                      pServer;
+    QTcpServer                    TcpServer;
+    QLocalServer                  LocalServer;
+    QMap<QIODevice*, QByteArray>  mapRequests; // received parts of the requests
+
+public slots:
+    void OnNewTcpConnection();
+    void OnNewLocalConnection();
+    void OnReadyRead();
+    void OnDisconnected();
+};
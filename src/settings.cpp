@@ -27,20 +27,26 @@
 
 /* Implementation *************************************************************/
 void CSettings::Load()
+{
+    QDomDocument IniXMLDocument;
+
+    ReadXMLFile ( IniXMLDocument );
+
+    // read the settings from the given XML file
+    ReadFromXML ( IniXMLDocument );
+}
+
+void CSettings::ReadXMLFile ( QDomDocument& IniXMLDocument )
 {
     // prepare file name for loading initialization data from XML file and read
     // data from file if possible
-    QDomDocument IniXMLDocument;
-    QFile        file ( strFileName );
+    QFile file ( strFileName );
 
     if ( file.open ( QIODevice::ReadOnly ) )
     {
         IniXMLDocument.setContent ( QTextStream ( &file ).readAll(), false );
         file.close();
     }
-
-    // read the settings from the given XML file
-    ReadFromXML ( IniXMLDocument );
 }
 
 void CSettings::Save()
@@ -728,6 +734,56 @@ void CClientSettings::WriteToXML ( QDomDocument& IniXMLDocument )
 
 
 // Server settings -------------------------------------------------------------
+void CServerSettings::LoadThreadConfig ( CServerThreadConfig& ThreadConfig )
+{
+    QDomDocument IniXMLDocument;
+
+    ReadXMLFile ( IniXMLDocument );
+    ReadThreadConfigFromXML ( IniXMLDocument );
+
+    // only use the init-file values which are not given on the command line
+    if ( bLockMemory )
+    {
+        ThreadConfig.bLockMemory = true;
+    }
+
+    if ( ( ThreadConfig.iRTPriority == 0 ) && ( iRTPriority > 0 ) )
+    {
+        ThreadConfig.iRTPriority = iRTPriority;
+    }
+
+    if ( ( ThreadConfig.iMixerRTPriority == 0 ) && ( iMixerRTPriority > 0 ) )
+    {
+        ThreadConfig.iMixerRTPriority = iMixerRTPriority;
+    }
+}
+
+void CServerSettings::ReadThreadConfigFromXML ( const QDomDocument& IniXMLDocument )
+{
+    int  iValue;
+    bool bValue;
+
+    // lock the server memory
+    if ( GetFlagIniSet ( IniXMLDocument, "server", "mlockall", bValue ) )
+    {
+        bLockMemory = bValue;
+    }
+
+    // real-time priority of the server threads (0 means not used)
+    if ( GetNumericIniSet ( IniXMLDocument, "server", "rtprio",
+         0, 99, iValue ) )
+    {
+        iRTPriority = iValue;
+    }
+
+    // real-time priority of the server timer thread (0 means not used)
+    if ( GetNumericIniSet ( IniXMLDocument, "server", "mixerrtprio",
+         0, 99, iValue ) )
+    {
+        iMixerRTPriority = iValue;
+    }
+}
+
 void CServerSettings::ReadFromXML ( const QDomDocument& IniXMLDocument )
 {
     int  iValue;
@@ -796,6 +852,9 @@ if ( GetFlagIniSet ( IniXMLDocument, "server", "defcentservaddr", bValue ) )
     // window position of the main window
     pServer->vecWindowPosMain = FromBase64ToByteArray (
         GetIniSetting ( IniXMLDocument, "server", "winposmain_base64" ) );
+
+    // thread settings (these are only applied on the next server start)
+    ReadThreadConfigFromXML ( IniXMLDocument );
 }
 
 void CServerSettings::WriteToXML ( QDomDocument& IniXMLDocument )
@@ -835,4 +894,13 @@ void CServerSettings::WriteToXML ( QDomDocument& IniXMLDocument )
     // window position of the main window
     PutIniSetting ( IniXMLDocument, "server", "winposmain_base64",
         ToBase64 ( pServer->vecWindowPosMain ) );
+
+    // lock the server memory
+    SetFlagIniSet ( IniXMLDocument, "server", "mlockall", bLockMemory );
+
+    // real-time priority of the server threads
+    SetNumericIniSet ( IniXMLDocument, "server", "rtprio", iRTPriority );
+
+    // real-time priority of the server timer thread
+    SetNumericIniSet ( IniXMLDocument, "server", "mixerrtprio", iMixerRTPriority );
 }
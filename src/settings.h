@@ -45,6 +45,8 @@ public:
     void Save();
 
 protected:
+    void ReadXMLFile ( QDomDocument& IniXMLDocument );
+
     virtual void ReadFromXML ( const QDomDocument& IniXMLDocument ) = 0;
     virtual void WriteToXML  ( QDomDocument& IniXMLDocument )       = 0;
 
@@ -124,14 +126,31 @@ protected:
 class CServerSettings : public CSettings
 {
 public:
-    CServerSettings ( CServer* pNSerP, const QString& sNFiName ) : pServer ( pNSerP )
+    CServerSettings ( const QString& sNFiName ) :
+        pServer          ( nullptr ),
+        bLockMemory      ( false ),
+        iRTPriority      ( 0 ),
+        iMixerRTPriority ( 0 )
         { SetFileName ( sNFiName, DEFAULT_INI_FILE_NAME_SERVER); }
 
+    void SetServer ( CServer* pNSerP ) { pServer = pNSerP; }
+
+    // the thread settings are required before the server object is created,
+    // the command line arguments take precedence over the init-file
+    void LoadThreadConfig ( CServerThreadConfig& ThreadConfig );
+
 protected:
     virtual void ReadFromXML ( const QDomDocument& IniXMLDocument ) override;
     virtual void WriteToXML  ( QDomDocument& IniXMLDocument ) override;
 
+    void ReadThreadConfigFromXML ( const QDomDocument& IniXMLDocument );
+
     CServer* pServer;
+
+    // thread settings as stored in the init-file
+    bool     bLockMemory;
+    int      iRTPriority;
+    int      iMixerRTPriority;
 };
 
 
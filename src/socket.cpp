@@ -27,6 +27,19 @@
 
 
 /* Implementation *************************************************************/
+#ifdef USE_PROT_MESSAGE_QUEUE
+bool CProtMessageNotifier::event ( QEvent* pEvent )
+{
+    if ( pEvent->type() == QEvent::SockAct )
+    {
+        pSocket->ProcessQueuedProtMessages();
+        return true;
+    }
+
+    return QSocketNotifier::event ( pEvent );
+}
+#endif
+
 void CSocket::Init ( const quint16 iPortNumber )
 {
 #ifdef _WIN32
@@ -44,6 +57,85 @@ void CSocket::Init ( const quint16 iPortNumber )
     // allocate memory for network receive and send buffer in samples
     vecbyRecBuf.Init ( MAX_SIZE_BYTES_NETW_BUF );
 
+    iNumPacketsRecTotal.store  ( 0 );
+    iNumBytesRecTotal.store    ( 0 );
+    iNumPacketsSentTotal.store ( 0 );
+    iNumBytesSentTotal.store   ( 0 );
+
+    iNumProtMessageQueueOverflows.store ( 0 );
+
+#ifdef USE_PROT_MESSAGE_QUEUE
+    // allocate the worst case memory for the message body of all queued
+    // protocol messages (the memory is never reallocated since the size of
+    // the body cannot exceed the size of the received datagram)
+    vecbyMesBodyData.reserve ( MAX_SIZE_BYTES_NETW_BUF );
+    vecProtMessages.Init ( PROT_MESSAGE_QUEUE_SIZE );
+
+    for ( int i = 0; i < PROT_MESSAGE_QUEUE_SIZE; i++ )
+    {
+        vecProtMessages[i].vecbyMesBodyData.reserve ( MAX_SIZE_BYTES_NETW_BUF );
+    }
+
+    iProtMessageQueueHead.store     ( 0 );
+    iProtMessageQueueTail.store     ( 0 );
+    bProtMessageWakeUpPending.store ( false );
+
+    // the notifier is created in the main thread and is not a child of this
+    // object so it stays in the main thread when the socket is moved to the
+    // socket thread
+    if ( pipe ( iProtMessagePipe ) != 0 )
+    {
+        throw CGenErr ( "Cannot create the protocol message pipe.", "Network Error" );
+    }
+
+    fcntl ( iProtMessagePipe[0], F_SETFL, fcntl ( iProtMessagePipe[0], F_GETFL ) | O_NONBLOCK );
+    fcntl ( iProtMessagePipe[1], F_SETFL, fcntl ( iProtMessagePipe[1], F_GETFL ) | O_NONBLOCK );
+
+    pProtMessageNotifier.reset ( new CProtMessageNotifier ( iProtMessagePipe[0], this ) );
+#endif
+
+#ifdef USE_IO_URING
+    // the io_uring engine is only used on request (see EnableIoUring)
+    bUseIoUringReceive = false;
+    bUseIoUringSend    = false;
+#endif
+
+#ifdef USE_SENDMMSG
+    // the send queue is only allocated on request (see InitSendQueue)
+    bUseBatchedSend = false;
+    iSendQueueSize  = 0;
+    iNumQueuedPackets.store ( 0 );
+#endif
+
+#ifdef USE_RECVMMSG
+    // The server receives the datagrams of all clients, therefore it pulls all
+    // datagrams which are available with one system call. The message headers
+    // point to a preallocated buffer for each datagram.
+    bUseBatchedReceive = !bIsClient;
+
+    if ( bUseBatchedReceive )
+    {
+        vecvecbyRecBufs.Init ( NUM_RECV_BATCH_PACKETS );
+        vecMsgHdrs.resize     ( NUM_RECV_BATCH_PACKETS );
+        vecIoVecs.resize      ( NUM_RECV_BATCH_PACKETS );
+        vecSenderAddrs.resize ( NUM_RECV_BATCH_PACKETS );
+
+        for ( int i = 0; i < NUM_RECV_BATCH_PACKETS; i++ )
+        {
+            vecvecbyRecBufs[i].Init ( MAX_SIZE_BYTES_NETW_BUF );
+
+            vecIoVecs[i].iov_base = &vecvecbyRecBufs[i][0];
+            vecIoVecs[i].iov_len  = MAX_SIZE_BYTES_NETW_BUF;
+
+            memset ( &vecMsgHdrs[i], 0, sizeof ( mmsghdr ) );
+            vecMsgHdrs[i].msg_hdr.msg_name    = &vecSenderAddrs[i];
+            vecMsgHdrs[i].msg_hdr.msg_namelen = sizeof ( sockaddr_in );
+            vecMsgHdrs[i].msg_hdr.msg_iov     = &vecIoVecs[i];
+            vecMsgHdrs[i].msg_hdr.msg_iovlen  = 1;
+        }
+    }
+#endif
+
     // preinitialize socket in address (only the port number is missing)
     sockaddr_in UdpSocketInAddr;
     UdpSocketInAddr.sin_family      = AF_INET;
@@ -89,6 +181,39 @@ void CSocket::Init ( const quint16 iPortNumber )
         // gets the desired port number
         UdpSocketInAddr.sin_port = htons ( iPortNumber );
 
+#ifdef USE_SO_REUSEPORT
+        if ( bReusePort && ( iSocketIdx == 0 ) )
+        {
+            // the port would be shared silently with any other process of the
+            // same user which uses SO_REUSEPORT (e.g. a second server instance),
+            // therefore the first socket checks that the port is actually free
+            // by binding a probe socket without SO_REUSEPORT
+            const int  iProbeSocket = socket ( AF_INET, SOCK_DGRAM, 0 );
+            const bool bPortIsFree  = ( ::bind ( iProbeSocket,
+                                                 (sockaddr*) &UdpSocketInAddr,
+                                                 sizeof ( sockaddr_in ) ) == 0 );
+
+            close ( iProbeSocket );
+
+            if ( !bPortIsFree )
+            {
+                throw CGenErr ( "Cannot bind the socket (maybe "
+                    "the software is already running).", "Network Error" );
+            }
+        }
+
+        if ( bReusePort )
+        {
+            // all receive sockets of the server are bound to the same port and
+            // the kernel distributes the clients over the sockets by a hash of
+            // the client address (only sockets of the same user can share the
+            // port)
+            const int iEnable = 1;
+
+            setsockopt ( UdpSocket, SOL_SOCKET, SO_REUSEPORT, &iEnable, sizeof ( iEnable ) );
+        }
+#endif
+
         bSuccess = ( ::bind ( UdpSocket ,
                               (sockaddr*) &UdpSocketInAddr,
                               sizeof ( sockaddr_in ) ) == 0 );
@@ -155,6 +280,12 @@ void CSocket::Close()
 
 CSocket::~CSocket()
 {
+#ifdef USE_PROT_MESSAGE_QUEUE
+    pProtMessageNotifier.reset();
+    close ( iProtMessagePipe[0] );
+    close ( iProtMessagePipe[1] );
+#endif
+
     // cleanup the socket (on Windows the WSA cleanup must also be called)
 #ifdef _WIN32
     closesocket ( UdpSocket );
@@ -173,23 +304,207 @@ void CSocket::SendPacket ( const CVector<uint8_t>& vecbySendBuf,
 
     if ( iVecSizeOut > 0 )
     {
-        // send packet through network (we have to convert the constant unsigned
-        // char vector in "const char*", for this we first convert the const
-        // uint8_t vector in a read/write uint8_t vector and then do the cast to
-        // const char*)
+        // send packet through network (the data pointer of the vector is used
+        // directly so that the vector is not copied)
         sockaddr_in UdpSocketOutAddr;
 
         UdpSocketOutAddr.sin_family      = AF_INET;
         UdpSocketOutAddr.sin_port        = htons ( HostAddr.iPort );
         UdpSocketOutAddr.sin_addr.s_addr = htonl ( HostAddr.InetAddr.toIPv4Address() );
 
-        sendto ( UdpSocket,
-                 (const char*) &( (CVector<uint8_t>) vecbySendBuf )[0],
-                 iVecSizeOut,
-                 0,
-                 (sockaddr*) &UdpSocketOutAddr,
-                 sizeof ( sockaddr_in ) );
+        if ( sendto ( UdpSocket,
+                      (const char*) vecbySendBuf.data(),
+                      iVecSizeOut,
+                      0,
+                      (sockaddr*) &UdpSocketOutAddr,
+                      sizeof ( sockaddr_in ) ) > 0 )
+        {
+            AddSentTraffic ( 1, iVecSizeOut );
+        }
+    }
+}
+
+void CSocket::InitSendQueue ( const int iNewQueueSize )
+{
+#ifdef USE_SENDMMSG
+    // the message headers point to a preallocated buffer and receiver address
+    // for each datagram so that nothing must be allocated when queueing
+    iSendQueueSize = iNewQueueSize;
+    iNumQueuedPackets.store ( 0 );
+
+    vecvecbySendBufs.Init   ( iSendQueueSize );
+    vecSendMsgHdrs.resize   ( iSendQueueSize );
+    vecSendIoVecs.resize    ( iSendQueueSize );
+    vecReceiverAddrs.resize ( iSendQueueSize );
+
+    for ( int i = 0; i < iSendQueueSize; i++ )
+    {
+        vecvecbySendBufs[i].Init ( MAX_SEND_BATCH_PACKET_SIZE );
+
+        vecSendIoVecs[i].iov_base = &vecvecbySendBufs[i][0];
+        vecSendIoVecs[i].iov_len  = 0;
+
+        memset ( &vecReceiverAddrs[i], 0, sizeof ( sockaddr_in ) );
+        vecReceiverAddrs[i].sin_family = AF_INET;
+
+        memset ( &vecSendMsgHdrs[i], 0, sizeof ( mmsghdr ) );
+        vecSendMsgHdrs[i].msg_hdr.msg_name    = &vecReceiverAddrs[i];
+        vecSendMsgHdrs[i].msg_hdr.msg_namelen = sizeof ( sockaddr_in );
+        vecSendMsgHdrs[i].msg_hdr.msg_iov     = &vecSendIoVecs[i];
+        vecSendMsgHdrs[i].msg_hdr.msg_iovlen  = 1;
+    }
+
+    bUseBatchedSend = ( iSendQueueSize > 0 );
+#else
+    Q_UNUSED ( iNewQueueSize )
+#endif
+}
+
+bool CSocket::EnableIoUring()
+{
+#ifdef USE_IO_URING
+    // the receive requires the provided buffer rings and multishot recvmsg
+    // (Linux 6.0), if this is not supported we keep the standard functions
+    bUseIoUringReceive = IoUringReceiver.Init ( UdpSocket,
+                                                IO_URING_NUM_RECV_BUFFERS,
+                                                IO_URING_RECV_BUFFER_SIZE );
+
+    // the send queue is only available for the socket which sends the audio
+    if ( bUseIoUringReceive && bUseBatchedSend )
+    {
+        bUseIoUringSend = IoUringSender.Init ( UdpSocket, IO_URING_NUM_SEND_ENTRIES );
+    }
+
+    return bUseIoUringReceive;
+#else
+    return false;
+#endif
+}
+
+void CSocket::QueuePacket ( const CVector<uint8_t>& vecbySendBuf,
+                            const CHostAddress&     HostAddr )
+{
+#ifdef USE_SENDMMSG
+    const int iVecSizeOut = vecbySendBuf.Size();
+
+    if ( bUseBatchedSend && ( iVecSizeOut > 0 ) && ( iVecSizeOut <= MAX_SEND_BATCH_PACKET_SIZE ) )
+    {
+        // reserve a slot in the queue (no lock is needed since each thread gets
+        // its own slot)
+        const int iSlot = iNumQueuedPackets.fetch_add ( 1, std::memory_order_relaxed );
+
+        if ( iSlot < iSendQueueSize )
+        {
+            memcpy ( &vecvecbySendBufs[iSlot][0], vecbySendBuf.data(), iVecSizeOut );
+
+            vecSendIoVecs[iSlot].iov_len            = iVecSizeOut;
+            vecReceiverAddrs[iSlot].sin_port        = htons ( HostAddr.iPort );
+            vecReceiverAddrs[iSlot].sin_addr.s_addr = htonl ( HostAddr.InetAddr.toIPv4Address() );
+            return;
+        }
     }
+#endif
+
+    // the queue is not available or full, send the datagram directly
+    SendPacket ( vecbySendBuf, HostAddr );
+}
+
+void CSocket::FlushSendQueue()
+{
+#ifdef USE_SENDMMSG
+    const int iNumPackets = std::min ( iNumQueuedPackets.exchange ( 0 ), iSendQueueSize );
+    int       iFirst      = 0;
+
+#ifdef USE_IO_URING
+    if ( bUseIoUringSend && ( iNumPackets > 0 ) )
+    {
+        // one send request per datagram, all submitted with one system call
+        if ( IoUringSender.SendMessages ( &vecSendMsgHdrs[0], iNumPackets ) )
+        {
+            uint64_t iNumBytes = 0;
+
+            for ( int i = 0; i < iNumPackets; i++ )
+            {
+                iNumBytes += vecSendIoVecs[i].iov_len;
+            }
+
+            AddSentTraffic ( iNumPackets, iNumBytes );
+        }
+        else
+        {
+            // the ring is not usable anymore, we do not know which datagrams
+            // were sent so this tick is dropped and sendmmsg is used from now
+            // on
+            bUseIoUringSend = false;
+        }
+
+        return;
+    }
+#endif
+
+    while ( iFirst < iNumPackets )
+    {
+        // send all remaining datagrams with one system call (the kernel may
+        // send less datagrams than requested)
+        const int iNumSent = sendmmsg ( UdpSocket,
+                                        &vecSendMsgHdrs[iFirst],
+                                        static_cast<unsigned int> ( iNumPackets - iFirst ),
+                                        0 );
+
+        if ( iNumSent > 0 )
+        {
+            uint64_t iNumBytes = 0;
+
+            for ( int i = iFirst; i < iFirst + iNumSent; i++ )
+            {
+                iNumBytes += vecSendIoVecs[i].iov_len;
+            }
+
+            AddSentTraffic ( iNumSent, iNumBytes );
+
+            iFirst += iNumSent;
+        }
+        else
+        {
+            // if the kernel does not support sendmmsg, all further datagrams
+            // are sent directly
+            if ( errno == ENOSYS )
+            {
+                bUseBatchedSend = false;
+            }
+
+            // the first datagram could not be sent with sendmmsg, try it with
+            // sendto and continue with the next datagram
+            if ( sendto ( UdpSocket,
+                          vecSendIoVecs[iFirst].iov_base,
+                          vecSendIoVecs[iFirst].iov_len,
+                          0,
+                          (sockaddr*) &vecReceiverAddrs[iFirst],
+                          sizeof ( sockaddr_in ) ) > 0 )
+            {
+                AddSentTraffic ( 1, vecSendIoVecs[iFirst].iov_len );
+            }
+
+            iFirst++;
+        }
+    }
+#endif
+}
+
+void CSocket::GetTrafficCounters ( uint64_t& iNumPacketsRec,
+                                   uint64_t& iNumBytesRec,
+                                   uint64_t& iNumPacketsSent,
+                                   uint64_t& iNumBytesSent ) const
+{
+    iNumPacketsRec  = iNumPacketsRecTotal.load ( std::memory_order_relaxed );
+    iNumBytesRec    = iNumBytesRecTotal.load ( std::memory_order_relaxed );
+    iNumPacketsSent = iNumPacketsSentTotal.load ( std::memory_order_relaxed );
+    iNumBytesSent   = iNumBytesSentTotal.load ( std::memory_order_relaxed );
+}
+
+uint64_t CSocket::GetNumProtMessageQueueOverflows() const
+{
+    return iNumProtMessageQueueOverflows.load ( std::memory_order_relaxed );
 }
 
 bool CSocket::GetAndResetbJitterBufferOKFlag()
@@ -217,6 +532,77 @@ void CSocket::OnDataReceived()
     use the signal/slot mechanism (i.e. we use messages for that).
 */
 
+#ifdef USE_IO_URING
+    if ( bUseIoUringReceive )
+    {
+        // get the next datagram which the kernel has written in one of the
+        // provided buffers (the time out is needed to be able to stop the
+        // receive thread since closing the socket does not wake up the ring)
+        const uint8_t* pData;
+        int            iNumBytesRead;
+        sockaddr_in    SenderAddr;
+
+        if ( IoUringReceiver.GetNextPacket ( pData, iNumBytesRead, SenderAddr, IO_URING_RECV_TIMEOUT_MS ) &&
+             ( iNumBytesRead > 0 ) )
+        {
+            // convert address of client
+            RecHostAddr.InetAddr.setAddress ( ntohl ( SenderAddr.sin_addr.s_addr ) );
+            RecHostAddr.iPort = ntohs ( SenderAddr.sin_port );
+
+            // the packet parsing works on vectors, therefore the datagram is
+            // copied in the receive buffer (the provided buffers are smaller)
+            memcpy ( &vecbyRecBuf[0], pData, iNumBytesRead );
+
+            ProcessPacket ( vecbyRecBuf, iNumBytesRead );
+        }
+
+        return;
+    }
+#endif
+
+#ifdef USE_RECVMMSG
+    if ( bUseBatchedReceive )
+    {
+        // read all available blocks from network interface with one system
+        // call (only wait for the first one) and process them in one pass
+        const int iNumPackets = recvmmsg ( UdpSocket,
+                                           &vecMsgHdrs[0],
+                                           NUM_RECV_BATCH_PACKETS,
+                                           MSG_WAITFORONE,
+                                           nullptr );
+
+        if ( iNumPackets < 0 )
+        {
+            // if the kernel does not support recvmmsg, use recvfrom instead
+            if ( errno == ENOSYS )
+            {
+                bUseBatchedReceive = false;
+            }
+
+            return;
+        }
+
+        for ( int i = 0; i < iNumPackets; i++ )
+        {
+            const int iNumBytesRead = static_cast<int> ( vecMsgHdrs[i].msg_len );
+
+            // the address length is overwritten by the system call
+            vecMsgHdrs[i].msg_hdr.msg_namelen = sizeof ( sockaddr_in );
+
+            if ( iNumBytesRead > 0 )
+            {
+                // convert address of client
+                RecHostAddr.InetAddr.setAddress ( ntohl ( vecSenderAddrs[i].sin_addr.s_addr ) );
+                RecHostAddr.iPort = ntohs ( vecSenderAddrs[i].sin_port );
+
+                ProcessPacket ( vecvecbyRecBufs[i], iNumBytesRead );
+            }
+        }
+
+        return;
+    }
+#endif
+
     // read block from network interface and query address of sender
     sockaddr_in SenderAddr;
 #ifdef _WIN32
@@ -242,18 +628,37 @@ void CSocket::OnDataReceived()
     RecHostAddr.InetAddr.setAddress ( ntohl ( SenderAddr.sin_addr.s_addr ) );
     RecHostAddr.iPort = ntohs ( SenderAddr.sin_port );
 
+    ProcessPacket ( vecbyRecBuf, static_cast<int> ( iNumBytesRead ) );
+}
+
+void CSocket::ProcessPacket ( const CVector<uint8_t>& vecbyBuf,
+                              const int               iNumBytesRead )
+{
+    // only the receive thread writes the received counters
+    iNumPacketsRecTotal.store ( iNumPacketsRecTotal.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    iNumBytesRecTotal.store ( iNumBytesRecTotal.load ( std::memory_order_relaxed ) + iNumBytesRead, std::memory_order_relaxed );
 
-    // check if this is a protocol message
+    // check if this is a protocol message (if the message queue is used, the
+    // message body is parsed in the preallocated member vector)
     int              iRecCounter;
     int              iRecID;
+#ifndef USE_PROT_MESSAGE_QUEUE
     CVector<uint8_t> vecbyMesBodyData;
+#endif
 
-    if ( !CProtocol::ParseMessageFrame ( vecbyRecBuf,
+    // (the cheap frame header check lets audio packets bypass the protocol
+    // frame parsing including the CRC calculation)
+    if ( CProtocol::IsProtocolMessageFrame ( vecbyBuf, iNumBytesRead ) &&
+         !CProtocol::ParseMessageFrame ( vecbyBuf,
                                          iNumBytesRead,
                                          vecbyMesBodyData,
                                          iRecCounter,
                                          iRecID ) )
     {
+#ifdef USE_PROT_MESSAGE_QUEUE
+        // this is a protocol message, hand it over to the main thread
+        QueueProtMessage ( iRecCounter, iRecID );
+#else
         // this is a protocol message, check the type of the message
         if ( CProtocol::IsConnectionLessMessageID ( iRecID ) )
         {
@@ -269,6 +674,7 @@ void CSocket::OnDataReceived()
 
             emit ProtcolMessageReceived ( iRecCounter, iRecID, vecbyMesBodyData, RecHostAddr );
         }
+#endif
     }
     else
     {
@@ -277,7 +683,7 @@ void CSocket::OnDataReceived()
         {
             // client:
 
-            switch ( pChannel->PutAudioData ( vecbyRecBuf, iNumBytesRead, RecHostAddr ) )
+            switch ( pChannel->PutAudioData ( vecbyBuf, iNumBytesRead, RecHostAddr ) )
             {
             case PS_AUDIO_ERR:
             case PS_GEN_ERROR:
@@ -305,7 +711,7 @@ void CSocket::OnDataReceived()
 
             int iCurChanID;
 
-            if ( pServer->PutAudioData ( vecbyRecBuf, iNumBytesRead, RecHostAddr, iCurChanID ) )
+            if ( pServer->PutAudioData ( vecbyBuf, iNumBytesRead, RecHostAddr, iSocketIdx, iCurChanID ) )
             {
                 // we have a new connection, emit a signal
                 emit NewConnection ( iCurChanID, RecHostAddr );
@@ -328,3 +734,94 @@ void CSocket::OnDataReceived()
         }
     }
 }
+
+#ifdef USE_PROT_MESSAGE_QUEUE
+void CSocket::QueueProtMessage ( const int iRecCounter,
+                                 const int iRecID )
+{
+/*
+    this function must only be called by the socket thread
+*/
+    const unsigned int iTail = iProtMessageQueueTail.load ( std::memory_order_relaxed );
+
+    // if the queue is full (e.g. on a burst of connection less messages which
+    // are never resent), the message is handed over by a queued signal which
+    // copies the message body (this allocates memory but no message is lost)
+    if ( iTail - iProtMessageQueueHead.load ( std::memory_order_acquire ) >= PROT_MESSAGE_QUEUE_SIZE )
+    {
+        iNumProtMessageQueueOverflows.fetch_add ( 1, std::memory_order_relaxed );
+
+        if ( CProtocol::IsConnectionLessMessageID ( iRecID ) )
+        {
+            emit ProtcolCLMessageReceived ( iRecID, vecbyMesBodyData, RecHostAddr );
+        }
+        else
+        {
+            emit ProtcolMessageReceived ( iRecCounter, iRecID, vecbyMesBodyData, RecHostAddr );
+        }
+
+        return;
+    }
+
+    CProtMessage& ProtMessage = vecProtMessages[iTail & ( PROT_MESSAGE_QUEUE_SIZE - 1 )];
+
+    // the parsed message body is swapped in the queue so that neither the
+    // data is copied nor memory is allocated
+    ProtMessage.vecbyMesBodyData.swap ( vecbyMesBodyData );
+
+    ProtMessage.iRecCounter = iRecCounter;
+    ProtMessage.iRecID      = iRecID;
+    ProtMessage.iIPv4Addr   = RecHostAddr.InetAddr.toIPv4Address();
+    ProtMessage.iPort       = RecHostAddr.iPort;
+
+    iProtMessageQueueTail.store ( iTail + 1 );
+
+    // only wake up the main thread if it is not already woken up
+    if ( !bProtMessageWakeUpPending.exchange ( true ) )
+    {
+        const char cWakeUp = 0;
+
+        if ( write ( iProtMessagePipe[1], &cWakeUp, 1 ) != 1 )
+        {
+            // the pipe is full which means that the main thread is woken up
+            // anyway
+        }
+    }
+}
+
+void CSocket::ProcessQueuedProtMessages()
+{
+/*
+    this function must only be called by the main thread
+*/
+    // empty the pipe and reset the wake up flag before reading the queue so
+    // that a message which is queued in the meantime wakes us up again
+    char vecbyPipeData[64];
+
+    while ( read ( iProtMessagePipe[0], vecbyPipeData, sizeof ( vecbyPipeData ) ) > 0 ) {}
+
+    bProtMessageWakeUpPending.store ( false );
+
+    unsigned int iHead = iProtMessageQueueHead.load ( std::memory_order_relaxed );
+
+    while ( iHead != iProtMessageQueueTail.load() )
+    {
+        const CProtMessage& ProtMessage = vecProtMessages[iHead & ( PROT_MESSAGE_QUEUE_SIZE - 1 )];
+        const CHostAddress  HostAddr ( QHostAddress ( ProtMessage.iIPv4Addr ), ProtMessage.iPort );
+
+        // we are in the main thread so the connected slots are called directly
+        if ( CProtocol::IsConnectionLessMessageID ( ProtMessage.iRecID ) )
+        {
+            emit ProtcolCLMessageReceived ( ProtMessage.iRecID, ProtMessage.vecbyMesBodyData, HostAddr );
+        }
+        else
+        {
+            emit ProtcolMessageReceived ( ProtMessage.iRecCounter, ProtMessage.iRecID, ProtMessage.vecbyMesBodyData, HostAddr );
+        }
+
+        // the slot can now be reused by the socket thread
+        iHead++;
+        iProtMessageQueueHead.store ( iHead, std::memory_order_release );
+    }
+}
+#endif
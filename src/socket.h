@@ -28,12 +28,29 @@
 #include <QThread>
 #include <QMutex>
 #include <vector>
+#include <atomic>
 #include "global.h"
 #include "protocol.h"
 #include "util.h"
 #ifndef _WIN32
+# include <QSocketNotifier>
+# include <QScopedPointer>
 # include <netinet/in.h>
 # include <sys/socket.h>
+# include <unistd.h>
+# include <fcntl.h>
+# define USE_PROT_MESSAGE_QUEUE
+#endif
+#if defined ( __linux__ ) && !defined ( ANDROID )
+# include <sys/uio.h>
+# include <cerrno>
+# include <cstring>
+# define USE_RECVMMSG
+# define USE_SENDMMSG
+# define USE_SO_REUSEPORT
+#endif
+#ifdef USE_IO_URING
+# include "iouring.h"
 #endif
 
 
@@ -42,14 +59,60 @@
 // channel class and server class is defined here.
 class CServer;  // forward declaration of CServer
 class CChannel; // forward declaration of CChannel
+class CSocket;  // forward declaration of CSocket
 
 
 /* Definitions ****************************************************************/
 // number of ports we try to bind until we give up
 #define NUM_SOCKET_PORTS_TO_TRY         50
 
+// number of preallocated protocol messages which can be handed over from the
+// socket thread to the main thread (must be a power of two)
+#define PROT_MESSAGE_QUEUE_SIZE         64
+
+// maximum number of datagrams the server receives with one system call (only
+// used if recvmmsg is available)
+#define NUM_RECV_BATCH_PACKETS          16
+
+// maximum size of a datagram which can be put in the send queue of the server
+// (larger datagrams are sent directly)
+#define MAX_SEND_BATCH_PACKET_SIZE      1500
+
+// maximum number of server receive sockets which share the same port (only
+// used if SO_REUSEPORT is available)
+#define MAX_NUM_RECV_SOCKETS            16
+
+// io_uring engine: number and size of the provided receive buffers (larger
+// datagrams are dropped), the receive time out is required to be able to
+// stop the receive thread and the number of send requests per submission
+#define IO_URING_NUM_RECV_BUFFERS       256
+#define IO_URING_RECV_BUFFER_SIZE       8192
+#define IO_URING_RECV_TIMEOUT_MS        100
+#define IO_URING_NUM_SEND_ENTRIES       256
+
 
 /* Classes ********************************************************************/
+/* Protocol message notifier ------------------------------------------------ */
+#ifdef USE_PROT_MESSAGE_QUEUE
+// Wakes up the main thread if protocol messages were put in the queue of the
+// socket. The event is handled directly instead of using the activated signal
+// since its signature differs between the Qt versions.
+class CProtMessageNotifier : public QSocketNotifier
+{
+public:
+    CProtMessageNotifier ( const int iPipeReadFd,
+                           CSocket*  pNewSocket )
+        : QSocketNotifier ( iPipeReadFd, QSocketNotifier::Read ),
+          pSocket ( pNewSocket ) {}
+
+protected:
+    virtual bool event ( QEvent* pEvent );
+
+    CSocket* pSocket;
+};
+#endif
+
+
 /* Base socket class -------------------------------------------------------- */
 class CSocket : public QObject
 {
@@ -60,25 +123,79 @@ public:
               const quint16 iPortNumber )
         : pChannel ( pNewChannel ),
           bIsClient ( true ),
-          bJitterBufferOK ( true ) { Init ( iPortNumber ); }
+          bJitterBufferOK ( true ),
+          iSocketIdx ( 0 ),
+          bReusePort ( false ) { Init ( iPortNumber ); }
 
+    // the server may open multiple sockets on the same port, each socket has
+    // its own index which is passed to the server with the received audio
     CSocket ( CServer*      pNServP,
-              const quint16 iPortNumber )
+              const quint16 iPortNumber,
+              const int     iNewSocketIdx = 0,
+              const bool    bNewReusePort = false )
         : pServer ( pNServP ),
           bIsClient ( false ),
-          bJitterBufferOK ( true ) { Init ( iPortNumber ); }
+          bJitterBufferOK ( true ),
+          iSocketIdx ( iNewSocketIdx ),
+          bReusePort ( bNewReusePort ) { Init ( iPortNumber ); }
 
     virtual ~CSocket();
 
     void SendPacket ( const CVector<uint8_t>& vecbySendBuf,
                       const CHostAddress&     HostAddr );
 
+    // The send queue collects the datagrams of one server timer tick which
+    // are then sent with one system call by FlushSendQueue(). QueuePacket()
+    // may be called by multiple threads at the same time but not concurrently
+    // to FlushSendQueue(). If no send queue is available, the datagram is sent
+    // directly.
+    void InitSendQueue ( const int iNewQueueSize );
+
+    void QueuePacket ( const CVector<uint8_t>& vecbySendBuf,
+                       const CHostAddress&     HostAddr );
+
+    void FlushSendQueue();
+
+    // switches the server socket to the io_uring engine, returns false if
+    // io_uring is not available (then the standard functions are used), must
+    // be called before the receive thread is started
+    bool EnableIoUring();
+
     bool GetAndResetbJitterBufferOKFlag();
     void Close();
 
+    // cumulative traffic counters for monitoring (may be read by any thread)
+    void GetTrafficCounters ( uint64_t& iNumPacketsRec,
+                              uint64_t& iNumBytesRec,
+                              uint64_t& iNumPacketsSent,
+                              uint64_t& iNumBytesSent ) const;
+
+    // protocol messages which did not fit in the message queue
+    uint64_t GetNumProtMessageQueueOverflows() const;
+
+#ifdef USE_PROT_MESSAGE_QUEUE
+    // emits the signals for all queued protocol messages (main thread only)
+    void ProcessQueuedProtMessages();
+#endif
+
 protected:
     void Init ( const quint16 iPortNumber );
 
+    void ProcessPacket ( const CVector<uint8_t>& vecbyBuf,
+                         const int               iNumBytesRead );
+
+    void AddSentTraffic ( const int      iNumPackets,
+                          const uint64_t iNumBytes )
+    {
+        iNumPacketsSentTotal.fetch_add ( iNumPackets, std::memory_order_relaxed );
+        iNumBytesSentTotal.fetch_add ( iNumBytes, std::memory_order_relaxed );
+    }
+
+#ifdef USE_PROT_MESSAGE_QUEUE
+    void QueueProtMessage ( const int iRecCounter,
+                            const int iRecID );
+#endif
+
 #ifdef _WIN32
     SOCKET           UdpSocket;
 #else
@@ -88,6 +205,66 @@ protected:
     QMutex           Mutex;
 
     CVector<uint8_t> vecbyRecBuf;
+
+    // traffic counters (the received counters are only written by the receive
+    // thread, the sent counters by all sending threads)
+    std::atomic<uint64_t> iNumPacketsRecTotal;
+    std::atomic<uint64_t> iNumBytesRecTotal;
+    std::atomic<uint64_t> iNumPacketsSentTotal;
+    std::atomic<uint64_t> iNumBytesSentTotal;
+    std::atomic<uint64_t> iNumProtMessageQueueOverflows;
+
+#ifdef USE_PROT_MESSAGE_QUEUE
+    // The received protocol messages are handed over to the main thread by a
+    // lock-free single producer single consumer queue of preallocated
+    // messages so that the socket thread does not allocate any memory. The
+    // main thread is woken up by writing in a pipe.
+    struct CProtMessage
+    {
+        CVector<uint8_t> vecbyMesBodyData;
+        int              iRecCounter;
+        int              iRecID;
+        quint32          iIPv4Addr;
+        quint16          iPort;
+    };
+
+    CVector<uint8_t>                     vecbyMesBodyData; // preallocated, swapped with the queued message
+    CVector<CProtMessage>                vecProtMessages;
+    std::atomic<unsigned int>            iProtMessageQueueHead; // written by the main thread
+    std::atomic<unsigned int>            iProtMessageQueueTail; // written by the socket thread
+    std::atomic<bool>                    bProtMessageWakeUpPending;
+    int                                  iProtMessagePipe[2];
+    QScopedPointer<CProtMessageNotifier> pProtMessageNotifier;
+#endif
+
+#ifdef USE_RECVMMSG
+    // preallocated buffers for the batched receive of the server
+    bool                       bUseBatchedReceive;
+    CVector<CVector<uint8_t> > vecvecbyRecBufs;
+    std::vector<mmsghdr>       vecMsgHdrs;
+    std::vector<iovec>         vecIoVecs;
+    std::vector<sockaddr_in>   vecSenderAddrs;
+#endif
+
+#ifdef USE_SENDMMSG
+    // preallocated send queue of the server
+    bool                       bUseBatchedSend;
+    int                        iSendQueueSize;
+    std::atomic<int>           iNumQueuedPackets;
+    CVector<CVector<uint8_t> > vecvecbySendBufs;
+    std::vector<mmsghdr>       vecSendMsgHdrs;
+    std::vector<iovec>         vecSendIoVecs;
+    std::vector<sockaddr_in>   vecReceiverAddrs;
+#endif
+
+#ifdef USE_IO_URING
+    // optional io_uring engine of the server
+    bool                       bUseIoUringReceive;
+    bool                       bUseIoUringSend;
+    CIoUringReceiver           IoUringReceiver;
+    CIoUringSender             IoUringSender;
+#endif
+
     CHostAddress     RecHostAddr;
     QHostAddress     SenderAddress;
     quint16          SenderPort;
@@ -99,6 +276,9 @@ protected:
 
     bool             bJitterBufferOK;
 
+    int              iSocketIdx;
+    bool             bReusePort;
+
 public slots:
     void OnDataReceived();
 
@@ -138,18 +318,24 @@ public:
         : Socket ( pNewChannel, iPortNumber ) { Init(); }
 
     CHighPrioSocket ( CServer*      pNewServer,
-                      const quint16 iPortNumber )
-        : Socket ( pNewServer, iPortNumber ) { Init(); }
+                      const quint16 iPortNumber,
+                      const int     iSocketIdx = 0,
+                      const bool    bReusePort = false )
+        : Socket ( pNewServer, iPortNumber, iSocketIdx, bReusePort ) { Init(); }
 
     virtual ~CHighPrioSocket()
     {
         NetworkWorkerThread.Stop();
     }
 
-    void Start()
+    void Start ( const int iCPUCore    = -1,
+                 const int iRTPriority = 0 )
     {
         // starts the high priority socket receive thread (with using blocking
-        // socket request call)
+        // socket request call), optionally the thread is pinned to a CPU core
+        // and uses real-time (SCHED_FIFO) scheduling
+        NetworkWorkerThread.SetCPUCore ( iCPUCore );
+        NetworkWorkerThread.SetRealTimePriority ( iRTPriority );
         NetworkWorkerThread.start ( QThread::TimeCriticalPriority );
     }
 
@@ -159,17 +345,49 @@ public:
         Socket.SendPacket ( vecbySendBuf, HostAddr );
     }
 
+    void InitSendQueue ( const int iNewQueueSize )
+    {
+        Socket.InitSendQueue ( iNewQueueSize );
+    }
+
+    void QueuePacket ( const CVector<uint8_t>& vecbySendBuf,
+                       const CHostAddress&     HostAddr )
+    {
+        Socket.QueuePacket ( vecbySendBuf, HostAddr );
+    }
+
+    void FlushSendQueue()
+    {
+        Socket.FlushSendQueue();
+    }
+
+    bool EnableIoUring()
+    {
+        return Socket.EnableIoUring();
+    }
+
     bool GetAndResetbJitterBufferOKFlag()
     {
         return Socket.GetAndResetbJitterBufferOKFlag();
     }
 
+    void GetTrafficCounters ( uint64_t& iNumPacketsRec,
+                              uint64_t& iNumBytesRec,
+                              uint64_t& iNumPacketsSent,
+                              uint64_t& iNumBytesSent ) const
+    {
+        Socket.GetTrafficCounters ( iNumPacketsRec, iNumBytesRec, iNumPacketsSent, iNumBytesSent );
+    }
+
+    uint64_t GetNumProtMessageQueueOverflows() const { return Socket.GetNumProtMessageQueueOverflows(); }
+
 protected:
     class CSocketThread : public QThread
     {
     public:
         CSocketThread ( CSocket* pNewSocket = nullptr, QObject* parent = nullptr ) :
-          QThread ( parent ), pSocket ( pNewSocket ), bRun ( true ) {}
+          QThread ( parent ), pSocket ( pNewSocket ), bRun ( true ), iCPUCore ( -1 ),
+          iRTPriority ( 0 ) {}
 
         void Stop()
         {
@@ -184,6 +402,8 @@ protected:
         }
 
         void SetSocket ( CSocket* pNewSocket ) { pSocket = pNewSocket; }
+        void SetCPUCore ( const int iNewCPUCore ) { iCPUCore = iNewCPUCore; }
+        void SetRealTimePriority ( const int iNewPriority ) { iRTPriority = iNewPriority; }
 
     protected:
         void run() {
@@ -191,6 +411,16 @@ protected:
             // case)
             if ( pSocket != nullptr )
             {
+                if ( iCPUCore >= 0 )
+                {
+                    CThreadUtil::SetCurrentThreadAffinity ( iCPUCore );
+                }
+
+                if ( iRTPriority > 0 )
+                {
+                    CThreadUtil::SetCurrentThreadRealTimePriority ( iRTPriority );
+                }
+
                 while ( bRun )
                 {
                     // this function is a blocking function (waiting for network
@@ -202,6 +432,8 @@ protected:
 
         CSocket* pSocket;
         bool     bRun;
+        int      iCPUCore;
+        int      iRTPriority;
     };
 
     void Init()
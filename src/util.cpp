@@ -24,6 +24,12 @@
 
 #include "util.h"
 #include "client.h"
+#include <QThread>
+#if defined ( __linux__ ) && !defined ( ANDROID )
+# include <pthread.h>
+# include <sched.h>
+# include <sys/mman.h>
+#endif
 
 
 /* Implementation *************************************************************/
@@ -70,12 +76,18 @@ void CStereoSignalLevelMeter::Update ( const CVector<short>& vecsAudio,
         }
     }
 
+    Update ( -sMinLOrMono, -sMinR );
+}
+
+void CStereoSignalLevelMeter::Update ( const double dPeakLOrMono,
+                                       const double dPeakR )
+{
     // apply smoothing, if in stereo out mode, do this for two channels
-    dCurLevelLOrMono = UpdateCurLevel ( dCurLevelLOrMono, -sMinLOrMono );
+    dCurLevelLOrMono = UpdateCurLevel ( dCurLevelLOrMono, dPeakLOrMono );
 
     if ( bIsStereoOut )
     {
-        dCurLevelR = UpdateCurLevel ( dCurLevelR, -sMinR );
+        dCurLevelR = UpdateCurLevel ( dCurLevelR, dPeakR );
     }
 }
 
@@ -130,15 +142,17 @@ double CStereoSignalLevelMeter::CalcLogResultForMeter ( const double& dLinearLev
 
 
 // CRC -------------------------------------------------------------------------
-void CCRC::Reset()
+// The CRC is defined by the bit-serial shift-register implementation below. It
+// is only used to generate the look-up tables. Since the register transition is
+// linear, the state after a number of input bytes is the XOR of the separate
+// contributions of the old state bytes and the input bytes which we can read
+// from tables (the contribution of a byte depends on its distance to the end).
+static uint32_t CRCShiftRegisterAddByte ( uint32_t       iStateShiftReg,
+                                          const uint8_t  byNewInput )
 {
-    // init state shift-register with ones. Set all registers to "1" with
-    // bit-wise not operation
-    iStateShiftReg = ~uint32_t ( 0 );
-}
+    const uint32_t iPoly       = ( 1 << 5 ) | ( 1 << 12 );
+    const uint32_t iBitOutMask = ( 1 << 16 );
 
-void CCRC::AddByte ( const uint8_t byNewInput )
-{
     for ( int i = 0; i < 8; i++ )
     {
         // shift bits in shift-register for transition
@@ -164,15 +178,123 @@ void CCRC::AddByte ( const uint8_t byNewInput )
             iStateShiftReg ^= iPoly;
         }
     }
+
+    // remove bits which where shifted out of the shift-register frame
+    return iStateShiftReg & ( iBitOutMask - 1 );
+}
+
+CCRC::CTables::CTables()
+{
+    for ( int iVal = 0; iVal < 256; iVal++ )
+    {
+        uint32_t iStateLow  = static_cast<uint32_t> ( iVal );
+        uint32_t iStateHigh = static_cast<uint32_t> ( iVal ) << 8;
+        uint32_t iData      = CRCShiftRegisterAddByte ( 0, static_cast<uint8_t> ( iVal ) );
+
+        for ( int iDist = 0; iDist < CRC_SLICE_NUM_BYTES; iDist++ )
+        {
+            // state contribution after iDist + 1 bytes
+            iStateLow                  = CRCShiftRegisterAddByte ( iStateLow, 0 );
+            iStateHigh                 = CRCShiftRegisterAddByte ( iStateHigh, 0 );
+            vecStateLow[iDist][iVal]   = static_cast<uint16_t> ( iStateLow );
+            vecStateHigh[iDist][iVal]  = static_cast<uint16_t> ( iStateHigh );
+
+            // contribution of an input byte which has iDist bytes following
+            vecData[iDist][iVal]       = static_cast<uint16_t> ( iData );
+            iData                      = CRCShiftRegisterAddByte ( iData, 0 );
+        }
+    }
+}
+
+const CCRC::CTables& CCRC::Tables()
+{
+    // the tables are created on first use (thread-safe static initialization)
+    static const CTables Tables;
+    return Tables;
+}
+
+void CCRC::Reset()
+{
+    // init state shift-register with ones
+    iStateShiftReg = 0xFFFF;
+}
+
+void CCRC::AddByte ( const uint8_t byNewInput )
+{
+    const CTables& T = Tables();
+
+    iStateShiftReg = T.vecStateLow[0][iStateShiftReg & 0xFF] ^
+                     T.vecStateHigh[0][iStateShiftReg >> 8] ^
+                     T.vecData[0][byNewInput];
+}
+
+void CCRC::AddBytes ( const uint8_t* pbyNewInput,
+                      int            iNumBytes )
+{
+    const CTables& T = Tables();
+
+    // process blocks of CRC_SLICE_NUM_BYTES bytes with one table look-up per byte
+    while ( iNumBytes >= CRC_SLICE_NUM_BYTES )
+    {
+        iStateShiftReg = T.vecStateLow[7][iStateShiftReg & 0xFF] ^
+                         T.vecStateHigh[7][iStateShiftReg >> 8] ^
+                         T.vecData[7][pbyNewInput[0]] ^
+                         T.vecData[6][pbyNewInput[1]] ^
+                         T.vecData[5][pbyNewInput[2]] ^
+                         T.vecData[4][pbyNewInput[3]] ^
+                         T.vecData[3][pbyNewInput[4]] ^
+                         T.vecData[2][pbyNewInput[5]] ^
+                         T.vecData[1][pbyNewInput[6]] ^
+                         T.vecData[0][pbyNewInput[7]];
+
+        pbyNewInput += CRC_SLICE_NUM_BYTES;
+        iNumBytes   -= CRC_SLICE_NUM_BYTES;
+    }
+
+    // remaining bytes
+    while ( iNumBytes > 0 )
+    {
+        AddByte ( *pbyNewInput );
+
+        pbyNewInput++;
+        iNumBytes--;
+    }
 }
 
 uint32_t CCRC::GetCRC()
 {
     // return inverted shift-register (1's complement)
-    iStateShiftReg = ~iStateShiftReg;
+    iStateShiftReg = ~iStateShiftReg & 0xFFFF;
 
-    // remove bit which where shifted out of the shift-register frame
-    return iStateShiftReg & ( iBitOutMask - 1 );
+    return iStateShiftReg;
+}
+
+uint32_t CCRC::GetCRCDiff ( const uint8_t byDiff,
+                            int           iNumFollowingBytes )
+{
+    const CTables& T = Tables();
+
+    // the initial state and the other bytes do not contribute to the
+    // difference, i.e., we only have to shift the changed byte to the end
+    uint32_t iDiffShiftReg = T.vecData[0][byDiff];
+
+    while ( iNumFollowingBytes >= CRC_SLICE_NUM_BYTES )
+    {
+        iDiffShiftReg = T.vecStateLow[7][iDiffShiftReg & 0xFF] ^
+                        T.vecStateHigh[7][iDiffShiftReg >> 8];
+
+        iNumFollowingBytes -= CRC_SLICE_NUM_BYTES;
+    }
+
+    while ( iNumFollowingBytes > 0 )
+    {
+        iDiffShiftReg = T.vecStateLow[0][iDiffShiftReg & 0xFF] ^
+                        T.vecStateHigh[0][iDiffShiftReg >> 8];
+
+        iNumFollowingBytes--;
+    }
+
+    return iDiffShiftReg;
 }
 
 
@@ -988,6 +1110,197 @@ QString NetworkUtil::GetCentralServerAddress ( const ECSAddType eCentralServerAd
 }
 
 
+// Thread utility functions ----------------------------------------------------
+int CThreadUtil::GetNumCPUCores()
+{
+    return std::max ( 1, QThread::idealThreadCount() );
+}
+
+bool CThreadUtil::SetCurrentThreadAffinity ( const int iCPUCore )
+{
+#if defined ( __linux__ ) && !defined ( ANDROID )
+    // pin the calling thread to the given CPU core
+    cpu_set_t CPUSet;
+
+    CPU_ZERO ( &CPUSet );
+    CPU_SET ( iCPUCore, &CPUSet );
+
+    return pthread_setaffinity_np ( pthread_self(), sizeof ( cpu_set_t ), &CPUSet ) == 0;
+#else
+    // thread pinning is not supported on this platform
+    Q_UNUSED ( iCPUCore )
+    return false;
+#endif
+}
+
+bool CThreadUtil::SetCurrentThreadRealTimePriority ( const int iPriority )
+{
+#if defined ( __linux__ ) && !defined ( ANDROID )
+    // use the SCHED_FIFO real-time scheduling policy for the calling thread
+    // (requires CAP_SYS_NICE or a suitable RLIMIT_RTPRIO)
+    sched_param SchedParam;
+    SchedParam.sched_priority = iPriority;
+
+    return pthread_setschedparam ( pthread_self(), SCHED_FIFO, &SchedParam ) == 0;
+#else
+    // real-time scheduling is not supported on this platform
+    Q_UNUSED ( iPriority )
+    return false;
+#endif
+}
+
+bool CThreadUtil::LockMemory()
+{
+#if defined ( __linux__ ) && !defined ( ANDROID )
+    // Lock the current and all future memory. MCL_ONFAULT is not used on
+    // purpose: all mapped pages are populated and locked immediately so that
+    // no page fault can occur in the real-time threads later on (at the cost
+    // of locking the complete reserved thread stacks).
+    return mlockall ( MCL_CURRENT | MCL_FUTURE ) == 0;
+#else
+    // memory locking is not supported on this platform
+    return false;
+#endif
+}
+
+bool CThreadUtil::ParseCPUCoreList ( const QString& strList,
+                                     CVector<int>&  veciCPUCores )
+{
+    const QStringList slCores = strList.split ( "," );
+
+    veciCPUCores.Init ( 0 );
+
+    for ( int i = 0; i < slCores.size(); i++ )
+    {
+        bool      bOK;
+        const int iCPUCore = slCores[i].trimmed().toInt ( &bOK );
+
+        if ( !bOK || ( iCPUCore < 0 ) || ( iCPUCore >= MAX_NUM_CPU_CORES ) )
+        {
+            return false;
+        }
+
+        veciCPUCores.Add ( iCPUCore );
+    }
+
+    return veciCPUCores.Size() > 0;
+}
+
+
+// Timing histogram ------------------------------------------------------------
+void CTimingHistogram::Reset()
+{
+    for ( int i = 0; i < TIMING_HIST_NUM_BUCKETS; i++ )
+    {
+        vecCounts[i] = 0;
+    }
+
+    iSumNs = 0;
+}
+
+void CTimingHistogram::AddTo ( CVector<uint64_t>& veciSnapCounts,
+                               uint64_t&          iSnapSumNs ) const
+{
+    if ( veciSnapCounts.Size() != TIMING_HIST_NUM_BUCKETS )
+    {
+        veciSnapCounts.Init ( TIMING_HIST_NUM_BUCKETS, 0 );
+    }
+
+    for ( int i = 0; i < TIMING_HIST_NUM_BUCKETS; i++ )
+    {
+        veciSnapCounts[i] += vecCounts[i].load ( std::memory_order_relaxed );
+    }
+
+    iSnapSumNs += iSumNs.load ( std::memory_order_relaxed );
+}
+
+int CTimingHistogram::GetBucket ( int64_t iTimeNs )
+{
+    // small values have their own buckets
+    if ( iTimeNs < TIMING_HIST_NUM_SUB )
+    {
+        return static_cast<int> ( std::max ( iTimeNs, static_cast<int64_t> ( 0 ) ) );
+    }
+
+    // limit to the maximum range
+    iTimeNs = std::min ( iTimeNs, ( static_cast<int64_t> ( 1 ) << TIMING_HIST_MAX_EXP ) - 1 );
+
+    // get the exponent (position of the most significant bit)
+#if defined ( __GNUC__ )
+    const int iExp = 63 - __builtin_clzll ( static_cast<unsigned long long> ( iTimeNs ) );
+#else
+    int iExp = 0;
+
+    while ( ( iTimeNs >> ( iExp + 1 ) ) != 0 )
+    {
+        iExp++;
+    }
+#endif
+
+    // the sub-bucket is given by the bits following the most significant bit
+    const int iSub = static_cast<int> ( iTimeNs >> ( iExp - TIMING_HIST_SUB_BITS ) ) & ( TIMING_HIST_NUM_SUB - 1 );
+
+    return ( iExp - TIMING_HIST_SUB_BITS + 1 ) * TIMING_HIST_NUM_SUB + iSub;
+}
+
+int64_t CTimingHistogram::GetBucketUpperBound ( const int iBucket )
+{
+    // the upper bound is the lower bound of the next bucket
+    const int iNextBucket = iBucket + 1;
+
+    if ( iNextBucket < TIMING_HIST_NUM_SUB )
+    {
+        return iNextBucket;
+    }
+
+    const int iExp = iNextBucket / TIMING_HIST_NUM_SUB + TIMING_HIST_SUB_BITS - 1;
+    const int iSub = iNextBucket % TIMING_HIST_NUM_SUB;
+
+    return static_cast<int64_t> ( TIMING_HIST_NUM_SUB + iSub ) << ( iExp - TIMING_HIST_SUB_BITS );
+}
+
+uint64_t CTimingHistogram::GetNumValues ( const CVector<uint64_t>& veciSnapCounts )
+{
+    uint64_t iNumValues = 0;
+
+    for ( int i = 0; i < veciSnapCounts.Size(); i++ )
+    {
+        iNumValues += veciSnapCounts[i];
+    }
+
+    return iNumValues;
+}
+
+int64_t CTimingHistogram::GetPercentile ( const CVector<uint64_t>& veciSnapCounts,
+                                          const double             dPercentile )
+{
+    const uint64_t iNumValues = GetNumValues ( veciSnapCounts );
+
+    if ( iNumValues == 0 )
+    {
+        return 0;
+    }
+
+    // number of values which must be less or equal to the percentile value
+    const uint64_t iRank = std::max ( static_cast<uint64_t> ( 1 ),
+        static_cast<uint64_t> ( ceil ( dPercentile / 100 * static_cast<double> ( iNumValues ) ) ) );
+
+    uint64_t iCumCount = 0;
+
+    for ( int i = 0; i < veciSnapCounts.Size(); i++ )
+    {
+        iCumCount += veciSnapCounts[i];
+
+        if ( iCumCount >= iRank )
+        {
+            return GetBucketUpperBound ( i );
+        }
+    }
+
+    return GetBucketUpperBound ( veciSnapCounts.Size() - 1 );
+}
+
+
 // Instrument picture data base ------------------------------------------------
 CVector<CInstPictures::CInstPictProps>& CInstPictures::GetTable()
 {
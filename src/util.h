@@ -46,6 +46,8 @@
 #include <QElapsedTimer>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include "global.h"
 using namespace std; // because of the library: "vector"
 #ifdef _WIN32
@@ -68,6 +70,8 @@ class CClient;  // forward declaration of CClient
 /* Definitions ****************************************************************/
 #define METER_FLY_BACK              2
 #define INVALID_MIDI_CH            -1 // invalid MIDI channel definition
+#define CRC_SLICE_NUM_BYTES         8  // number of bytes per step of the table-driven CRC
+#define MAX_NUM_CPU_CORES           1024 // maximum CPU core number for thread pinning
 
 
 /* Global functions ***********************************************************/
@@ -723,6 +727,10 @@ public:
                   const int             iInSize,
                   const bool            bIsStereoIn );
 
+    // update with the already known peak values of a block (16 bit range)
+    void Update ( const double dPeakLOrMono,
+                  const double dPeakR );
+
     double        GetLevelForMeterdBLeftOrMono() { return CalcLogResultForMeter ( dCurLevelLOrMono ); }
     double        GetLevelForMeterdBRight()      { return CalcLogResultForMeter ( dCurLevelR ); }
     static double CalcLogResultForMeter ( const double& dLinearLevel );
@@ -1134,6 +1142,21 @@ public:
 };
 
 
+// Thread utility functions ----------------------------------------------------
+class CThreadUtil
+{
+public:
+    static int  GetNumCPUCores();
+    static bool SetCurrentThreadAffinity ( const int iCPUCore );
+    static bool SetCurrentThreadRealTimePriority ( const int iPriority );
+    static bool LockMemory();
+
+    // parses a comma separated list of CPU core numbers, e.g. "2,3,5"
+    static bool ParseCPUCoreList ( const QString& strList,
+                                   CVector<int>&  veciCPUCores );
+};
+
+
 // Audio reverbration ----------------------------------------------------------
 class CAudioReverb
 {
@@ -1184,17 +1207,34 @@ protected:
 class CCRC
 {
 public:
-    CCRC() : iPoly ( ( 1 << 5 ) | ( 1 << 12 ) ), iBitOutMask ( 1 << 16 )
-        { Reset(); }
+    CCRC() { Reset(); }
 
     void Reset();
     void AddByte ( const uint8_t byNewInput );
+    void AddBytes ( const uint8_t* pbyNewInput, int iNumBytes );
     bool CheckCRC ( const uint32_t iCRC ) { return iCRC == GetCRC(); }
     uint32_t GetCRC();
 
+    // Since the CRC is linear, changing an input byte by XOR with "byDiff"
+    // changes the CRC by the returned value where "iNumFollowingBytes" is the
+    // number of input bytes after the changed byte.
+    static uint32_t GetCRCDiff ( const uint8_t byDiff,
+                                 int           iNumFollowingBytes );
+
 protected:
-    uint32_t iPoly;
-    uint32_t iBitOutMask;
+    // look-up tables for the table-driven (slice-by-8) CRC calculation
+    class CTables
+    {
+    public:
+        CTables();
+
+        uint16_t vecStateLow[CRC_SLICE_NUM_BYTES][256];
+        uint16_t vecStateHigh[CRC_SLICE_NUM_BYTES][256];
+        uint16_t vecData[CRC_SLICE_NUM_BYTES][256];
+    };
+
+    static const CTables& Tables();
+
     uint32_t iStateShiftReg;
 };
 
@@ -1335,6 +1375,59 @@ protected:
 };
 
 
+// Timing histogram ------------------------------------------------------------
+// Log-linear histogram of time durations in ns (similar to an HDR histogram):
+// each power of two is divided in 8 sub-buckets, i.e., the relative error of
+// a value is below 12.5 %. The histogram must only be written by a single
+// thread, it can be read by any other thread without locking. The counts are
+// cumulative, intervals are evaluated with the difference of two snapshots.
+#define TIMING_HIST_SUB_BITS    3
+#define TIMING_HIST_NUM_SUB     ( 1 << TIMING_HIST_SUB_BITS )
+#define TIMING_HIST_MAX_EXP     40 // values are limited to 2^40 ns (about 18 min)
+#define TIMING_HIST_NUM_BUCKETS ( ( TIMING_HIST_MAX_EXP - TIMING_HIST_SUB_BITS + 1 ) * TIMING_HIST_NUM_SUB )
+
+class CTimingHistogram
+{
+public:
+    CTimingHistogram() { Reset(); }
+
+    void Reset();
+
+    void Add ( int64_t iTimeNs )
+    {
+        // only a single thread writes, therefore no atomic read-modify-write
+        // operations are required
+        std::atomic<uint64_t>& iCount = vecCounts[GetBucket ( iTimeNs )];
+
+        iCount.store ( iCount.load ( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        iSumNs.store ( iSumNs.load ( std::memory_order_relaxed ) + static_cast<uint64_t> ( std::max ( iTimeNs, static_cast<int64_t> ( 0 ) ) ),
+                       std::memory_order_relaxed );
+    }
+
+    // adds the current counts to the given snapshot vectors
+    void AddTo ( CVector<uint64_t>& veciSnapCounts,
+                 uint64_t&          iSnapSumNs ) const;
+
+    static int     GetBucket ( int64_t iTimeNs );
+    static int64_t GetBucketUpperBound ( const int iBucket );
+
+    // evaluation of a snapshot (or the difference of two snapshots)
+    static uint64_t GetNumValues ( const CVector<uint64_t>& veciSnapCounts );
+    static int64_t  GetPercentile ( const CVector<uint64_t>& veciSnapCounts,
+                                    const double             dPercentile );
+
+    static int64_t GetTimeNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds> (
+            std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+protected:
+    std::atomic<uint64_t> vecCounts[TIMING_HIST_NUM_BUCKETS];
+    std::atomic<uint64_t> iSumNs;
+};
+
+
 /******************************************************************************\
 * Statistics                                                                   *
 \******************************************************************************/